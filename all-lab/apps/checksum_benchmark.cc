@@ -0,0 +1,98 @@
+#include "util.hh"
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+using namespace std;
+using namespace std::chrono;
+
+static constexpr size_t DEFAULT_TOTAL = 1 << 30;
+
+//! The checksum as InternetChecksum::add() used to compute it: one byte per iteration
+static uint16_t byte_loop_checksum(const string_view data) {
+    uint32_t sum = 0;
+    bool parity = false;
+    for (size_t i = 0; i < data.size(); i++) {
+        uint16_t val = uint8_t(data[i]);
+        if (not parity) {
+            val <<= 8;
+        }
+        sum += val;
+        parity = !parity;
+    }
+    while (sum > 0xffff) {
+        sum = (sum >> 16) + (sum & 0xffff);
+    }
+    return ~sum;
+}
+
+static uint16_t word_checksum(const string_view data) {
+    InternetChecksum check;
+    check.add(data);
+    return check.value();
+}
+
+//! Checksum `data` over and over, until `total` bytes have been summed
+//! \returns the throughput in Gbit/s, and the checksum (so that the work cannot be optimized away)
+template <typename F>
+static pair<double, uint16_t> measure(F &&checksum, const string_view data, const size_t total) {
+    const size_t rounds = max(size_t{1}, total / data.size());
+    uint16_t result = 0;
+    const auto start = steady_clock::now();
+    for (size_t i = 0; i < rounds; i++) {
+        result ^= checksum(data);
+    }
+    const auto elapsed = duration_cast<duration<double>>(steady_clock::now() - start).count();
+    return {8e-9 * static_cast<double>(rounds * data.size()) / elapsed, result};
+}
+
+static void show_usage(const char *argv0) {
+    cerr << "Usage: " << argv0 << " [-n <bytes>]\n\n"
+         << "   Checksums about <bytes> (default " << DEFAULT_TOTAL << ") at each of several buffer sizes, with\n"
+         << "   InternetChecksum and with the byte-at-a-time loop it replaced, and reports the throughput of each.\n";
+}
+
+int main(int argc, char **argv) {
+    try {
+        size_t total = DEFAULT_TOTAL;
+        for (int i = 1; i < argc; i++) {
+            if (strncmp("-n", argv[i], 3) == 0 && i + 1 < argc) {
+                total = strtoul(argv[++i], nullptr, 0);
+            } else {
+                show_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+
+        auto rd = get_random_generator();
+        string storage(65536 + 1, '\0');
+        for (auto &c : storage) {
+            c = static_cast<char>(rd());
+        }
+
+        cout << fixed << setprecision(2);
+        cout << "   bytes    byte loop (Gbit/s)    InternetChecksum (Gbit/s)    speedup\n";
+        // an IPv4 header, a pure ACK, a full segment, a misaligned one, and a large buffer
+        for (const size_t len : array<size_t, 5>{20, 40, 1460, 1461, 65536}) {
+            const string_view data{storage.data() + (len % 2), len};
+            const auto bytes = measure(byte_loop_checksum, data, total);
+            const auto words = measure(word_checksum, data, total);
+            if (bytes.second != words.second) {
+                throw runtime_error("checksums of " + to_string(len) + " bytes disagree");
+            }
+            cout << setw(8) << len << setw(22) << bytes.first << setw(29) << words.first << setw(10)
+                 << words.first / bytes.first << "x\n";
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
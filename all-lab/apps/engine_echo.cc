@@ -0,0 +1,67 @@
+#include "engine_echo.hh"
+
+#include "byte_stream.hh"
+#include "eventloop.hh"
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <utility>
+
+using namespace std;
+
+//! One accepted connection, and the bytes read from it that are still to be written back
+struct Echo {
+    static constexpr size_t BUFFER_SIZE = 65536;
+
+    LocalStreamSocket socket;
+    FourTuple tuple;
+    ByteStream pending{BUFFER_SIZE};
+
+    Echo(LocalStreamSocket &&s, const FourTuple &t) : socket(move(s)), tuple(t) {}
+};
+
+template <typename AdaptT>
+void echo_connections(TCPEngine<AdaptT> &engine) {
+    EventLoop eventloop{EventLoop::Backend::Epoll};
+
+    eventloop.add_rule(engine.accept_fd(), Direction::In, [&] {
+        auto [socket, tuple] = engine.accept();
+        cerr << "DEBUG: New connection " << tuple.to_string() << "\n";
+        const auto echo = make_shared<Echo>(move(socket), tuple);
+        echo->socket.set_blocking(false);
+
+        // a slow peer only holds up its own connection: stop reading from it while its echo is backed up
+        eventloop.add_rule(
+            echo->socket,
+            Direction::In,
+            [echo] {
+                echo->pending.write(echo->socket.read(echo->pending.remaining_capacity()));
+                if (echo->socket.eof()) {
+                    echo->pending.end_input();
+                }
+            },
+            [echo] { return echo->pending.remaining_capacity() > 0 and not echo->pending.input_ended(); },
+            [echo] { echo->pending.end_input(); });
+
+        eventloop.add_rule(
+            echo->socket,
+            Direction::Out,
+            [echo] {
+                const size_t written = echo->socket.write(echo->pending.peek_output_views(Echo::BUFFER_SIZE), false);
+                echo->pending.pop_output(written);
+                if (echo->pending.eof()) {
+                    // closing the socket cancels both rules, which lets go of the connection
+                    cerr << "DEBUG: Connection " << echo->tuple.to_string() << " finished\n";
+                    echo->socket.close();
+                }
+            },
+            [echo] { return (not echo->pending.buffer_empty()) or echo->pending.eof(); });
+    });
+
+    while (eventloop.wait_next_event(-1) != EventLoop::Result::Exit) {
+    }
+}
+
+template void echo_connections(LossyTCPOverUDPEngine &engine);
+template void echo_connections(LossyTCPOverIPv4Engine &engine);
@@ -0,0 +1,10 @@
+#ifndef SPONGE_APPS_ENGINE_ECHO_HH
+#define SPONGE_APPS_ENGINE_ECHO_HH
+
+#include "tcp_engine.hh"
+
+//! Echo the bytes of every connection `engine` accepts back to its peer, from one thread, until killed
+template <typename AdaptT>
+void echo_connections(TCPEngine<AdaptT> &engine);
+
+#endif  // SPONGE_APPS_ENGINE_ECHO_HH
@@ -0,0 +1,148 @@
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <utility>
+
+using namespace std;
+using namespace std::chrono;
+
+//! \name Allocation counting
+//! Every allocation in the process goes through these replacements of the global operator new/delete.
+//!@{
+static size_t allocations = 0;        //!< calls to operator new
+static size_t large_allocations = 0;  //!< calls big enough to hold a full payload, i.e. candidate deep copies
+static size_t large_threshold = TCPConfig::MAX_PAYLOAD_SIZE;
+
+void *operator new(size_t size) {
+    allocations++;
+    if (size >= large_threshold) {
+        large_allocations++;
+    }
+    if (void *ptr = malloc(size)) {
+        return ptr;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+//!@}
+
+static constexpr size_t DEFAULT_LEN = 100 * 1024 * 1024;
+
+//! Segments moved in one direction
+struct SegmentCount {
+    size_t total = 0;  //!< every segment
+    size_t data = 0;   //!< segments that carried payload
+};
+
+//! Move every segment that `from` has queued into `to`
+static SegmentCount move_segments(TCPConnection &from, TCPConnection &to) {
+    SegmentCount ret;
+    while (not from.segments_out().empty()) {
+        const TCPSegment seg = move(from.segments_out().front());
+        from.segments_out().pop();
+        ret.total++;
+        ret.data += seg.payload().size() > 0 ? 1 : 0;
+        to.segment_received(seg);
+    }
+    return ret;
+}
+
+static void show_usage(const char *argv0) {
+    cerr << "Usage: " << argv0 << " [-n <bytes>] [-M <mss>] [-D <ms>]\n\n"
+         << "   Transfers <bytes> (default " << DEFAULT_LEN << ") between two TCPConnections in memory and\n"
+         << "   reports throughput, heap allocations, and reverse-path segments per data segment.\n"
+         << "   -D delays ACKs by up to <ms> milliseconds (typically " << TCPConfig::DELAYED_ACK_DFLT << ").\n";
+}
+
+int main(int argc, char **argv) {
+    try {
+        TCPConfig config;
+        size_t len = DEFAULT_LEN;
+        for (int i = 1; i < argc; i++) {
+            if (strncmp("-n", argv[i], 3) == 0 && i + 1 < argc) {
+                len = strtoul(argv[++i], nullptr, 0);
+            } else if (strncmp("-M", argv[i], 3) == 0 && i + 1 < argc) {
+                config.mss = strtoul(argv[++i], nullptr, 0);
+                large_threshold = config.mss.value();
+            } else if (strncmp("-D", argv[i], 3) == 0 && i + 1 < argc) {
+                config.delayed_ack = static_cast<uint16_t>(strtoul(argv[++i], nullptr, 0));
+            } else {
+                show_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+
+        TCPConnection x{config}, y{config};
+        x.connect();
+        move_segments(x, y);
+        move_segments(y, x);
+        move_segments(x, y);
+        if (not x.active() or not y.active()) {
+            throw runtime_error("handshake failed");
+        }
+
+        // one shared Buffer feeds every write(), so the payload is never copied on the way in
+        const Buffer data{string(len, 'x')};
+        size_t bytes_written = 0, bytes_read = 0, data_segments = 0, reverse_segments = 0;
+
+        const size_t allocations_before = allocations;
+        const size_t large_allocations_before = large_allocations;
+        const auto start = steady_clock::now();
+
+        while (bytes_read < len) {
+            if (bytes_written < len) {
+                Buffer rest = data;
+                rest.remove_prefix(bytes_written);
+                bytes_written += x.write(move(rest));
+                if (bytes_written == len) {
+                    x.end_input_stream();
+                }
+            }
+            const SegmentCount forward = move_segments(x, y);
+            const SegmentCount reverse = move_segments(y, x);
+            data_segments += forward.data;
+            reverse_segments += reverse.total;
+            if (forward.total == 0 and reverse.total == 0) {
+                // nothing moved: let the clock run until a (delayed ACK or retransmission) timer fires
+                x.tick(1);
+                y.tick(1);
+            }
+
+            // discard what arrived without copying it out of the stream
+            ByteStream &inbound = y.inbound_stream();
+            const size_t available = inbound.buffer_size();
+            inbound.pop_output(available);
+            bytes_read += available;
+        }
+
+        const auto elapsed = duration_cast<duration<double>>(steady_clock::now() - start).count();
+        const size_t n_alloc = allocations - allocations_before;
+        const size_t n_large = large_allocations - large_allocations_before;
+
+        cout << fixed << setprecision(2);
+        cout << "transferred " << len << " bytes in " << data_segments << " data segments: " << elapsed << " s, "
+             << 8e-9 * static_cast<double>(len) / elapsed << " Gbit/s\n";
+        cout << "heap allocations per data segment: "
+             << static_cast<double>(n_alloc) / static_cast<double>(data_segments) << " (" << n_alloc << " total)\n";
+        cout << "payload-sized allocations per data segment: "
+             << static_cast<double>(n_large) / static_cast<double>(data_segments) << " (" << n_large << " total)\n";
+        cout << "reverse-path segments per data segment: "
+             << static_cast<double>(reverse_segments) / static_cast<double>(data_segments) << " ("
+             << reverse_segments << " total)\n";
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
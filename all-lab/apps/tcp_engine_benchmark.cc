@@ -0,0 +1,121 @@
+#include "eventloop.hh"
+#include "socket.hh"
+#include "tcp_config.hh"
+#include "tcp_engine.hh"
+#include "tcp_sponge_socket.hh"
+#include "util.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+static constexpr size_t DEFAULT_CONNECTIONS = 32;
+static constexpr size_t DEFAULT_LEN = 4 * 1024 * 1024;
+
+static void show_usage(const char *argv0) {
+    cerr << "Usage: " << argv0 << " [-w <workers>] [-c <connections>] [-n <bytes>]\n\n"
+         << "   Sends <bytes> (default " << DEFAULT_LEN << ") over each of <connections> (default "
+         << DEFAULT_CONNECTIONS << ") loopback\n"
+         << "   TCP-over-UDP connections into one TCPEngine with <workers> (default 1) workers, and reports the\n"
+         << "   engine's aggregate receive throughput. Each sender is a TCPSpongeSocket on a thread of its own;\n"
+         << "   compare -w 1, 2, 4, ... on a machine with cores to spare for the senders.\n";
+}
+
+int main(int argc, char **argv) {
+    try {
+        size_t workers = 1;
+        size_t connections = DEFAULT_CONNECTIONS;
+        size_t len = DEFAULT_LEN;
+        for (int i = 1; i < argc; i++) {
+            if (strncmp("-w", argv[i], 3) == 0 && i + 1 < argc) {
+                workers = strtoul(argv[++i], nullptr, 0);
+            } else if (strncmp("-c", argv[i], 3) == 0 && i + 1 < argc) {
+                connections = strtoul(argv[++i], nullptr, 0);
+            } else if (strncmp("-n", argv[i], 3) == 0 && i + 1 < argc) {
+                len = strtoul(argv[++i], nullptr, 0);
+            } else {
+                show_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+        if (workers == 0 or connections == 0) {
+            show_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        TCPConfig c_tcp;
+        c_tcp.rt_timeout = 100;  // keeps each sender's TIME_WAIT short
+        c_tcp.congestion_control = TCPConfig::CongestionControl::Reno;  // the senders share one UDP socket
+
+        UDPSocket server_sock;
+        server_sock.bind(Address("127.0.0.1", 0));
+        FdAdapterConfig c_server;
+        c_server.source = server_sock.local_address();
+        TCPOverUDPEngine server(TCPOverUDPSocketAdapter(move(server_sock)), c_tcp, c_server, workers);
+        server.listen(c_server.source, connections);
+
+        const string data(len, 'x');
+        vector<thread> senders;
+        for (size_t i = 0; i < connections; i++) {
+            senders.emplace_back([&] {
+                try {
+                    FdAdapterConfig c_client;
+                    c_client.destination = c_server.source;
+                    TCPOverUDPSpongeSocket sock(TCPOverUDPSocketAdapter(UDPSocket{}));
+                    sock.connect(c_tcp, c_client);
+                    sock.write(data);
+                    sock.shutdown(SHUT_WR);
+                    sock.wait_until_closed();
+                } catch (const exception &e) {
+                    cerr << "Exception in sender: " << e.what() << endl;
+                }
+            });
+        }
+
+        // discard every byte the engine delivers, and close each connection at EOF
+        EventLoop loop;
+        size_t received = 0;
+        size_t finished = 0;
+        auto start = steady_clock::now();
+        loop.add_rule(server.accept_fd(), Direction::In, [&] {
+            if (finished == 0 and received == 0) {
+                start = steady_clock::now();  // the clock starts with the first connection
+            }
+            auto sock = make_shared<LocalStreamSocket>(server.accept().first);
+            loop.add_rule(*sock, Direction::In, [&, sock] {
+                received += sock->read().size();
+                if (sock->eof()) {
+                    sock->close();
+                    finished++;
+                }
+            });
+        });
+        while (finished < connections) {
+            loop.wait_next_event(-1);
+        }
+        const auto elapsed = duration_cast<duration<double>>(steady_clock::now() - start).count();
+
+        cout << fixed << setprecision(2);
+        cout << workers << " worker(s), " << connections << " connections: received " << received << " bytes in "
+             << elapsed << " s, " << 8e-9 * static_cast<double>(received) / elapsed << " Gbit/s\n";
+
+        for (auto &t : senders) {
+            t.join();
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -1,4 +1,5 @@
 #include "bidirectional_stream_copy.hh"
+#include "engine_echo.hh"
 #include "tcp_config.hh"
 #include "tcp_sponge_socket.hh"
 #include "tun.hh"
@@ -22,7 +23,9 @@ static void show_usage(const char *argv0, const char *msg) {
          << "   --                                                              --\n\n"
 
          << "   -l              Server (listen) mode.                           (client mode)\n"
-         << "                   In server mode, <host>:<port> is the address to bind.\n\n"
+         << "                   In server mode, <host>:<port> is the address to bind.\n"
+         << "   -m <workers>    Serve many clients at once, echoing each one,   (one client, on stdin/stdout)\n"
+         << "                   from a TCPEngine with <workers> threads (implies -l).\n\n"
 
          << "   -a <addr>       Set source address (client mode only)           " << LOCAL_ADDRESS_DFLT << "\n"
          << "   -s <port>       Set source port (client mode only)              (random)\n\n"
@@ -30,7 +33,16 @@ static void show_usage(const char *argv0, const char *msg) {
          << "   -w <winsz>      Use a window of <winsz> bytes                   " << TCPConfig::MAX_PAYLOAD_SIZE
          << "\n\n"
 
-         << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n\n"
+         << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n"
+         << "   -M <mss>        Send segments of at most <mss> payload bytes    (from the device MTU)\n\n"
+         << "   -C <alg>        Congestion control: none, reno, newreno, cubic  none\n"
+         << "   -A              Adapt the RTO to the measured RTT (RFC 6298)    (fixed rt_timeout)\n"
+         << "   -S              Offer selective acknowledgments (RFC 2018)      (no SACK)\n"
+         << "   -W              Offer window scaling and timestamps (RFC 7323)  (64 KiB window limit)\n"
+         << "   -D <ms>         Delay ACKs by up to <ms> milliseconds           (no delay)\n"
+         << "                   A typical delay is " << TCPConfig::DELAYED_ACK_DFLT << " ms.\n"
+         << "   -N              Coalesce small writes (Nagle's algorithm)       (send at once)\n"
+         << "   -P              Pace segments across the RTT                    (send the window at once)\n\n"
 
          << "   -d <tundev>     Connect to tun <tundev>                         " << TUN_DFLT << "\n\n"
 
@@ -52,13 +64,14 @@ static void check_argc(int argc, char **argv, int curr, const char *err) {
     }
 }
 
-static tuple<TCPConfig, FdAdapterConfig, bool, char *> get_config(int argc, char **argv) {
+static tuple<TCPConfig, FdAdapterConfig, bool, size_t, char *> get_config(int argc, char **argv) {
     TCPConfig c_fsm{};
     FdAdapterConfig c_filt{};
     char *tundev = nullptr;
 
     int curr = 1;
     bool listen = false;
+    size_t workers = 0;
 
     string source_address = LOCAL_ADDRESS_DFLT;
     string source_port = to_string(uint16_t(random_device()()));
@@ -68,6 +81,16 @@ static tuple<TCPConfig, FdAdapterConfig, bool, char *> get_config(int argc, char
             listen = true;
             curr += 1;
 
+        } else if (strncmp("-m", argv[curr], 3) == 0) {
+            check_argc(argc, argv, curr, "ERROR: -m requires one argument.");
+            workers = strtoul(argv[curr + 1], nullptr, 0);
+            if (workers == 0) {
+                show_usage(argv[0], "ERROR: -m needs at least one worker.");
+                exit(1);
+            }
+            listen = true;
+            curr += 2;
+
         } else if (strncmp("-a", argv[curr], 3) == 0) {
             check_argc(argc, argv, curr, "ERROR: -a requires one argument.");
             source_address = argv[curr + 1];
@@ -93,6 +116,54 @@ static tuple<TCPConfig, FdAdapterConfig, bool, char *> get_config(int argc, char
             tundev = argv[curr + 1];
             curr += 2;
 
+        } else if (strncmp("-M", argv[curr], 3) == 0) {
+            check_argc(argc, argv, curr, "ERROR: -M requires one argument.");
+            c_fsm.mss = strtol(argv[curr + 1], nullptr, 0);
+            curr += 2;
+
+        } else if (strncmp("-A", argv[curr], 3) == 0) {
+            c_fsm.adaptive_rto = true;
+            curr += 1;
+
+        } else if (strncmp("-S", argv[curr], 3) == 0) {
+            c_fsm.sack = true;
+            curr += 1;
+
+        } else if (strncmp("-W", argv[curr], 3) == 0) {
+            c_fsm.window_scaling = true;
+            c_fsm.timestamps = true;
+            curr += 1;
+
+        } else if (strncmp("-P", argv[curr], 3) == 0) {
+            c_fsm.pacing = true;
+            curr += 1;
+
+        } else if (strncmp("-N", argv[curr], 3) == 0) {
+            c_fsm.nagle = true;
+            curr += 1;
+
+        } else if (strncmp("-D", argv[curr], 3) == 0) {
+            check_argc(argc, argv, curr, "ERROR: -D requires one argument.");
+            c_fsm.delayed_ack = strtol(argv[curr + 1], nullptr, 0);
+            curr += 2;
+
+        } else if (strncmp("-C", argv[curr], 3) == 0) {
+            check_argc(argc, argv, curr, "ERROR: -C requires one argument.");
+            const string algorithm = argv[curr + 1];
+            if (algorithm == "none") {
+                c_fsm.congestion_control = TCPConfig::CongestionControl::None;
+            } else if (algorithm == "reno") {
+                c_fsm.congestion_control = TCPConfig::CongestionControl::Reno;
+            } else if (algorithm == "newreno") {
+                c_fsm.congestion_control = TCPConfig::CongestionControl::NewReno;
+            } else if (algorithm == "cubic") {
+                c_fsm.congestion_control = TCPConfig::CongestionControl::Cubic;
+            } else {
+                show_usage(argv[0], "ERROR: -C must be one of none, reno, newreno or cubic.");
+                exit(1);
+            }
+            curr += 2;
+
         } else if (strncmp("-Lu", argv[curr], 3) == 0) {
             check_argc(argc, argv, curr, "ERROR: -Lu requires one argument.");
             float lossrate = strtof(argv[curr + 1], nullptr);
@@ -131,7 +202,7 @@ static tuple<TCPConfig, FdAdapterConfig, bool, char *> get_config(int argc, char
         c_filt.source = {source_address, source_port};
     }
 
-    return make_tuple(c_fsm, c_filt, listen, tundev);
+    return make_tuple(c_fsm, c_filt, listen, workers, tundev);
 }
 
 int main(int argc, char **argv) {
@@ -141,9 +212,19 @@ int main(int argc, char **argv) {
             return EXIT_FAILURE;
         }
 
-        auto [c_fsm, c_filt, listen, tun_dev_name] = get_config(argc, argv);
-        LossyTCPOverIPv4SpongeSocket tcp_socket(LossyTCPOverIPv4OverTunFdAdapter(
-            TCPOverIPv4OverTunFdAdapter(TunFD(tun_dev_name == nullptr ? TUN_DFLT : tun_dev_name))));
+        auto [c_fsm, c_filt, listen, workers, tun_dev_name] = get_config(argc, argv);
+        TunFD tun(tun_dev_name == nullptr ? TUN_DFLT : tun_dev_name);
+        if (workers > 0) {
+            // to serve many clients, a TCPEngine: every connection over the one tun device
+            LossyTCPOverIPv4Engine engine(
+                LossyTCPOverIPv4OverTunFdAdapter(TCPOverIPv4OverTunFdAdapter(move(tun))), c_fsm, c_filt, workers);
+            engine.listen(c_filt.source);
+            echo_connections(engine);
+            return EXIT_SUCCESS;
+        }
+
+        LossyTCPOverIPv4SpongeSocket tcp_socket(
+            LossyTCPOverIPv4OverTunFdAdapter(TCPOverIPv4OverTunFdAdapter(move(tun))));
 
         if (listen) {
             tcp_socket.listen_and_accept(c_fsm, c_filt);
@@ -1,4 +1,5 @@
 #include "bidirectional_stream_copy.hh"
+#include "engine_echo.hh"
 #include "tcp_config.hh"
 #include "tcp_sponge_socket.hh"
 
@@ -21,12 +22,23 @@ static void show_usage(const char *argv0, const char *msg) {
          << "   --                                                              --\n\n"
 
          << "   -l              Server (listen) mode.                           (client mode)\n"
-         << "                   In server mode, <host>:<port> is the address to bind.\n\n"
+         << "                   In server mode, <host>:<port> is the address to bind.\n"
+         << "   -m <workers>    Serve many clients at once, echoing each one,   (one client, on stdin/stdout)\n"
+         << "                   from a TCPEngine with <workers> threads (implies -l).\n\n"
 
          << "   -w <winsz>      Use a window of <winsz> bytes                   " << TCPConfig::MAX_PAYLOAD_SIZE
          << "\n\n"
 
-         << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n\n"
+         << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n"
+         << "   -M <mss>        Send segments of at most <mss> payload bytes    (from the device MTU)\n\n"
+         << "   -C <alg>        Congestion control: none, reno, newreno, cubic  none\n"
+         << "   -A              Adapt the RTO to the measured RTT (RFC 6298)    (fixed rt_timeout)\n"
+         << "   -S              Offer selective acknowledgments (RFC 2018)      (no SACK)\n"
+         << "   -W              Offer window scaling and timestamps (RFC 7323)  (64 KiB window limit)\n"
+         << "   -D <ms>         Delay ACKs by up to <ms> milliseconds           (no delay)\n"
+         << "                   A typical delay is " << TCPConfig::DELAYED_ACK_DFLT << " ms.\n"
+         << "   -N              Coalesce small writes (Nagle's algorithm)       (send at once)\n"
+         << "   -P              Pace segments across the RTT                    (send the window at once)\n\n"
 
          << "   -Lu <loss>      Set uplink loss to <rate> (float in 0..1)       (no loss)\n"
          << "   -Ld <loss>      Set downlink loss to <rate> (float in 0..1)     (no loss)\n\n"
@@ -46,18 +58,29 @@ static void check_argc(int argc, char **argv, int curr, const char *err) {
     }
 }
 
-static tuple<TCPConfig, FdAdapterConfig, bool> get_config(int argc, char **argv) {
+static tuple<TCPConfig, FdAdapterConfig, bool, size_t> get_config(int argc, char **argv) {
     TCPConfig c_fsm{};
     FdAdapterConfig c_filt{};
 
     int curr = 1;
     bool listen = false;
+    size_t workers = 0;
 
     while (argc - curr > 2) {
         if (strncmp("-l", argv[curr], 3) == 0) {
             listen = true;
             curr += 1;
 
+        } else if (strncmp("-m", argv[curr], 3) == 0) {
+            check_argc(argc, argv, curr, "ERROR: -m requires one argument.");
+            workers = strtoul(argv[curr + 1], nullptr, 0);
+            if (workers == 0) {
+                show_usage(argv[0], "ERROR: -m needs at least one worker.");
+                exit(1);
+            }
+            listen = true;
+            curr += 2;
+
         } else if (strncmp("-w", argv[curr], 3) == 0) {
             check_argc(argc, argv, curr, "ERROR: -w requires one argument.");
             c_fsm.recv_capacity = strtol(argv[curr + 1], nullptr, 0);
@@ -68,6 +91,54 @@ static tuple<TCPConfig, FdAdapterConfig, bool> get_config(int argc, char **argv)
             c_fsm.rt_timeout = strtol(argv[curr + 1], nullptr, 0);
             curr += 2;
 
+        } else if (strncmp("-M", argv[curr], 3) == 0) {
+            check_argc(argc, argv, curr, "ERROR: -M requires one argument.");
+            c_fsm.mss = strtol(argv[curr + 1], nullptr, 0);
+            curr += 2;
+
+        } else if (strncmp("-A", argv[curr], 3) == 0) {
+            c_fsm.adaptive_rto = true;
+            curr += 1;
+
+        } else if (strncmp("-S", argv[curr], 3) == 0) {
+            c_fsm.sack = true;
+            curr += 1;
+
+        } else if (strncmp("-W", argv[curr], 3) == 0) {
+            c_fsm.window_scaling = true;
+            c_fsm.timestamps = true;
+            curr += 1;
+
+        } else if (strncmp("-P", argv[curr], 3) == 0) {
+            c_fsm.pacing = true;
+            curr += 1;
+
+        } else if (strncmp("-N", argv[curr], 3) == 0) {
+            c_fsm.nagle = true;
+            curr += 1;
+
+        } else if (strncmp("-D", argv[curr], 3) == 0) {
+            check_argc(argc, argv, curr, "ERROR: -D requires one argument.");
+            c_fsm.delayed_ack = strtol(argv[curr + 1], nullptr, 0);
+            curr += 2;
+
+        } else if (strncmp("-C", argv[curr], 3) == 0) {
+            check_argc(argc, argv, curr, "ERROR: -C requires one argument.");
+            const string algorithm = argv[curr + 1];
+            if (algorithm == "none") {
+                c_fsm.congestion_control = TCPConfig::CongestionControl::None;
+            } else if (algorithm == "reno") {
+                c_fsm.congestion_control = TCPConfig::CongestionControl::Reno;
+            } else if (algorithm == "newreno") {
+                c_fsm.congestion_control = TCPConfig::CongestionControl::NewReno;
+            } else if (algorithm == "cubic") {
+                c_fsm.congestion_control = TCPConfig::CongestionControl::Cubic;
+            } else {
+                show_usage(argv[0], "ERROR: -C must be one of none, reno, newreno or cubic.");
+                exit(1);
+            }
+            curr += 2;
+
         } else if (strncmp("-Lu", argv[curr], 3) == 0) {
             check_argc(argc, argv, curr, "ERROR: -Lu requires one argument.");
             float lossrate = strtof(argv[curr + 1], nullptr);
@@ -100,7 +171,7 @@ static tuple<TCPConfig, FdAdapterConfig, bool> get_config(int argc, char **argv)
         c_filt.destination = {argv[argc - 2], argv[argc - 1]};
     }
 
-    return make_tuple(c_fsm, c_filt, listen);
+    return make_tuple(c_fsm, c_filt, listen, workers);
 }
 
 int main(int argc, char **argv) {
@@ -111,13 +182,21 @@ int main(int argc, char **argv) {
         }
 
         // handle configuration and UDP setup from cmdline arguments
-        auto [c_fsm, c_filt, listen] = get_config(argc, argv);
+        auto [c_fsm, c_filt, listen, workers] = get_config(argc, argv);
 
         // build a TCP FSM on top of the UDP socket
         UDPSocket udp_sock;
         if (listen) {
             udp_sock.bind(c_filt.source);
         }
+        if (workers > 0) {
+            // or, to serve many clients, a TCPEngine: every connection over the one UDP socket
+            LossyTCPOverUDPEngine engine(
+                LossyTCPOverUDPSocketAdapter(TCPOverUDPSocketAdapter(move(udp_sock))), c_fsm, c_filt, workers);
+            engine.listen(c_filt.source);
+            echo_connections(engine);
+            return EXIT_SUCCESS;
+        }
         LossyTCPOverUDPSpongeSocket tcp_socket(LossyTCPOverUDPSocketAdapter(TCPOverUDPSocketAdapter(move(udp_sock))));
         if (listen) {
             tcp_socket.listen_and_accept(c_fsm, c_filt);
@@ -16,39 +16,186 @@ void DUMMY_CODE(Targs &&... /* unused */) {}
 
 using namespace std;
 
-ByteStream::ByteStream(const size_t capacity) 
-    : _capacity(capacity), _bytes_written(0), _bytes_read(0), _buffer(), _error(false), _input_ended(false) {}
-
-size_t ByteStream::write(const string &data) {
+//! \param[in] capacity the maximum number of unread bytes the stream will hold
+//! \param[in] storage selects the ring buffer (copying) or chunked (by-reference) representation
+ByteStream::ByteStream(const size_t capacity, const Storage storage)
+    : _capacity(capacity)
+    , _storage(storage)
+    , _bytes_written(0)
+    , _bytes_read(0)
+    , _buffer(storage == Storage::Ring ? capacity : 0, '\0')
+    , _error(false)
+    , _input_ended(false) {}
+
+size_t ByteStream::write(string_view data) {
     if (data.empty() || _error || _input_ended) {
         // nothing to write
-        return 0;  
+        return 0;
+    }
+
+    const size_t to_write = min(remaining_capacity(), data.size());
+    if (_storage == Storage::Chunked) {
+        if (to_write > 0) {
+            _chunks.append(BufferList(string(data.substr(0, to_write))));
+        }
+        _size += to_write;
+        _bytes_written += to_write;
+        return to_write;
     }
-    
-    size_t space = _capacity - _buffer.size();
-    size_t to_write = min(space, data.size());
-    _buffer += data.substr(0, to_write);
+
+    // the free region starts right after the last unread byte and may wrap around
+    size_t tail = _head + _size;
+    if (tail >= _capacity) {
+        tail -= _capacity;
+    }
+    const size_t first = min(to_write, _capacity - tail);
+    copy_n(data.data(), first, _buffer.begin() + tail);
+    copy_n(data.data() + first, to_write - first, _buffer.begin());
+
+    _size += to_write;
     _bytes_written += to_write;
     return to_write;
 }
 
+size_t ByteStream::write(Buffer data) {
+    if (_storage == Storage::Ring) {
+        return write(data.str());
+    }
+    if (data.size() == 0 || _error || _input_ended) {
+        // nothing to write
+        return 0;
+    }
+
+    const size_t to_write = min(remaining_capacity(), data.size());
+    if (to_write > 0) {
+        // keep only the part that fits; the bytes themselves stay where they are
+        data.remove_suffix(data.size() - to_write);
+        _chunks.append(BufferList(move(data)));
+    }
+    _size += to_write;
+    _bytes_written += to_write;
+    return to_write;
+}
+
+size_t ByteStream::write(string &&data) {
+    if (_storage == Storage::Ring) {
+        return write(string_view(data));
+    }
+    return write(Buffer(move(data)));
+}
+
+pair<string_view, string_view> ByteStream::_spans(const size_t len) const {
+    const size_t n = min(len, _size);
+    const size_t first = min(n, _capacity - _head);
+    const string_view storage{_buffer};
+    return {storage.substr(_head, first), storage.substr(0, n - first)};
+}
+
 //! \param[in] len bytes will be copied from the output side of the buffer
 string ByteStream::peek_output(const size_t len) const {
-    if( len == 0 || _buffer.empty() || _error) {
+    if (len == 0 || _size == 0 || _error) {
         return "";  // Nothing to peek or stream is in error state
     }
-    size_t to_peek = min(len, _buffer.size());
-    return _buffer.substr(0, to_peek);
+    if (_storage == Storage::Chunked) {
+        return peek_output_buffers(len).concatenate();
+    }
+    const auto [first, second] = _spans(len);
+    string ret;
+    ret.reserve(first.size() + second.size());
+    ret.append(first).append(second);
+    return ret;
+}
+
+//! \param[in] len bytes will be exposed from the output side of the buffer
+BufferViewList ByteStream::peek_output_views(const size_t len) const {
+    BufferViewList ret;
+    if (len == 0 || _size == 0 || _error) {
+        return ret;
+    }
+    if (_storage == Storage::Chunked) {
+        size_t remaining = min(len, _size);
+        for (const auto &chunk : _chunks.buffers()) {
+            if (remaining == 0) {
+                break;
+            }
+            const string_view view = chunk.str().substr(0, remaining);
+            ret.append(view);
+            remaining -= view.size();
+        }
+        return ret;
+    }
+    const auto [first, second] = _spans(len);
+    ret.append(first);
+    ret.append(second);
+    return ret;
+}
+
+//! \param[in] len bytes will be shared (or, with Storage::Ring, copied) from the output side of the buffer
+BufferList ByteStream::peek_output_buffers(const size_t len) const {
+    BufferList ret;
+    if (len == 0 || _size == 0 || _error) {
+        return ret;
+    }
+    if (_storage == Storage::Ring) {
+        ret.append(BufferList(peek_output(len)));
+        return ret;
+    }
+    size_t remaining = min(len, _size);
+    for (const auto &chunk : _chunks.buffers()) {
+        if (remaining == 0) {
+            break;
+        }
+        Buffer slice = chunk;
+        if (slice.size() > remaining) {
+            slice.remove_suffix(slice.size() - remaining);
+        }
+        remaining -= slice.size();
+        ret.append(BufferList(move(slice)));
+    }
+    return ret;
+}
+
+//! \param[in] len bytes will be read from the output side of the buffer
+Buffer ByteStream::read_buffer(const size_t len) {
+    const size_t n = min(len, buffer_size());
+    Buffer ret;
+    if (n == 0) {
+        return ret;
+    }
+    if (_storage == Storage::Chunked && _chunks.buffers().front().size() >= n) {
+        // the common case for a sender: one large write() feeds many segments
+        ret = _chunks.buffers().front();
+        ret.remove_suffix(ret.size() - n);
+    } else {
+        ret = peek_output(n);
+    }
+    pop_output(n);
+    return ret;
 }
 
 //! \param[in] len bytes will be removed from the output side of the buffer
-void ByteStream::pop_output(const size_t len) { 
+void ByteStream::pop_output(const size_t len) {
     if (len == 0 || eof() || _error) {
         return;  // Nothing to pop or stream is in error state
     }
-    
-    size_t to_pop = min(len, _buffer.size());
-    _buffer.erase(0, to_pop);
+
+    const size_t to_pop = min(len, _size);
+    if (_storage == Storage::Chunked) {
+        _chunks.remove_prefix(to_pop);
+        _size -= to_pop;
+        _bytes_read += to_pop;
+        return;
+    }
+
+    _head += to_pop;
+    if (_head >= _capacity) {
+        _head -= _capacity;
+    }
+    _size -= to_pop;
+    if (_size == 0) {
+        // keep the next write contiguous when the stream drains
+        _head = 0;
+    }
     _bytes_read += to_pop;
 }
 
@@ -56,32 +203,19 @@ void ByteStream::end_input() {
     _input_ended = true;  // Mark the input as ended
 }
 
-bool ByteStream::input_ended() const { 
-    return _input_ended;
-}
+bool ByteStream::input_ended() const { return _input_ended; }
 
-size_t ByteStream::buffer_size() const { 
-    return _buffer.size();
-}
+size_t ByteStream::buffer_size() const { return _size; }
 
-bool ByteStream::buffer_empty() const { 
-    return _buffer.empty();
-}
+bool ByteStream::buffer_empty() const { return _size == 0; }
 
-bool ByteStream::eof() const { 
+bool ByteStream::eof() const {
     // let buffer empty be eof as well
     return input_ended() && buffer_empty();
 }
 
-size_t ByteStream::bytes_written() const { 
-    return _bytes_written; 
-}
+size_t ByteStream::bytes_written() const { return _bytes_written; }
 
-size_t ByteStream::bytes_read() const { 
-    return _bytes_read; 
-}
-
-size_t ByteStream::remaining_capacity() const { 
-    return _capacity - _buffer.size(); 
-}
+size_t ByteStream::bytes_read() const { return _bytes_read; }
 
+size_t ByteStream::remaining_capacity() const { return _capacity - _size; }
@@ -1,11 +1,14 @@
 #ifndef SPONGE_LIBSPONGE_BYTE_STREAM_HH
 #define SPONGE_LIBSPONGE_BYTE_STREAM_HH
 
+#include "buffer.hh"
+
 #include <cstddef>
 #include <cstdint>
 #include <deque>
 #include <list>
 #include <string>
+#include <string_view>
 #include <utility>
 
 //! \brief An in-order byte stream.
@@ -13,19 +16,41 @@
 //! Bytes are written on the "input" side and read from the "output"
 //! side.  The byte stream is finite: the writer can end the input,
 //! and then no more bytes can be written.
+//!
+//! The bytes are held in one of two ways (see ByteStream::Storage):
+//! - in a fixed-size ring buffer that is allocated once, so popping never
+//!   moves the remaining bytes and the readable region is always at most
+//!   two contiguous spans (see peek_output_views()), or
+//! - as a queue of reference-counted Buffer chunks, so a Buffer written
+//!   into the stream can be read back out (see read_buffers()) without
+//!   copying its bytes.
 class ByteStream {
+  public:
+    //! How the stream keeps the bytes that have been written but not yet read
+    enum class Storage {
+        Ring,    //!< Copy written bytes into a preallocated ring buffer
+        Chunked  //!< Keep written bytes as shared Buffer slices
+    };
+
   private:
     // Your code here -- add private members as necessary.
     size_t _capacity{0};  //!< The maximum number of bytes that can be written.
+    Storage _storage{Storage::Ring};  //!< Which of the two representations holds the bytes.
     size_t _bytes_written{0};  //!< Total number of bytes written to the stream.
     size_t _bytes_read{0};  //!< Total number of bytes read from the stream.
-    std::string _buffer;  //!< The buffer holding the bytes.
+    std::string _buffer;  //!< Ring storage of `_capacity` bytes (Storage::Ring only).
+    size_t _head{0};  //!< Offset in `_buffer` of the first unread byte (Storage::Ring only).
+    BufferList _chunks{};  //!< Unread chunks (Storage::Chunked only).
+    size_t _size{0};  //!< Number of unread bytes held in the stream.
     bool _error{false};  //!< Flag indicating that the stream suffered an error.
     bool _input_ended{false};  //!< Flag indicating that the input has ended.
 
+    //! The (up to two) spans of `_buffer` holding the next `len` unread bytes
+    std::pair<std::string_view, std::string_view> _spans(const size_t len) const;
+
   public:
     //! Construct a stream with room for `capacity` bytes.
-    ByteStream(const size_t capacity);
+    ByteStream(const size_t capacity, const Storage storage = Storage::Ring);
 
     //! \name "Input" interface for the writer
     //!@{
@@ -33,7 +58,16 @@ class ByteStream {
     //! Write a string of bytes into the stream. Write as many
     //! as will fit, and return how many were written.
     //! \returns the number of bytes accepted into the stream
-    size_t write(const std::string &data);
+    size_t write(std::string_view data);
+
+    //! Write a shared Buffer into the stream. With Storage::Chunked the
+    //! accepted bytes are kept by reference and never copied.
+    //! \returns the number of bytes accepted into the stream
+    size_t write(Buffer data);
+
+    //! Write a string whose storage the stream may take over (see write(Buffer)).
+    //! \returns the number of bytes accepted into the stream
+    size_t write(std::string &&data);
 
     //! \returns the number of additional bytes that the stream has space for
     size_t remaining_capacity() const;
@@ -52,9 +86,31 @@ class ByteStream {
     //! \returns a string
     std::string peek_output(const size_t len) const;
 
+    //! Peek at next "len" bytes of the stream without copying them
+    //! \returns views (one, or two if the bytes wrap around the ring) that stay valid until the next
+    //!          write() or pop_output()
+    BufferViewList peek_output_views(const size_t len) const;
+
+    //! Peek at next "len" bytes of the stream as shared Buffer slices
+    //! \returns the bytes by reference with Storage::Chunked, or as one copied Buffer with Storage::Ring
+    BufferList peek_output_buffers(const size_t len) const;
+
     //! Remove bytes from the buffer
     void pop_output(const size_t len);
 
+    //! Read (i.e., peek as Buffer slices and then pop) the next "len" bytes of the stream
+    //! \returns the bytes read
+    BufferList read_buffers(const size_t len) {
+        auto ret = peek_output_buffers(len);
+        pop_output(len);
+        return ret;
+    }
+
+    //! Read the next "len" bytes of the stream as one Buffer
+    //! \returns a slice of the stream's storage when the bytes lie in a single chunk (Storage::Chunked),
+    //!          otherwise a copy
+    Buffer read_buffer(const size_t len);
+
     //! Read (i.e., copy and then pop) the next "len" bytes of the stream
     //! \returns a vector of bytes read
     std::string read(const size_t len) {
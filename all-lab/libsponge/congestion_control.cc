@@ -0,0 +1,131 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+//! \param[in] mss the sender maximum segment size, in bytes
+CongestionController::CongestionController(const size_t mss)
+    : _mss(mss), _cwnd(min(10 * mss, max(2 * mss, size_t{14600}))), _ssthresh(numeric_limits<size_t>::max()) {}
+
+//! \param[in] acked_bytes how many sequence numbers the ACK advanced
+void CongestionController::_slow_start(const size_t acked_bytes) {
+    // RFC 3465 allows up to two segments of growth per ACK, which keeps slow start
+    // on schedule when the receiver acknowledges every other segment
+    _cwnd += min(acked_bytes, 2 * _mss);
+}
+
+//! \param[in] bytes_in_flight outstanding bytes when the timer fired
+//! \param[in] now_ms the sender's clock, in milliseconds
+void CongestionController::on_timeout(const size_t bytes_in_flight, const uint64_t now_ms) {
+    _multiplicative_decrease(bytes_in_flight, now_ms);
+    _cwnd = _mss;
+}
+
+//! \param[in] bytes_in_flight outstanding bytes when the third duplicate ACK arrived
+//! \param[in] now_ms the sender's clock, in milliseconds
+void CongestionController::on_fast_retransmit(const size_t bytes_in_flight, const uint64_t now_ms) {
+    _multiplicative_decrease(bytes_in_flight, now_ms);
+    // the three duplicate ACKs mean three segments have left the network
+    _cwnd = _ssthresh + 3 * _mss;
+}
+
+//! \param[in] acked_bytes how many sequence numbers the partial ACK advanced
+void CongestionController::on_partial_ack(const size_t acked_bytes) {
+    // RFC 6582 (3.2, step 5): deflate by what left the network, then allow one new segment
+    _cwnd = _cwnd > acked_bytes ? _cwnd - acked_bytes : 0;
+    if (acked_bytes >= _mss) {
+        _cwnd += _mss;
+    }
+    _cwnd = max(_cwnd, _mss);
+}
+
+//! \param[in] bytes_in_flight outstanding bytes after the ACK that ended recovery
+void CongestionController::on_recovery_exit(const size_t bytes_in_flight) {
+    // RFC 6582 (3.2, step 6, option 1): deflate without allowing a burst
+    _cwnd = min(_ssthresh, max(bytes_in_flight, _mss) + _mss);
+}
+
+void RenoController::on_ack(const size_t acked_bytes, const uint64_t /* now_ms */) {
+    if (in_slow_start()) {
+        _slow_start(acked_bytes);
+        return;
+    }
+
+    // congestion avoidance: one MSS per cwnd's worth of acknowledged bytes, i.e. one MSS per RTT
+    _bytes_acked += acked_bytes;
+    if (_bytes_acked >= _cwnd) {
+        _bytes_acked -= _cwnd;
+        _cwnd += _mss;
+    }
+}
+
+void RenoController::_multiplicative_decrease(const size_t bytes_in_flight, const uint64_t /* now_ms */) {
+    _ssthresh = max(bytes_in_flight / 2, 2 * _mss);
+    _bytes_acked = 0;
+}
+
+void CubicController::on_ack(const size_t acked_bytes, const uint64_t now_ms) {
+    if (in_slow_start()) {
+        _slow_start(acked_bytes);
+        return;
+    }
+
+    const double mss = static_cast<double>(_mss);
+    const double w = static_cast<double>(_cwnd) / mss;
+    if (!_epoch_start.has_value()) {
+        // first ACK of a congestion avoidance epoch: aim the cubic curve back at _w_max
+        _epoch_start = now_ms;
+        _cwnd_frac = 0;
+        if (_w_max > w) {
+            _k = cbrt((_w_max - w) / C);
+        } else {
+            _k = 0;
+            _w_max = w;
+        }
+        _w_est = w;
+    }
+
+    const double t = static_cast<double>(now_ms - _epoch_start.value()) / 1000.0;
+    double target = C * pow(t - _k, 3) + _w_max;
+    target = min(max(target, w), 1.5 * w);
+
+    // never grow slower than Reno would have (RFC 9438, Section 4.3)
+    constexpr double ALPHA = 3.0 * (1.0 - BETA) / (1.0 + BETA);
+    const double acked_segments = static_cast<double>(acked_bytes) / mss;
+    _w_est += ALPHA * acked_segments / w;
+    target = max(target, _w_est);
+
+    _cwnd_frac += (target - w) / w * acked_segments * mss;
+    if (_cwnd_frac >= 1) {
+        const double grow = floor(_cwnd_frac);
+        _cwnd += static_cast<size_t>(grow);
+        _cwnd_frac -= grow;
+    }
+}
+
+void CubicController::_multiplicative_decrease(const size_t bytes_in_flight, const uint64_t /* now_ms */) {
+    const double w = static_cast<double>(_cwnd) / static_cast<double>(_mss);
+    // fast convergence: release bandwidth if the window is shrinking between losses
+    _w_max = w < _w_max ? w * (1.0 + BETA) / 2.0 : w;
+
+    _ssthresh = max(static_cast<size_t>(static_cast<double>(bytes_in_flight) * BETA), 2 * _mss);
+    _epoch_start.reset();
+}
+
+unique_ptr<CongestionController> make_congestion_controller(const TCPConfig::CongestionControl algorithm,
+                                                            const size_t mss) {
+    switch (algorithm) {
+        case TCPConfig::CongestionControl::Reno:
+            return make_unique<RenoController>(mss);
+        case TCPConfig::CongestionControl::NewReno:
+            return make_unique<NewRenoController>(mss);
+        case TCPConfig::CongestionControl::Cubic:
+            return make_unique<CubicController>(mss);
+        case TCPConfig::CongestionControl::None:
+            break;
+    }
+    return nullptr;
+}
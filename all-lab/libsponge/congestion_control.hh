@@ -0,0 +1,126 @@
+#ifndef SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
+#define SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
+
+#include "tcp_config.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+//! \brief Congestion window bookkeeping for a TCPSender.
+
+//! The TCPSender reports acknowledgments and losses; the controller answers with
+//! the congestion window (cwnd), the number of bytes the sender may have in flight
+//! regardless of what the receiver advertises. All quantities are in bytes.
+//!
+//! Fast recovery (RFC 5681, Section 3.2, and RFC 6582) is driven by the sender, which
+//! counts duplicate ACKs and tracks the recovery point; the controller only adjusts
+//! cwnd and ssthresh at each step.
+class CongestionController {
+  protected:
+    size_t _mss;       //!< sender maximum segment size
+    size_t _cwnd;      //!< congestion window
+    size_t _ssthresh;  //!< slow start threshold
+
+    //! Slow start (RFC 5681, Section 3.1): grow by at most two MSS per ACK
+    void _slow_start(const size_t acked_bytes);
+
+    //! \brief React to a loss (by timeout or by duplicate ACKs): set ssthresh and reset
+    //! any algorithm-specific growth state. cwnd is adjusted by the caller.
+    virtual void _multiplicative_decrease(const size_t bytes_in_flight, const uint64_t now_ms) = 0;
+
+  public:
+    //! Starts with the RFC 6928 initial window and an unbounded ssthresh
+    explicit CongestionController(const size_t mss);
+    virtual ~CongestionController() = default;
+
+    //! \brief Newly acknowledged data
+    //! \param[in] acked_bytes how many sequence numbers the ACK advanced
+    //! \param[in] now_ms the sender's clock, in milliseconds
+    virtual void on_ack(const size_t acked_bytes, const uint64_t now_ms) = 0;
+
+    //! \brief The retransmission timer expired
+    //! \param[in] bytes_in_flight outstanding bytes when the timer fired
+    //! \param[in] now_ms the sender's clock, in milliseconds
+    void on_timeout(const size_t bytes_in_flight, const uint64_t now_ms);
+
+    //! \name Fast retransmit and fast recovery
+    //!@{
+
+    //! \brief The third duplicate ACK arrived and the first unacknowledged segment was resent
+    void on_fast_retransmit(const size_t bytes_in_flight, const uint64_t now_ms);
+
+    //! \brief A further duplicate ACK arrived during recovery: one more segment has left the network
+    void on_recovery_dup_ack() { _cwnd += _mss; }
+
+    //! \brief An ACK advanced during recovery but stopped short of the recovery point (RFC 6582)
+    void on_partial_ack(const size_t acked_bytes);
+
+    //! \brief Recovery is over
+    //! \param[in] bytes_in_flight outstanding bytes after the ACK that ended recovery
+    void on_recovery_exit(const size_t bytes_in_flight);
+
+    //! \brief Whether partial ACKs keep the sender in recovery (NewReno) rather than ending it (Reno)
+    virtual bool partial_ack_recovery() const { return true; }
+    //!@}
+
+    //! \name Accessors
+    //!@{
+    size_t cwnd() const { return _cwnd; }
+    size_t ssthresh() const { return _ssthresh; }
+    bool in_slow_start() const { return _cwnd < _ssthresh; }
+    //!@}
+};
+
+//! Reno congestion avoidance (RFC 5681) with appropriate byte counting (RFC 3465)
+class RenoController : public CongestionController {
+  private:
+    //! bytes acknowledged since cwnd last grew during congestion avoidance
+    size_t _bytes_acked{0};
+
+  protected:
+    void _multiplicative_decrease(const size_t bytes_in_flight, const uint64_t now_ms) override;
+
+  public:
+    explicit RenoController(const size_t mss) : CongestionController(mss) {}
+
+    void on_ack(const size_t acked_bytes, const uint64_t now_ms) override;
+    bool partial_ack_recovery() const override { return false; }
+};
+
+//! Reno with the NewReno modification to fast recovery (RFC 6582)
+class NewRenoController : public RenoController {
+  public:
+    explicit NewRenoController(const size_t mss) : RenoController(mss) {}
+
+    bool partial_ack_recovery() const override { return true; }
+};
+
+//! CUBIC congestion avoidance (RFC 9438)
+class CubicController : public CongestionController {
+  private:
+    static constexpr double C = 0.4;     //!< cubic scaling constant
+    static constexpr double BETA = 0.7;  //!< multiplicative decrease factor
+
+    double _w_max{0};                        //!< window (in segments) before the last reduction
+    double _k{0};                            //!< seconds the cubic function takes to climb back to _w_max
+    double _w_est{0};                        //!< Reno-friendly window estimate, in segments
+    double _cwnd_frac{0};                    //!< fractional growth not yet added to _cwnd, in bytes
+    std::optional<uint64_t> _epoch_start{};  //!< when the current congestion avoidance epoch began
+
+  protected:
+    void _multiplicative_decrease(const size_t bytes_in_flight, const uint64_t now_ms) override;
+
+  public:
+    explicit CubicController(const size_t mss) : CongestionController(mss) {}
+
+    void on_ack(const size_t acked_bytes, const uint64_t now_ms) override;
+};
+
+//! \brief Build the controller selected by `algorithm`
+//! \returns nullptr for TCPConfig::CongestionControl::None (the sender is then limited by the peer's window only)
+std::unique_ptr<CongestionController> make_congestion_controller(const TCPConfig::CongestionControl algorithm,
+                                                                 const size_t mss);
+
+#endif  // SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
@@ -3,6 +3,7 @@
 #include "arp_message.hh"
 #include "ethernet_frame.hh"
 
+#include <algorithm>
 #include <iostream>
 
 // Dummy implementation of a network interface
@@ -64,6 +65,26 @@ void NetworkInterface::send_datagram(const InternetDatagram &dgram, const Addres
 
 }
 
+//! \param[in,out] dgram the serialized IPv4 datagram, in a packet with at least EthernetHeader::LENGTH of headroom
+//! \param[in] next_hop the IP address of the interface to send it to
+//! \returns whether `dgram` is now the Ethernet frame to send (false if it is waiting for ARP instead)
+bool NetworkInterface::send_datagram(PacketBuffer &dgram, const Address &next_hop) {
+    const auto it = _arp_table.find(next_hop.ipv4_numeric());
+    if (it == _arp_table.end() || it->second.ttl == 0) {
+        // the datagram has to wait for ARP, so queue it the usual way; the pending copy shares the packet's slab
+        InternetDatagram parsed;
+        if (parsed.parse(dgram.buffer()) == ParseResult::NoError) {
+            send_datagram(parsed, next_hop);
+        }
+        return false;
+    }
+
+    // the next hop is known, so the frame is the datagram with the Ethernet header written into its headroom
+    const EthernetHeader header{it->second.ethernet_address, _ethernet_address, EthernetHeader::TYPE_IPv4};
+    header.serialize_into(dgram.prepend(EthernetHeader::LENGTH), EthernetHeader::LENGTH);
+    return true;
+}
+
 //! \param[in] frame the incoming Ethernet frame
 optional<InternetDatagram> NetworkInterface::recv_frame(const EthernetFrame &frame) {
     const EthernetHeader &ethernet_header = frame.header();
@@ -162,3 +183,16 @@ void NetworkInterface::tick(const size_t ms_since_last_tick) {
     }
     // DUMMY_CODE(ms_since_last_tick); 
 }
+
+std::optional<uint64_t> NetworkInterface::ms_until_next_timer() const {
+    std::optional<uint64_t> next{};
+    for (const auto &[ip, pender] : _pending_datagrams) {
+        if (pender.empty()) {
+            continue;
+        }
+        const auto it = _arp_request_timers.find(ip);
+        const uint64_t ms = it == _arp_request_timers.end() ? 0 : it->second;
+        next = std::min(next.value_or(ms), ms);
+    }
+    return next;
+}
@@ -2,6 +2,7 @@
 #define SPONGE_LIBSPONGE_NETWORK_INTERFACE_HH
 
 #include "ethernet_frame.hh"
+#include "packet_pool.hh"
 #include "tcp_over_ip.hh"
 #include "tun.hh"
 
@@ -71,6 +72,12 @@ class NetworkInterface {
     //! ("Sending" is accomplished by pushing the frame onto the frames_out queue.)
     void send_datagram(const InternetDatagram &dgram, const Address &next_hop);
 
+    //! \brief Sends a serialized IPv4 datagram by prepending its Ethernet header in place, if the next hop is known
+
+    //! Returns true once `dgram` has become the frame, for the caller to send as it is. Otherwise the
+    //! datagram waits for ARP just as with the other send_datagram(), and its frame comes out of frames_out().
+    bool send_datagram(PacketBuffer &dgram, const Address &next_hop);
+
     //! \brief Receives an Ethernet frame and responds appropriately.
 
     //! If type is IPv4, returns the datagram.
@@ -80,6 +87,10 @@ class NetworkInterface {
 
     //! \brief Called periodically when time elapses
     void tick(const size_t ms_since_last_tick);
+
+    //! \brief Milliseconds until tick() must resend an ARP request, if any datagram is waiting on one
+    //! \note ARP entries expire lazily: the next tick() after their TTL drops them, however late it comes.
+    std::optional<uint64_t> ms_until_next_timer() const;
 };
 
 #endif  // SPONGE_LIBSPONGE_NETWORK_INTERFACE_HH
@@ -0,0 +1,45 @@
+#include "pacer.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+//! \param[in] bytes_per_ms the rate, or an empty optional to stop pacing
+//! \param[in] mss the sender's segment size
+void Pacer::set_rate(const optional<double> bytes_per_ms, const size_t mss) {
+    if (!bytes_per_ms.has_value() || bytes_per_ms.value() <= 0) {
+        _rate.reset();
+        return;
+    }
+    _mss = static_cast<double>(mss);
+    _burst = max(static_cast<double>(MIN_BURST_SEGMENTS) * _mss, bytes_per_ms.value() * BURST_MS);
+    if (!_rate.has_value()) {
+        // pacing starts with a full bucket
+        _tokens = _burst;
+    }
+    _rate = bytes_per_ms;
+    _tokens = min(_tokens, _burst);
+}
+
+//! \param[in] ms_since_last_tick the number of milliseconds since the last call to this method
+void Pacer::tick(const size_t ms_since_last_tick) {
+    if (!_rate.has_value()) {
+        return;
+    }
+    _tokens = min(_tokens + _rate.value() * static_cast<double>(ms_since_last_tick), _burst);
+}
+
+//! \param[in] bytes the length of the segment just sent
+void Pacer::on_send(const size_t bytes) {
+    if (_rate.has_value()) {
+        _tokens = max(_tokens - static_cast<double>(bytes), 0.0);
+    }
+}
+
+uint64_t Pacer::ms_until_send() const {
+    if (can_send()) {
+        return 0;
+    }
+    return static_cast<uint64_t>(ceil((_mss - _tokens) / _rate.value()));
+}
@@ -0,0 +1,54 @@
+#ifndef SPONGE_LIBSPONGE_PACER_HH
+#define SPONGE_LIBSPONGE_PACER_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+//! \brief Token bucket that spreads a TCPSender's segments across the round-trip time.
+
+//! The TCPSender sets the pacing rate from its window and SRTT whenever either changes;
+//! tick() adds tokens at that rate and every segment sent spends its length. A segment may
+//! go out once the bucket holds a full MSS of tokens. The bucket holds at most one millisecond
+//! of sending (and never less than two segments), which bounds the bursts the sender puts on
+//! the wire.
+//!
+//! Until a rate is set the pacer is inactive and never holds the sender back.
+class Pacer {
+  private:
+    static constexpr size_t MIN_BURST_SEGMENTS = 2;  //!< the bucket always holds at least this many segments
+    static constexpr double BURST_MS = 1;            //!< ...or this many milliseconds of sending
+
+    std::optional<double> _rate{};  //!< bytes per millisecond; unset while pacing is inactive
+    double _tokens{0};              //!< bytes that may be sent now
+    double _burst{0};               //!< bucket size, in bytes
+    double _mss{0};                 //!< tokens needed before a segment may be sent
+
+  public:
+    //! \brief Set the pacing rate
+    //! \param[in] bytes_per_ms the rate, or an empty optional to stop pacing
+    //! \param[in] mss the sender's segment size, which sets the smallest bucket
+    void set_rate(const std::optional<double> bytes_per_ms, const size_t mss);
+
+    //! \brief Add the tokens earned over `ms_since_last_tick`
+    void tick(const size_t ms_since_last_tick);
+
+    //! \brief Spend tokens on a segment of `bytes` bytes
+    void on_send(const size_t bytes);
+
+    //! \name Accessors
+    //!@{
+    bool active() const { return _rate.has_value(); }
+
+    //! \brief Whether a segment may be sent now
+    bool can_send() const { return !_rate.has_value() || _tokens >= _mss; }
+
+    //! \brief Milliseconds until can_send() becomes true (0 if it already is)
+    uint64_t ms_until_send() const;
+
+    //! \brief The pacing rate in bytes per millisecond (0 while inactive)
+    double rate() const { return _rate.value_or(0); }
+    //!@}
+};
+
+#endif  // SPONGE_LIBSPONGE_PACER_HH
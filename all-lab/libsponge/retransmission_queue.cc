@@ -0,0 +1,88 @@
+#include "retransmission_queue.hh"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+//! \param[in] seqno the absolute seqno of the segment's first byte
+//! \param[in] seg the segment as sent; only its flags and payload are kept
+void RetransmissionQueue::push(const uint64_t seqno, const TCPSegment &seg) {
+    if (!_entries.empty() && seqno != end_seqno()) {
+        throw runtime_error("RetransmissionQueue: segments must be pushed in sequence order without gaps");
+    }
+    _entries.push_back({seqno, seqno, seqno + seg.length_in_sequence_space(), seg.header().syn, seg.header().fin,
+                        seg.payload()});
+}
+
+//! \param[in] ackno the peer's cumulative acknowledgment, as an absolute seqno
+size_t RetransmissionQueue::acknowledge(const uint64_t ackno) {
+    size_t removed = 0;
+    while (!_entries.empty() && _entries.front().end <= ackno) {
+        _entries.pop_front();
+        removed++;
+    }
+    if (_entries.empty() || _entries.front().begin >= ackno) {
+        return removed;
+    }
+
+    // 部分确认：只移动起点，从 ackno 开始重组的段不会再发送对方已有的字节
+    _entries.front().begin = ackno;
+    return removed;
+}
+
+deque<RetransmissionQueue::Entry>::const_iterator RetransmissionQueue::_find(const uint64_t seqno) const {
+    if (_entries.empty() || seqno < front_sent_seqno() || seqno >= end_seqno()) {
+        throw out_of_range("RetransmissionQueue: seqno is not outstanding");
+    }
+    // entries are sorted, so the last one starting at or before seqno holds it
+    auto it = upper_bound(
+        _entries.begin(), _entries.end(), seqno, [](const uint64_t s, const Entry &e) { return s < e.sent; });
+    return prev(it);
+}
+
+//! \param[in] seqno where the segment starts
+//! \param[in] max_payload the most payload bytes to include
+//! \param[in] limit the segment ends before this seqno
+TCPSegment RetransmissionQueue::repacketize(const uint64_t seqno,
+                                            const size_t max_payload,
+                                            const uint64_t limit) const {
+    TCPSegment seg;
+    BufferList payload;
+    size_t taken = 0;
+    uint64_t next = seqno;
+
+    for (auto it = _find(seqno); it != _entries.end() && next < limit; ++it) {
+        if (it->syn && next == it->sent) {
+            if (next != seqno) {
+                break;  // a SYN only ever starts a segment
+            }
+            seg.header().syn = true;
+            next++;
+        }
+
+        const uint64_t data_begin = it->sent + (it->syn ? 1 : 0);
+        const uint64_t data_end = data_begin + it->payload.size();
+        const size_t n = min({data_end - next, max_payload - taken, limit - next});
+        if (n > 0) {
+            Buffer slice = it->payload;
+            slice.remove_prefix(next - data_begin);
+            slice.remove_suffix(slice.size() - n);
+            payload.append(move(slice));
+            taken += n;
+            next += n;
+        }
+
+        if (next == data_end && it->fin && next < limit) {
+            seg.header().fin = true;
+            break;
+        }
+        if (taken == max_payload || next < data_end) {
+            break;
+        }
+    }
+
+    seg.payload() = payload.buffers().size() > 1 ? Buffer(payload.concatenate()) : Buffer(payload);
+    return seg;
+}
@@ -0,0 +1,79 @@
+#ifndef SPONGE_LIBSPONGE_RETRANSMISSION_QUEUE_HH
+#define SPONGE_LIBSPONGE_RETRANSMISSION_QUEUE_HH
+
+#include "buffer.hh"
+#include "tcp_segment.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+
+//! \brief The sequence space a TCPSender has sent but the peer has not yet acknowledged.
+
+//! Each entry is keyed by its absolute (64-bit) sequence number and stores its end, so
+//! acknowledgments never have to unwrap a header. Entries are contiguous and in order:
+//! a cumulative ACK pops whole entries off the front and trims the first partly
+//! acknowledged one in place. Trimming only moves the entry's start; the payload is kept
+//! whole so that a timeout can still repeat the original transmission.
+//!
+//! The queue does not resend entries verbatim. repacketize() builds a fresh segment from
+//! whatever bytes are outstanding at a given seqno, so a retransmission can start in the
+//! middle of a segment, stop at the edge of a SACKed range, or merge small segments up to
+//! the MSS. The payload is a slice of the stored Buffer unless it spans two entries.
+class RetransmissionQueue {
+  private:
+    //! One transmission's worth of sequence space
+    struct Entry {
+        uint64_t sent;   //!< absolute seqno the segment started at when it was sent (its SYN, if `syn` is set)
+        uint64_t begin;  //!< absolute seqno of the first unacknowledged byte
+        uint64_t end;    //!< absolute seqno just past the entry (past the FIN, if `fin` is set)
+        bool syn;
+        bool fin;
+        Buffer payload;  //!< the payload as sent, starting at `sent` (or `sent + 1` after a SYN)
+    };
+
+    std::deque<Entry> _entries{};
+
+    //! The entry holding `seqno` (which must be outstanding)
+    std::deque<Entry>::const_iterator _find(const uint64_t seqno) const;
+
+  public:
+    //! \brief Record a segment that has just been sent
+    //! \param[in] seqno the absolute seqno of the segment's first byte; must equal end_seqno() unless the queue is empty
+    void push(const uint64_t seqno, const TCPSegment &seg);
+
+    //! \brief Forget everything below `ackno`, trimming a partly acknowledged entry
+    //! \returns the number of entries removed entirely
+    size_t acknowledge(const uint64_t ackno);
+
+    //! \brief A segment holding the outstanding sequence space starting at `seqno`
+    //! \param[in] seqno where the segment starts; must lie in [front_sent_seqno(), end_seqno())
+    //! \param[in] max_payload the most payload bytes to include (the MSS)
+    //! \param[in] limit the segment ends before this seqno, e.g. at the start of a SACKed range
+    //! \note The header's seqno is left unset; only `syn` and `fin` are filled in.
+    TCPSegment repacketize(const uint64_t seqno,
+                           const size_t max_payload,
+                           const uint64_t limit = std::numeric_limits<uint64_t>::max()) const;
+
+    //! \name Accessors
+    //!@{
+    bool empty() const { return _entries.empty(); }
+    size_t size() const { return _entries.size(); }
+
+    //! \brief absolute seqno of the first outstanding byte
+    uint64_t begin_seqno() const { return _entries.front().begin; }
+
+    //! \brief absolute seqno the oldest outstanding segment started at when it was sent
+    //! \note Below begin_seqno() after a partial ACK
+    uint64_t front_sent_seqno() const { return _entries.front().sent; }
+
+    //! \brief absolute seqno just past the oldest outstanding segment
+    uint64_t front_end_seqno() const { return _entries.front().end; }
+
+    //! \brief absolute seqno just past the last outstanding byte
+    uint64_t end_seqno() const { return _entries.back().end; }
+    //!@}
+};
+
+#endif  // SPONGE_LIBSPONGE_RETRANSMISSION_QUEUE_HH
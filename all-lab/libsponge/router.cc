@@ -67,14 +67,11 @@ void Router::route_one_datagram(InternetDatagram &dgram) {
         return;
     }
 
-    // TTL 检查 & 递减
-    if (dgram.header().ttl == 0) {
-        return;
-    }
-    dgram.header().ttl--;
-    if (dgram.header().ttl == 0) {
+    // TTL 检查 & 递减（校验和按 RFC 1624 增量更新，发送时不必重算整个首部）
+    if (dgram.header().ttl <= 1) {
         return;
     }
+    dgram.decrement_ttl();
 
     // next_hop：路由指定或 dst 本身
     const Address next_hop_addr = best_route.next_hop.value_or(
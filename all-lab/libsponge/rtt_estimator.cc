@@ -0,0 +1,35 @@
+#include "rtt_estimator.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+//! \param[in] rtt_ms time between sending a segment and receiving its acknowledgment
+void RTTEstimator::sample(const uint64_t rtt_ms) {
+    const double r = static_cast<double>(rtt_ms);
+    if (!_has_sample) {
+        // RFC 6298 (2.2)
+        _srtt = r;
+        _rttvar = r / 2;
+        _has_sample = true;
+        return;
+    }
+    // RFC 6298 (2.3): RTTVAR must be updated with the old SRTT
+    _rttvar = (1 - BETA) * _rttvar + BETA * fabs(_srtt - r);
+    _srtt = (1 - ALPHA) * _srtt + ALPHA * r;
+}
+
+uint64_t RTTEstimator::srtt() const { return static_cast<uint64_t>(llround(_srtt)); }
+
+uint64_t RTTEstimator::rttvar() const { return static_cast<uint64_t>(llround(_rttvar)); }
+
+uint64_t RTTEstimator::rto() const {
+    if (!_has_sample) {
+        return clamp(_initial_rto);
+    }
+    return clamp(static_cast<uint64_t>(ceil(_srtt + max(G, K * _rttvar))));
+}
+
+//! \param[in] rto the timeout to clamp
+uint64_t RTTEstimator::clamp(const uint64_t rto) const { return min(max(rto, _rto_min), _rto_max); }
@@ -0,0 +1,50 @@
+#ifndef SPONGE_LIBSPONGE_RTT_ESTIMATOR_HH
+#define SPONGE_LIBSPONGE_RTT_ESTIMATOR_HH
+
+#include <cstdint>
+
+//! \brief Round-trip time estimator and retransmission timeout calculator (RFC 6298).
+
+//! The TCPSender feeds it one RTT measurement at a time (never from a retransmitted
+//! segment, per Karn's algorithm) and reads back the smoothed RTT, the RTT variation,
+//! and the resulting RTO. All times are in milliseconds.
+class RTTEstimator {
+  private:
+    static constexpr double ALPHA = 1.0 / 8;  //!< gain of the SRTT filter
+    static constexpr double BETA = 1.0 / 4;   //!< gain of the RTTVAR filter
+    static constexpr double K = 4;            //!< weight of RTTVAR in the RTO
+    static constexpr double G = 1;            //!< clock granularity, in milliseconds
+
+    uint64_t _initial_rto;  //!< RTO to use before the first measurement
+    uint64_t _rto_min;      //!< lower clamp on the computed RTO
+    uint64_t _rto_max;      //!< upper clamp on the computed RTO
+
+    bool _has_sample{false};  //!< whether sample() has been called yet
+    double _srtt{0};          //!< smoothed round-trip time
+    double _rttvar{0};        //!< round-trip time variation
+
+  public:
+    //! \param[in] initial_rto the RTO until a measurement is available
+    //! \param[in] rto_min the smallest RTO that rto() will return
+    //! \param[in] rto_max the largest RTO that rto() will return
+    RTTEstimator(const uint64_t initial_rto, const uint64_t rto_min, const uint64_t rto_max)
+        : _initial_rto(initial_rto), _rto_min(rto_min), _rto_max(rto_max) {}
+
+    //! \brief Fold one RTT measurement into the estimate
+    void sample(const uint64_t rtt_ms);
+
+    //! \name Accessors
+    //!@{
+    bool has_sample() const { return _has_sample; }
+    uint64_t srtt() const;
+    uint64_t rttvar() const;
+
+    //! \brief The RTO that the estimate calls for, clamped to [rto_min, rto_max]
+    uint64_t rto() const;
+
+    //! \brief Clamp a (for example, backed-off) timeout to [rto_min, rto_max]
+    uint64_t clamp(const uint64_t rto) const;
+    //!@}
+};
+
+#endif  // SPONGE_LIBSPONGE_RTT_ESTIMATOR_HH
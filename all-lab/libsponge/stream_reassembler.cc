@@ -1,5 +1,6 @@
 #include "stream_reassembler.hh"
 
+#include <algorithm>
 #include <cassert>
 
 // Dummy implementation of a stream reassembler.
@@ -14,11 +15,14 @@ void DUMMY_CODE(Targs &&.../* unused */) {}
 
 using namespace std;
 
-StreamReassembler::StreamReassembler(const size_t capacity)
-    : _unassemble_strs()
+StreamReassembler::StreamReassembler(const size_t capacity, const Engine engine)
+    : _engine(engine)
+    , _unassemble_strs()
     , _next_assembled_idx(0)
     , _unassembled_bytes_num(0)
     , _eof_idx(-1)
+    , _ring(engine == Engine::Ring ? capacity : 0, '\0')
+    , _occupied(engine == Engine::Ring ? (capacity + 63) / 64 : 0, 0)
     , _output(capacity)
     , _capacity(capacity) {}
 
@@ -26,6 +30,42 @@ StreamReassembler::StreamReassembler(const size_t capacity)
 //! possibly out-of-order, from the logical stream, and assembles any newly
 //! contiguous substrings and writes them into the output stream in order.
 void StreamReassembler::push_substring(const string &data, const size_t index, const bool eof) {
+    if (_engine == Engine::Ring) {
+        _push_substring_ring(data, index);
+    } else {
+        _push_substring_map(Buffer(string(data)), index);
+    }
+    _check_eof(eof, index + data.size());
+}
+
+//! \details Same as push_substring(const std::string &, ...), but the bytes are taken from a
+//! shared Buffer (e.g. the payload of a parsed TCPSegment). Engine::Ring copies them once, into
+//! the output stream if they are in order or into the ring otherwise; Engine::Map keeps a
+//! reference to the Buffer's storage instead of copying.
+void StreamReassembler::push_substring(const Buffer &data, const size_t index, const bool eof) {
+    if (_engine == Engine::Ring) {
+        _push_substring_ring(data.str(), index);
+    } else {
+        _push_substring_map(data, index);
+    }
+    _check_eof(eof, index + data.size());
+}
+
+void StreamReassembler::_check_eof(const bool eof, const size_t end_idx) {
+    if (eof)
+        _eof_idx = end_idx;
+    if (_eof_idx <= _next_assembled_idx)
+        _output.end_input();
+}
+
+//! 截取 Buffer 中 [pos, pos + n) 的部分，与原 Buffer 共享存储，不拷贝数据
+static Buffer slice(Buffer buf, const size_t pos, const size_t n) {
+    buf.remove_prefix(pos);
+    buf.remove_suffix(buf.size() - n);
+    return buf;
+}
+
+void StreamReassembler::_push_substring_map(const Buffer &data, const size_t index) {
     /**
      * 传入的 substring 可能有以下几种情况
      * NOTE: 需要考虑到, _output 暂时装入不下的情况
@@ -143,7 +183,7 @@ void StreamReassembler::push_substring(const string &data, const size_t index, c
 
     // 判断是否还有数据是独立的， 顺便检测当前子串是否被上一个子串完全包含
     if (data_size > 0) {
-        const string new_data = data.substr(data_start_pos, data_size);
+        const Buffer new_data = slice(data, data_start_pos, data_size);
         // 如果新字串可以直接写入
         if (new_idx == _next_assembled_idx) {
             const size_t write_byte = _output.write(new_data);
@@ -151,12 +191,12 @@ void StreamReassembler::push_substring(const string &data, const size_t index, c
             // 如果没写全，则将其保存起来
             if (write_byte < new_data.size()) {
                 // _output 写不下了，插入进 _unassemble_strs 中
-                const string data_to_store = new_data.substr(write_byte, new_data.size() - write_byte);
+                const Buffer data_to_store = slice(new_data, write_byte, new_data.size() - write_byte);
                 _unassembled_bytes_num += data_to_store.size();
                 _unassemble_strs.insert(make_pair(_next_assembled_idx, std::move(data_to_store)));
             }
         } else {
-            const string data_to_store = new_data.substr(0, new_data.size());
+            const Buffer data_to_store = new_data;
             _unassembled_bytes_num += data_to_store.size();
             _unassemble_strs.insert(make_pair(new_idx, std::move(data_to_store)));
         }
@@ -172,7 +212,8 @@ void StreamReassembler::push_substring(const string &data, const size_t index, c
             // 如果没写全，则说明写满了，保留剩余没写全的部分并退出
             if (write_num < iter->second.size()) {
                 _unassembled_bytes_num += iter->second.size() - write_num;
-                _unassemble_strs.insert(make_pair(_next_assembled_idx, std::move(iter->second.substr(write_num))));
+                _unassemble_strs.insert(
+                    make_pair(_next_assembled_idx, slice(iter->second, write_num, iter->second.size() - write_num)));
 
                 _unassembled_bytes_num -= iter->second.size();
                 _unassemble_strs.erase(iter);
@@ -186,12 +227,160 @@ void StreamReassembler::push_substring(const string &data, const size_t index, c
         else
             break;
     }
-    if (eof)
-        _eof_idx = index + data.size();
-    if (_eof_idx <= _next_assembled_idx)
-        _output.end_input();
+}
+
+/**
+ * Ring 引擎：预先分配 capacity 大小的环形缓冲区，流中第 i 个字节固定存放在 _ring[i % _capacity]，
+ * 并用 _occupied 位图记录哪些字节已经到达。
+ *
+ * 可接收的窗口是 [_next_assembled_idx, _next_assembled_idx + _output.remaining_capacity())，
+ * 其长度不超过 capacity，因此窗口内任意两个字节不会落在环中的同一位置。
+ *
+ * 1. 截掉已经装配过的前缀以及超出窗口的后缀
+ * 2. 如果数据恰好从 _next_assembled_idx 开始，则直接写入 _output（只拷贝一次），
+ *    并清除环中被这段数据覆盖的位（这些字节是重复的）
+ * 3. 否则将数据原地写入环中并置位，每个字节只拷贝一次，重复到达的字节不会被重复计数
+ * 4. 最后从 _next_assembled_idx 开始查找连续置位的区间，把这些字节直接写入 _output
+ */
+void StreamReassembler::_push_substring_ring(const string_view data, const size_t index) {
+    const size_t first_unacceptable_idx = _next_assembled_idx + _output.remaining_capacity();
+    const size_t begin = max(index, _next_assembled_idx);
+    const size_t end = min(index + data.size(), first_unacceptable_idx);
+
+    if (begin < end) {
+        const string_view accepted = data.substr(begin - index, end - begin);
+        const bool in_order = begin == _next_assembled_idx;
+        if (in_order) {
+            // 按序到达：直接写入输出流
+            _output.write(accepted);
+            _next_assembled_idx = end;
+        }
+
+        // 将 [begin, end) 拆分为环中不回绕的至多两段
+        size_t pos = begin % _capacity;
+        size_t done = 0;
+        while (done < accepted.size()) {
+            const size_t len = min(accepted.size() - done, _capacity - pos);
+            if (in_order) {
+                // 已经写入输出流，环中对应的字节作废
+                _unassembled_bytes_num -= _clear_occupied(pos, pos + len);
+            } else {
+                copy_n(accepted.data() + done, len, _ring.begin() + pos);
+                _unassembled_bytes_num += _mark_occupied(pos, pos + len);
+            }
+            done += len;
+            pos = 0;
+        }
+    }
+
+    // 将环中紧接着 _next_assembled_idx 的连续字节写入输出流
+    while (_unassembled_bytes_num > 0) {
+        const size_t pos = _next_assembled_idx % _capacity;
+        const size_t run = _occupied_run(pos, _capacity);
+        if (run == 0) {
+            break;
+        }
+        _output.write(string_view(_ring).substr(pos, run));
+        _clear_occupied(pos, pos + run);
+        _unassembled_bytes_num -= run;
+        _next_assembled_idx += run;
+    }
+}
+
+vector<pair<uint64_t, uint64_t>> StreamReassembler::unassembled_intervals() const {
+    vector<pair<uint64_t, uint64_t>> ret;
+    const auto add = [&ret](const uint64_t begin, const uint64_t end) {
+        if (!ret.empty() && ret.back().second == begin) {
+            ret.back().second = end;
+        } else {
+            ret.emplace_back(begin, end);
+        }
+    };
+
+    if (_unassembled_bytes_num == 0) {
+        return ret;
+    }
+    if (_engine == Engine::Map) {
+        for (const auto &[index, data] : _unassemble_strs) {
+            add(index, index + data.size());
+        }
+        return ret;
+    }
+
+    // 在窗口内按环中不回绕的区段扫描位图
+    uint64_t idx = _next_assembled_idx;
+    const uint64_t end = _next_assembled_idx + _output.remaining_capacity();
+    while (idx < end) {
+        const size_t pos = idx % _capacity;
+        const size_t range_end = min<uint64_t>(_capacity, pos + (end - idx));
+        const size_t first = _next_occupied(pos, range_end);
+        if (first == range_end) {
+            idx += range_end - pos;
+            continue;
+        }
+        const size_t run = _occupied_run(first, range_end);
+        const uint64_t begin = idx + (first - pos);
+        add(begin, begin + run);
+        idx = begin + run;
+    }
+    return ret;
+}
+
+size_t StreamReassembler::_mark_occupied(const size_t begin, const size_t end) {
+    size_t newly_set = 0;
+    for (size_t i = begin; i < end;) {
+        const size_t bit = i % 64;
+        const size_t len = min(end - i, 64 - bit);
+        const uint64_t mask = (len == 64 ? ~uint64_t(0) : ((uint64_t(1) << len) - 1)) << bit;
+        uint64_t &word = _occupied[i / 64];
+        newly_set += __builtin_popcountll(mask & ~word);
+        word |= mask;
+        i += len;
+    }
+    return newly_set;
+}
+
+size_t StreamReassembler::_clear_occupied(const size_t begin, const size_t end) {
+    size_t cleared = 0;
+    for (size_t i = begin; i < end;) {
+        const size_t bit = i % 64;
+        const size_t len = min(end - i, 64 - bit);
+        const uint64_t mask = (len == 64 ? ~uint64_t(0) : ((uint64_t(1) << len) - 1)) << bit;
+        uint64_t &word = _occupied[i / 64];
+        cleared += __builtin_popcountll(mask & word);
+        word &= ~mask;
+        i += len;
+    }
+    return cleared;
+}
+
+size_t StreamReassembler::_occupied_run(const size_t begin, const size_t end) const {
+    size_t i = begin;
+    while (i < end) {
+        const size_t bit = i % 64;
+        const uint64_t missing = ~_occupied[i / 64] >> bit;
+        if (missing != 0) {
+            // 找到第一个尚未到达的字节
+            return min(end, i + __builtin_ctzll(missing)) - begin;
+        }
+        i += 64 - bit;
+    }
+    return end - begin;
 }
 
 size_t StreamReassembler::unassembled_bytes() const { return _unassembled_bytes_num; }
 
 bool StreamReassembler::empty() const { return _unassembled_bytes_num == 0; }
+
+size_t StreamReassembler::_next_occupied(const size_t begin, const size_t end) const {
+    size_t i = begin;
+    while (i < end) {
+        const size_t bit = i % 64;
+        const uint64_t present = _occupied[i / 64] >> bit;
+        if (present != 0) {
+            return min(end, i + __builtin_ctzll(present));
+        }
+        i += 64 - bit;
+    }
+    return end;
+}
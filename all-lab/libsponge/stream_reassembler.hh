@@ -5,26 +5,58 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <map>
+#include <utility>
+#include <vector>
 
 //! \brief A class that assembles a series of excerpts from a byte stream (possibly out of order,
 //! possibly overlapping) into an in-order byte stream.
 class StreamReassembler {
+  public:
+    //! How out-of-order bytes are held until they can be reassembled
+    enum class Engine {
+        Map,  //!< Non-overlapping substrings in a std::map keyed by stream index
+        Ring  //!< A preallocated ring of `capacity` bytes plus an occupancy bitmap
+    };
+
   private:
     // Your code here -- add private members as necessary.
-    std::map<size_t, std::string> _unassemble_strs;
+    Engine _engine;
+    std::map<size_t, Buffer> _unassemble_strs;  //!< Engine::Map: slices that share the pushed Buffers' storage
     size_t _next_assembled_idx;
     size_t _unassembled_bytes_num;
     size_t _eof_idx;
 
+    //! \name Engine::Ring state
+    //! Byte `i` of the stream lives at `_ring[i % _capacity]`; its bit in `_occupied` says whether it has arrived.
+    //!@{
+    std::string _ring;
+    std::vector<uint64_t> _occupied;
+    //!@}
+
     ByteStream _output;  //!< The reassembled in-order byte stream
     size_t _capacity;    //!< The maximum number of bytes
 
+    void _push_substring_map(const Buffer &data, const uint64_t index);
+    void _push_substring_ring(const std::string_view data, const uint64_t index);
+
+    //! Record the end of the stream (if `eof`) and end the output once every byte has been assembled
+    void _check_eof(const bool eof, const uint64_t end_idx);
+
+    //! \name Engine::Ring bitmap helpers (ring positions, `begin` <= `end` <= `_capacity`)
+    //!@{
+    size_t _mark_occupied(const size_t begin, const size_t end);  //!< \returns how many bits were newly set
+    size_t _clear_occupied(const size_t begin, const size_t end);  //!< \returns how many bits were cleared
+    size_t _occupied_run(const size_t begin, const size_t end) const;  //!< \returns length of the set run at `begin`
+    size_t _next_occupied(const size_t begin, const size_t end) const;  //!< \returns first set bit, or `end`
+    //!@}
+
   public:
     //! \brief Construct a `StreamReassembler` that will store up to `capacity` bytes.
     //! \note This capacity limits both the bytes that have been reassembled,
     //! and those that have not yet been reassembled.
-    StreamReassembler(const size_t capacity);
+    StreamReassembler(const size_t capacity, const Engine engine = Engine::Ring);
 
     //! \brief Receive a substring and write any newly contiguous bytes into the stream.
     //!
@@ -36,6 +68,12 @@ class StreamReassembler {
     //! \param eof the last byte of `data` will be the last byte in the entire stream
     void push_substring(const std::string &data, const uint64_t index, const bool eof);
 
+    //! \brief Receive a substring held in a shared Buffer, without copying it up front.
+    //! \param data the substring
+    //! \param index indicates the index (place in sequence) of the first byte in `data`
+    //! \param eof the last byte of `data` will be the last byte in the entire stream
+    void push_substring(const Buffer &data, const uint64_t index, const bool eof);
+
     //! \name Access the reassembled byte stream
     //!@{
     const ByteStream &stream_out() const { return _output; }
@@ -48,6 +86,10 @@ class StreamReassembler {
     //! should only be counted once for the purpose of this function.
     size_t unassembled_bytes() const;
 
+    //! \brief The stored-but-unassembled bytes as maximal runs of stream indices
+    //! \returns `[begin, end)` pairs in ascending order, none of them adjacent to another
+    std::vector<std::pair<uint64_t, uint64_t>> unassembled_intervals() const;
+
     //! \brief Is the internal state empty (other than the output stream)?
     //! \returns `true` if no substrings are waiting to be assembled
     bool empty() const;
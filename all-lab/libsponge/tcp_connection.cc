@@ -1,4 +1,5 @@
 #include "tcp_connection.hh"
+#include <algorithm>
 #include <iostream>
 
 using namespace std;
@@ -8,6 +9,15 @@ size_t TCPConnection::bytes_in_flight() const { return _sender.bytes_in_flight()
 size_t TCPConnection::unassembled_bytes() const { return _receiver.unassembled_bytes(); }
 size_t TCPConnection::time_since_last_segment_received() const { return _time_since_last_segment_received; }
 
+//! \param[in] capacity the receive capacity, in bytes
+uint8_t TCPConnection::_window_scale_for(const size_t capacity) {
+    uint8_t shift = 0;
+    while (shift < TCPHeader::MAX_WINDOW_SCALE && (capacity >> shift) > 0xffff) {
+        shift++;
+    }
+    return shift;
+}
+
 void TCPConnection::segment_received(const TCPSegment &seg) {
     if (!_is_active) return;
     _time_since_last_segment_received = 0;
@@ -18,12 +28,42 @@ void TCPConnection::segment_received(const TCPSegment &seg) {
         return;
     }
 
+    // RFC 7323 (4.3)：只记录不超过我方 ackno 的报文段中的时间戳，乱序到达的不算
+    const TCPHeader &hdr = seg.header();
+    if (hdr.has_timestamps &&
+        (hdr.syn || (_receiver.ackno().has_value() && hdr.seqno - _receiver.ackno().value() <= 0))) {
+        _ts_recent = hdr.tsval;
+    }
+
     // 2. 将包交给 Receiver
+    const optional<WrappingInt32> ackno_before = _receiver.ackno();
+    const size_t unassembled_before = _receiver.unassembled_bytes();
     _receiver.segment_received(seg);
+    if (hdr.syn) {
+        _sack_ok = _cfg.sack && hdr.sack_permitted;
+        _wscale_ok = _cfg.window_scaling && hdr.window_scale.has_value();
+        _snd_wscale = _wscale_ok ? min(hdr.window_scale.value(), TCPHeader::MAX_WINDOW_SCALE) : 0;
+        _ts_ok = _cfg.timestamps && hdr.has_timestamps;
+
+        // 对方的 MSS 只能让报文段变小（没有该选项时沿用我方的值）；时间戳选项占用的字节也要从负载中扣除
+        const size_t mss = min(_our_mss(), hdr.mss.has_value() ? size_t{hdr.mss.value()} : _our_mss());
+        const size_t options = _ts_ok ? TCPHeader::TIMESTAMPS_LENGTH : 0;
+        if (mss > options) {
+            _sender.set_mss(mss - options);
+        }
+    }
 
     // 3. 处理 ACK：只有在 Sender 已发送过 SYN 的情况下才处理 ACK
     if (seg.header().ack) {
-        _sender.ack_received(seg.header().ackno, seg.header().win);
+        if (_sack_ok && hdr.n_sack_blocks > 0) {
+            _sender.sack_received(hdr.sack_blocks.data(), hdr.n_sack_blocks);
+        }
+        if (_ts_ok && hdr.has_timestamps) {
+            _sender.timestamp_echo_received(hdr.tsecr);
+        }
+        // the window in a SYN is never scaled
+        const size_t window = size_t{hdr.win} << (_wscale_ok && !hdr.syn ? _snd_wscale : 0);
+        _sender.ack_received(hdr.ackno, window, seg.length_in_sequence_space() > 0);
     }
 
     // 4. 状态切换逻辑：Listen 状态收到 SYN
@@ -41,11 +81,17 @@ void TCPConnection::segment_received(const TCPSegment &seg) {
     }
 
     // 6. 发送回复
-    // 如果收到的是占序列号的包（SYN/FIN/Payload），必须回一个 ACK
+    // 如果收到的是占序列号的包（SYN/FIN/Payload），必须回一个 ACK；
+    // 启用延迟确认时，按序数据的第一个段先不确认，第二个段或定时器到期时再确认
     if (seg.length_in_sequence_space() > 0) {
         _sender.fill_window();
         if (_sender.segments_out().empty()) {
-            _sender.send_empty_segment();
+            if (!_ack_pending && _may_delay_ack(seg, ackno_before, unassembled_before)) {
+                _ack_pending = true;
+                _ack_delay_elapsed = 0;
+            } else {
+                _sender.send_empty_segment();
+            }
         }
     }
     
@@ -58,28 +104,68 @@ void TCPConnection::segment_received(const TCPSegment &seg) {
     _send_segments();
 }
 
+//! \param[in] seg the segment just given to the receiver
+//! \param[in] ackno_before the receiver's ackno before `seg` arrived
+//! \param[in] unassembled_before bytes the receiver was holding beyond a hole before `seg` arrived
+bool TCPConnection::_may_delay_ack(const TCPSegment &seg,
+                                   const optional<WrappingInt32> ackno_before,
+                                   const size_t unassembled_before) const {
+    // RFC 5681 (4.2): out-of-order, duplicate, and hole-filling segments are acknowledged at once,
+    // so the sender sees duplicate ACKs (and SACK blocks) without delay; SYN and FIN are never delayed
+    if (_cfg.delayed_ack == 0 || seg.header().syn || seg.header().fin || !ackno_before.has_value()) {
+        return false;
+    }
+    const uint32_t length = static_cast<uint32_t>(seg.length_in_sequence_space());
+    return seg.header().seqno == ackno_before.value() && _receiver.ackno() == ackno_before.value() + length &&
+           unassembled_before == 0 && _receiver.unassembled_bytes() == 0;
+}
+
+// 判断是否满足“干净关闭”的条件
+bool TCPConnection::_streams_finished() const {
+    return _receiver.stream_out().input_ended() && _sender.stream_in().eof() && _sender.bytes_in_flight() == 0 &&
+           _sender.next_seqno_absolute() == _sender.stream_in().bytes_written() + 2;
+}
+
 bool TCPConnection::active() const {
     if (!_is_active) return false;
-    
-    // 判断是否满足“干净关闭”的条件
-    bool streams_closed = (_receiver.stream_out().input_ended() && 
-                          _sender.stream_in().eof() && 
-                          _sender.bytes_in_flight() == 0 &&
-                          _sender.next_seqno_absolute() == _sender.stream_in().bytes_written() + 2);
-    
-    if (streams_closed) {
+
+    if (_streams_finished()) {
         if (!_linger_after_streams_finish) return false;
         if (_time_since_last_segment_received >= 10 * _cfg.rt_timeout) return false;
     }
     return true;
 }
 
+optional<uint64_t> TCPConnection::ms_until_next_timer() const {
+    if (!_is_active) return nullopt;
+
+    optional<uint64_t> next = _sender.ms_until_next_timer();
+    const auto consider = [&next](const uint64_t ms) { next = min(next.value_or(ms), ms); };
+
+    if (_ack_pending) {
+        consider(_ack_delay_elapsed >= _cfg.delayed_ack ? 0 : _cfg.delayed_ack - _ack_delay_elapsed);
+    }
+    // TIME_WAIT 的等待结束时连接变为不活跃
+    if (_linger_after_streams_finish && _streams_finished()) {
+        const uint64_t linger = 10 * _cfg.rt_timeout;
+        consider(_time_since_last_segment_received >= linger ? 0 : linger - _time_since_last_segment_received);
+    }
+    return next;
+}
+
 void TCPConnection::tick(const size_t ms_since_last_tick) {
     if (!_is_active) return;
     _time_since_last_segment_received += ms_since_last_tick;
 
     _sender.tick(ms_since_last_tick);
 
+    if (_ack_pending) {
+        _ack_delay_elapsed += ms_since_last_tick;
+        if (_ack_delay_elapsed >= _cfg.delayed_ack) {
+            _sender.send_empty_segment();
+        }
+    }
+
     // 检查重传上限
     if (_sender.consecutive_retransmissions() > TCPConfig::MAX_RETX_ATTEMPTS) {
         _set_rst_state(true);
@@ -103,6 +189,19 @@ size_t TCPConnection::write(const string &data) {
     return written;
 }
 
+// 直接把 Buffer 交给发送流，数据不会被拷贝
+size_t TCPConnection::write(Buffer data) {
+    size_t written = _sender.stream_in().write(move(data));
+    _sender.fill_window();
+    _send_segments();
+    return written;
+}
+
+void TCPConnection::uncork() {
+    _sender.uncork();
+    _send_segments();
+}
+
 void TCPConnection::end_input_stream() {
     _sender.stream_in().end_input();
     _sender.fill_window();
@@ -122,15 +221,41 @@ TCPConnection::~TCPConnection() {
 // 辅助函数：取出 Sender 的包并打上 Receiver 的标记
 void TCPConnection::_send_segments() {
     while (!_sender.segments_out().empty()) {
-        TCPSegment seg = _sender.segments_out().front();
+        TCPSegment seg = move(_sender.segments_out().front());
         _sender.segments_out().pop();
 
         if (_receiver.ackno().has_value()) {
+            // every segment carries the ACK, so a pending delayed ACK rides along with it
+            _ack_pending = false;
             seg.header().ack = true;
             seg.header().ackno = _receiver.ackno().value();
-            seg.header().win = _receiver.window_size() > 0xffff ? 0xffff : _receiver.window_size();
+            const size_t shift = _wscale_ok && !seg.header().syn ? _rcv_wscale : 0;
+            seg.header().win = static_cast<uint16_t>(min<size_t>(_receiver.window_size() >> shift, 0xffff));
+            if (_sack_ok) {
+                // SACK blocks only use what the payload leaves of the MSS, so the datagram stays within the MTU
+                const size_t room = _sender.mss() - min(_sender.mss(), seg.payload().size());
+                const size_t max_blocks = room >= 4 + 8 ? min(TCPHeader::MAX_SACK_BLOCKS, (room - 4) / 8) : 0;
+                const auto blocks = _receiver.sack_blocks(max_blocks);
+                copy(blocks.begin(), blocks.end(), seg.header().sack_blocks.begin());
+                seg.header().n_sack_blocks = static_cast<uint8_t>(blocks.size());
+            }
+        }
+        // 主动打开时总是提供这些选项；被动打开时只有对方提供了才回应
+        const bool active_open = seg.header().syn && !_receiver.ackno().has_value();
+        if (seg.header().syn) {
+            seg.header().mss = static_cast<uint16_t>(min<size_t>(_our_mss(), 0xffff));
+            seg.header().sack_permitted = active_open ? _cfg.sack : _sack_ok;
+            if (active_open ? _cfg.window_scaling : _wscale_ok) {
+                seg.header().window_scale = _rcv_wscale;
+            }
+        }
+        if (active_open ? _cfg.timestamps : _ts_ok) {
+            seg.header().has_timestamps = true;
+            seg.header().tsval = static_cast<uint32_t>(_sender.now_ms());
+            seg.header().tsecr = _ts_recent;
         }
-        _segments_out.push(seg);
+        seg.header().doff = (TCPHeader::LENGTH + seg.header().options_length()) / 4;
+        _segments_out.push(move(seg));
     }
 }
 
@@ -10,7 +10,7 @@ class TCPConnection {
   private:
     TCPConfig _cfg;
     TCPReceiver _receiver{_cfg.recv_capacity};
-    TCPSender _sender{_cfg.send_capacity, _cfg.rt_timeout, _cfg.fixed_isn};
+    TCPSender _sender{_cfg};
 
     std::queue<TCPSegment> _segments_out{};
     bool _linger_after_streams_finish{true};
@@ -19,6 +19,38 @@ class TCPConnection {
     // [新增] 记录自上次收到数据包以来的时间
     size_t _time_since_last_segment_received{0};
 
+    //! both sides offered SACK in their SYNs, so SACK blocks are sent and honored
+    bool _sack_ok{false};
+
+    //! \name RFC 7323 state, settled by the SYN exchange
+    //!@{
+    bool _wscale_ok{false};                                      //!< both SYNs carried a window scale
+    uint8_t _rcv_wscale{_window_scale_for(_cfg.recv_capacity)};  //!< shift applied to the windows we advertise
+    uint8_t _snd_wscale{0};                                      //!< shift applied to the peer's windows
+    bool _ts_ok{false};                                          //!< both SYNs carried timestamps
+    uint32_t _ts_recent{0};                                      //!< the peer's TSval to echo back
+    //!@}
+
+    //! \name Delayed ACK state
+    //!@{
+    bool _ack_pending{false};      //!< in-order data arrived that has not been acknowledged yet
+    size_t _ack_delay_elapsed{0};  //!< milliseconds since `_ack_pending` was set
+    //!@}
+
+    //! whether the ACK for `seg` may wait: it carried only in-order data and left no hole behind
+    bool _may_delay_ack(const TCPSegment &seg,
+                        const std::optional<WrappingInt32> ackno_before,
+                        const size_t unassembled_before) const;
+
+    //! the MSS we offer: the largest payload we are prepared to receive, and to send
+    size_t _our_mss() const { return _cfg.mss.value_or(TCPConfig::MAX_PAYLOAD_SIZE); }
+
+    //! smallest shift that lets a window of `capacity` bytes be advertised in 16 bits
+    static uint8_t _window_scale_for(const size_t capacity);
+
+    //! both streams are finished and everything we sent has been acknowledged
+    bool _streams_finished() const;
+
     // [新增] 辅助函数：将 Sender 产生的包取出，填充 Receiver 的信息后放入发送队列
     void _send_segments();
 
@@ -28,13 +60,28 @@ class TCPConnection {
   public:
     void connect();
     size_t write(const std::string &data);
+    size_t write(Buffer data);
     size_t remaining_outbound_capacity() const;
     void end_input_stream();
+
+    //! \brief Send only full segments until uncork() (or until the cork timeout), like TCP_CORK
+    void cork() { _sender.cork(); }
+    //! \brief Send whatever cork() held back
+    void uncork();
+    bool corked() const { return _sender.corked(); }
+
     ByteStream &inbound_stream() { return _receiver.stream_out(); }
 
     size_t bytes_in_flight() const;
     size_t unassembled_bytes() const;
     size_t time_since_last_segment_received() const;
+    uint64_t srtt() const { return _sender.srtt(); }
+    uint64_t rttvar() const { return _sender.rttvar(); }
+    unsigned int retransmission_timeout() const { return _sender.retransmission_timeout(); }
+    //! milliseconds until the pacer releases the next segment, if it is holding data back
+    std::optional<uint64_t> pacing_delay() const { return _sender.pacing_delay(); }
+    //! milliseconds until tick() next has work to do (a timer expires), or nothing if no timer is pending
+    std::optional<uint64_t> ms_until_next_timer() const;
     TCPState state() const { return {_sender, _receiver, active(), _linger_after_streams_finish}; };
 
     void segment_received(const TCPSegment &seg);
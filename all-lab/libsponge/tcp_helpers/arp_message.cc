@@ -1,8 +1,10 @@
 #include "arp_message.hh"
 
+#include <algorithm>
 #include <arpa/inet.h>
 #include <iomanip>
 #include <sstream>
+#include <stdexcept>
 
 using namespace std;
 
@@ -45,31 +47,38 @@ bool ARPMessage::supported() const {
 }
 
 string ARPMessage::serialize() const {
+    string ret(LENGTH, '\0');
+    serialize_into(reinterpret_cast<uint8_t *>(ret.data()), ret.size());
+    return ret;
+}
+
+//! \param[out] out is where to write the message
+//! \param[in] size is the room at `out`, which must be at least LENGTH bytes
+size_t ARPMessage::serialize_into(uint8_t *const out, const size_t size) const {
     if (not supported()) {
         throw runtime_error(
             "ARPMessage::serialize(): unsupported field combination (must be Ethernet/IP, and request or reply)");
     }
+    if (size < LENGTH) {
+        throw runtime_error("ARPMessage::serialize_into: no room for the message");
+    }
 
-    string ret;
-    NetUnparser::u16(ret, hardware_type);
-    NetUnparser::u16(ret, protocol_type);
-    NetUnparser::u8(ret, hardware_address_size);
-    NetUnparser::u8(ret, protocol_address_size);
-    NetUnparser::u16(ret, opcode);
+    uint8_t *p = out;
+    p = NetUnparser::u16(p, hardware_type);
+    p = NetUnparser::u16(p, protocol_type);
+    p = NetUnparser::u8(p, hardware_address_size);
+    p = NetUnparser::u8(p, protocol_address_size);
+    p = NetUnparser::u16(p, opcode);
 
     /* write sender addresses */
-    for (auto &byte : sender_ethernet_address) {
-        NetUnparser::u8(ret, byte);
-    }
-    NetUnparser::u32(ret, sender_ip_address);
+    p = copy(sender_ethernet_address.begin(), sender_ethernet_address.end(), p);
+    p = NetUnparser::u32(p, sender_ip_address);
 
     /* write target addresses */
-    for (auto &byte : target_ethernet_address) {
-        NetUnparser::u8(ret, byte);
-    }
-    NetUnparser::u32(ret, target_ip_address);
+    p = copy(target_ethernet_address.begin(), target_ethernet_address.end(), p);
+    NetUnparser::u32(p, target_ip_address);
 
-    return ret;
+    return LENGTH;
 }
 
 string ARPMessage::to_string() const {
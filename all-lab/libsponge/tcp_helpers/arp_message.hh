@@ -34,6 +34,10 @@ struct ARPMessage {
     //! Serialize the ARP message to a string
     std::string serialize() const;
 
+    //! \brief Serialize the ARP message into a caller's buffer, which must have room for LENGTH bytes
+    //! \returns the number of bytes written, LENGTH
+    size_t serialize_into(uint8_t *out, const size_t size) const;
+
     //! Return a string containing the ARP message in human-readable format
     std::string to_string() const;
 
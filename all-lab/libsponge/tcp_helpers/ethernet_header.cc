@@ -2,8 +2,10 @@
 
 #include "util.hh"
 
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
+#include <stdexcept>
 
 using namespace std;
 
@@ -29,23 +31,28 @@ ParseResult EthernetHeader::parse(NetParser &p) {
 }
 
 string EthernetHeader::serialize() const {
-    string ret;
-    ret.reserve(LENGTH);
+    string ret(LENGTH, '\0');
+    serialize_into(reinterpret_cast<uint8_t *>(ret.data()), ret.size());
+    return ret;
+}
 
-    /* write destination address */
-    for (auto &byte : dst) {
-        NetUnparser::u8(ret, byte);
+//! \param[out] out is where to write the header
+//! \param[in] size is the room at `out`, which must be at least LENGTH bytes
+size_t EthernetHeader::serialize_into(uint8_t *const out, const size_t size) const {
+    if (size < LENGTH) {
+        throw runtime_error("EthernetHeader::serialize_into: no room for the header");
     }
 
+    /* write destination address */
+    uint8_t *p = copy(dst.begin(), dst.end(), out);
+
     /* write source address */
-    for (auto &byte : src) {
-        NetUnparser::u8(ret, byte);
-    }
+    p = copy(src.begin(), src.end(), p);
 
     /* write the frame's type (e.g. IPv4, ARP or something else) */
-    NetUnparser::u16(ret, type);
+    NetUnparser::u16(p, type);
 
-    return ret;
+    return LENGTH;
 }
 
 //! \returns A string with a textual representation of an Ethernet address
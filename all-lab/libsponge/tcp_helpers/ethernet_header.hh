@@ -33,6 +33,10 @@ struct EthernetHeader {
     //! Serialize the Ethernet fields to a string
     std::string serialize() const;
 
+    //! \brief Serialize the Ethernet fields into a caller's buffer, which must have room for LENGTH bytes
+    //! \returns the number of bytes written, LENGTH
+    size_t serialize_into(uint8_t *out, const size_t size) const;
+
     //! Return a string containing a header in human-readable format
     std::string to_string() const;
 };
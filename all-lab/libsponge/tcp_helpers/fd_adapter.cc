@@ -1,7 +1,9 @@
 #include "fd_adapter.hh"
 
+#include <array>
 #include <iostream>
 #include <stdexcept>
+#include <string_view>
 #include <utility>
 
 using namespace std;
@@ -48,9 +50,36 @@ optional<TCPSegment> TCPOverUDPSocketAdapter::read() {
 //! Serialize a TCP segment and send it as the payload of a UDP datagram.
 //! \param[in] seg is the TCP segment to write
 void TCPOverUDPSocketAdapter::write(TCPSegment &seg) {
-    seg.header().sport = config().source.port();
-    seg.header().dport = config().destination.port();
-    _sock.sendto(config().destination, seg.serialize(0));
+    write_to(seg, FourTuple::from_addresses(config().source, config().destination));
+}
+
+//! \param[out] tuple is set to the connection the segment belongs to, if one was read
+//! \returns a std::optional<TCPSegment> that is empty if the payload was not a valid TCP segment
+optional<TCPSegment> TCPOverUDPSocketAdapter::read_any(FourTuple &tuple) {
+    auto datagram = _sock.recv();
+
+    TCPSegment seg;
+    if (ParseResult::NoError != seg.parse(move(datagram.payload), 0)) {
+        return {};
+    }
+
+    // as in read(), the UDP addresses stand in for the TCP ports
+    tuple = FourTuple::from_addresses(config().source, datagram.source_address);
+    return seg;
+}
+
+//! \param[in] seg is the TCP segment to write
+//! \param[in] tuple is the connection to send it on
+void TCPOverUDPSocketAdapter::write_to(TCPSegment &seg, const FourTuple &tuple) {
+    seg.header().sport = tuple.local_port;
+    seg.header().dport = tuple.remote_port;
+
+    // the header goes on the stack and the payload is sent where it lies, so nothing is copied to the heap
+    array<uint8_t, TCPHeader::LENGTH + TCPHeader::MAX_OPTIONS_LENGTH> header;
+    const size_t header_len = seg.serialize_header_into(header.data(), header.size());
+    BufferViewList datagram{string_view{reinterpret_cast<const char *>(header.data()), header_len}};
+    datagram.append(seg.payload());
+    _sock.sendto(tuple.remote_address(), datagram);
 }
 
 //! Specialize LossyFdAdapter to TCPOverUDPSocketAdapter
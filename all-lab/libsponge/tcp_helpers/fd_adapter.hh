@@ -2,6 +2,7 @@
 #define SPONGE_LIBSPONGE_FD_ADAPTER_HH
 
 #include "file_descriptor.hh"
+#include "four_tuple.hh"
 #include "lossy_fd_adapter.hh"
 #include "socket.hh"
 #include "tcp_config.hh"
@@ -40,6 +41,15 @@ class FdAdapterBase {
 
     //! Called periodically when time elapses
     void tick(const size_t) {}
+
+    //! Milliseconds until tick() next has work to do; the base adapter keeps no timers
+    std::optional<uint64_t> ms_until_next_timer() const { return {}; }
+
+    //! Whether read() has input waiting that the fd will not signal; the base adapter reads straight from the fd
+    bool has_buffered_input() const { return false; }
+
+    //! Send any segments write() has held back; the base adapter writes each one immediately
+    void flush() {}
 };
 
 //! \brief A FD adaptor that reads and writes TCP segments in UDP payloads
@@ -48,6 +58,11 @@ class TCPOverUDPSocketAdapter : public FdAdapterBase {
     UDPSocket _sock;
 
   public:
+    //! MTU assumed for the path the UDP datagrams take (Ethernet's)
+    static constexpr size_t PATH_MTU = 1500;
+    //! Bytes of IPv4 and UDP headers in front of each TCP segment
+    static constexpr size_t ENCAPSULATION_OVERHEAD = 20 + 8;
+
     //! Construct from a UDPSocket sliced into a FileDescriptor
     explicit TCPOverUDPSocketAdapter(UDPSocket &&sock) : _sock(std::move(sock)) {}
 
@@ -57,6 +72,17 @@ class TCPOverUDPSocketAdapter : public FdAdapterBase {
     //! Writes a TCP segment into a UDP payload
     void write(TCPSegment &seg);
 
+    //! \brief Reads a TCP segment from any peer, and reports the connection it belongs to
+    //! \details Every connection over one UDP socket has config().source as its local end; the peer
+    //! is the sender of the datagram.
+    std::optional<TCPSegment> read_any(FourTuple &tuple);
+
+    //! Writes a TCP segment into a UDP payload sent to `tuple`'s remote end, whatever config() says
+    void write_to(TCPSegment &seg, const FourTuple &tuple);
+
+    //! Largest TCP payload that fits in one datagram on a PATH_MTU path, with no TCP options
+    size_t mss() const { return PATH_MTU - ENCAPSULATION_OVERHEAD - TCPHeader::LENGTH; }
+
     //! Access the underlying UDP socket
     operator UDPSocket &() { return _sock; }
 
@@ -0,0 +1,37 @@
+#include "four_tuple.hh"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+using namespace std;
+
+//! \param[in] address an IPv4 address
+//! \returns its port, read straight from the sockaddr (Address::port() goes through getnameinfo)
+static uint16_t port_of(const Address &address) {
+    const sockaddr *addr = address;
+    return be16toh(reinterpret_cast<const sockaddr_in *>(addr)->sin_port);
+}
+
+//! \param[in] ip numeric IPv4 address, in host byte order
+//! \param[in] port port number, in host byte order
+static Address address_of(const uint32_t ip, const uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htobe32(ip);
+    addr.sin_port = htobe16(port);
+    return {reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)};
+}
+
+//! \param[in] local this end's address; must be IPv4
+//! \param[in] remote the peer's address; must be IPv4
+FourTuple FourTuple::from_addresses(const Address &local, const Address &remote) {
+    // ipv4_numeric() throws unless the address is IPv4, which also makes port_of() safe
+    return {local.ipv4_numeric(), port_of(local), remote.ipv4_numeric(), port_of(remote)};
+}
+
+Address FourTuple::local_address() const { return address_of(local_ip, local_port); }
+
+Address FourTuple::remote_address() const { return address_of(remote_ip, remote_port); }
+
+string FourTuple::to_string() const { return local_address().to_string() + " -> " + remote_address().to_string(); }
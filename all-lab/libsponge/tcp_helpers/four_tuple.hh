@@ -0,0 +1,53 @@
+#ifndef SPONGE_LIBSPONGE_FOUR_TUPLE_HH
+#define SPONGE_LIBSPONGE_FOUR_TUPLE_HH
+
+#include "address.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+//! \brief The IPv4 addresses and ports at the two ends of a TCP connection, which together identify it
+//! \details All four fields are numeric and in host byte order, so a tuple is cheap to build from a
+//! segment's headers and to hash. An address of 0 stands for "any" (INADDR_ANY).
+struct FourTuple {
+    uint32_t local_ip{0};     //!< IPv4 address of this end
+    uint16_t local_port{0};   //!< port of this end
+    uint32_t remote_ip{0};    //!< IPv4 address of the peer
+    uint16_t remote_port{0};  //!< port of the peer
+
+    //! The tuple of a connection between two IPv4 addresses (e.g. an FdAdapterConfig's source and destination)
+    static FourTuple from_addresses(const Address &local, const Address &remote);
+
+    //! This end's address and port
+    Address local_address() const;
+
+    //! The peer's address and port
+    Address remote_address() const;
+
+    //! "local_ip:port -> remote_ip:port"
+    std::string to_string() const;
+
+    bool operator==(const FourTuple &other) const {
+        return local_ip == other.local_ip and local_port == other.local_port and remote_ip == other.remote_ip and
+               remote_port == other.remote_port;
+    }
+    bool operator!=(const FourTuple &other) const { return not operator==(other); }
+};
+
+namespace std {
+//! Hash of a FourTuple, so that connections can be kept in a std::unordered_map
+template <>
+struct hash<FourTuple> {
+    size_t operator()(const FourTuple &t) const {
+        const uint64_t ips = (uint64_t{t.remote_ip} << 32) | t.local_ip;
+        const uint64_t ports = (uint64_t{t.remote_port} << 16) | t.local_port;
+        // multiply by odd constants so that every input bit reaches the high bits, then fold them down
+        const uint64_t mixed = ips * 0x9e3779b97f4a7c15ULL ^ ports * 0xc2b2ae3d27d4eb4fULL;
+        return static_cast<size_t>(mixed ^ (mixed >> 29));
+    }
+};
+}  // namespace std
+
+#endif  // SPONGE_LIBSPONGE_FOUR_TUPLE_HH
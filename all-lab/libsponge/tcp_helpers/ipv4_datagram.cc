@@ -5,6 +5,7 @@
 
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 using namespace std;
 
@@ -25,17 +26,39 @@ BufferList IPv4Datagram::serialize() const {
         throw runtime_error("IPv4Datagram::serialize: payload is wrong size");
     }
 
-    IPv4Header header_out = _header;
-    header_out.cksum = 0;
-    const string header_zero_checksum = header_out.serialize();
-
-    // calculate checksum -- taken over header only
-    InternetChecksum check;
-    check.add(header_zero_checksum);
-    header_out.cksum = check.value();
+    string header_bytes(4 * _header.hlen, '\0');
+    serialize_header_into(reinterpret_cast<uint8_t *>(header_bytes.data()), header_bytes.size());
 
     BufferList ret;
-    ret.append(header_out.serialize());
+    ret.append(move(header_bytes));
     ret.append(_payload);
     return ret;
 }
+
+//! \param[out] out is where to write the header
+//! \param[in] size is the room at `out`
+size_t IPv4Datagram::serialize_header_into(uint8_t *const out, const size_t size) const {
+    const size_t len = _header.serialize_into(out, size);
+    if (_cksum_current) {
+        return len;
+    }
+    NetUnparser::u16(out + IPv4Header::CKSUM_OFFSET, 0);
+
+    // calculate checksum -- taken over header only -- and patch it into the header in place
+    InternetChecksum check;
+    check.add({reinterpret_cast<const char *>(out), len});
+    NetUnparser::u16(out + IPv4Header::CKSUM_OFFSET, check.value());
+
+    return len;
+}
+
+void IPv4Datagram::decrement_ttl() {
+    if (_header.ttl == 0) {
+        throw runtime_error("IPv4Datagram::decrement_ttl: TTL is already zero");
+    }
+    // the TTL shares its 16-bit word of the header with the protocol
+    const uint16_t old_word = _header.ttl << 8 | _header.proto;
+    _header.ttl--;
+    _header.cksum = InternetChecksum::update(_header.cksum, old_word, _header.ttl << 8 | _header.proto);
+    _cksum_current = true;
+}
@@ -9,6 +9,7 @@ class IPv4Datagram {
   private:
     IPv4Header _header{};
     BufferList _payload{};
+    bool _cksum_current{false};  //!< whether `_header.cksum` is known to be right, so need not be recomputed
 
   public:
     //! \brief Parse the segment from a string
@@ -17,10 +18,25 @@ class IPv4Datagram {
     //! \brief Serialize the segment to a string
     BufferList serialize() const;
 
+    //! \brief Serialize the header, checksum included, into a caller's buffer, which must have room for
+    //! `4 * header().hlen` bytes; the datagram is then those bytes followed by payload(), which is not copied
+    //! \returns the number of bytes written
+    size_t serialize_header_into(uint8_t *out, const size_t size) const;
+
+    //! \brief Decrement the TTL (as a router does), adjusting the checksum for it per RFC 1624
+    //! \details The header's checksum must be right beforehand, as it is after parse(). Until the header is next
+    //! changed through header(), serializing writes the adjusted checksum rather than recomputing it.
+    void decrement_ttl();
+
     //! \name Accessors
     //!@{
     const IPv4Header &header() const { return _header; }
-    IPv4Header &header() { return _header; }
+
+    //! \note Changing the header makes serializing recompute its checksum
+    IPv4Header &header() {
+        _cksum_current = false;
+        return _header;
+    }
 
     const BufferList &payload() const { return _payload; }
     BufferList &payload() { return _payload; }
@@ -2,9 +2,11 @@
 
 #include "util.hh"
 
+#include <algorithm>
 #include <arpa/inet.h>
 #include <iomanip>
 #include <sstream>
+#include <stdexcept>
 
 using namespace std;
 
@@ -76,6 +78,14 @@ ParseResult IPv4Header::parse(NetParser &p) {
 
 //! Serialize the IPv4Header to a string (does not recompute the checksum)
 string IPv4Header::serialize() const {
+    string ret(4 * hlen, '\0');
+    serialize_into(reinterpret_cast<uint8_t *>(ret.data()), ret.size());
+    return ret;
+}
+
+//! \param[out] out is where to write the header
+//! \param[in] size is the room at `out`, which must be at least `4 * hlen` bytes
+size_t IPv4Header::serialize_into(uint8_t *const out, const size_t size) const {
     // sanity checks
     if (ver != 4) {
         throw runtime_error("wrong IP version");
@@ -83,30 +93,31 @@ string IPv4Header::serialize() const {
     if (4 * hlen < IPv4Header::LENGTH) {
         throw runtime_error("IP header too short");
     }
+    if (size < 4 * size_t{hlen}) {
+        throw runtime_error("IPv4Header::serialize_into: no room for the header");
+    }
 
-    string ret;
-    ret.reserve(4 * hlen);
-
+    uint8_t *p = out;
     const uint8_t first_byte = (ver << 4) | (hlen & 0xf);
-    NetUnparser::u8(ret, first_byte);  // version and header length
-    NetUnparser::u8(ret, tos);         // type of service
-    NetUnparser::u16(ret, len);        // length
-    NetUnparser::u16(ret, id);         // id
+    p = NetUnparser::u8(p, first_byte);  // version and header length
+    p = NetUnparser::u8(p, tos);         // type of service
+    p = NetUnparser::u16(p, len);        // length
+    p = NetUnparser::u16(p, id);         // id
 
     const uint16_t fo_val = (df ? 0x4000 : 0) | (mf ? 0x2000 : 0) | (offset & 0x1fff);
-    NetUnparser::u16(ret, fo_val);  // flags and offset
+    p = NetUnparser::u16(p, fo_val);  // flags and offset
 
-    NetUnparser::u8(ret, ttl);    // time to live
-    NetUnparser::u8(ret, proto);  // protocol number
+    p = NetUnparser::u8(p, ttl);    // time to live
+    p = NetUnparser::u8(p, proto);  // protocol number
 
-    NetUnparser::u16(ret, cksum);  // checksum
+    p = NetUnparser::u16(p, cksum);  // checksum
 
-    NetUnparser::u32(ret, src);  // src address
-    NetUnparser::u32(ret, dst);  // dst address
+    p = NetUnparser::u32(p, src);  // src address
+    p = NetUnparser::u32(p, dst);  // dst address
 
-    ret.resize(4 * hlen);  // expand header to advertised size
+    fill(p, out + 4 * hlen, 0);  // expand header to advertised size
 
-    return ret;
+    return 4 * hlen;
 }
 
 uint16_t IPv4Header::payload_length() const { return len - 4 * hlen; }
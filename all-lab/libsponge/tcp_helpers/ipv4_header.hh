@@ -9,6 +9,7 @@ struct IPv4Header {
     static constexpr size_t LENGTH = 20;         //!< [IPv4](\ref rfc::rfc791) header length, not including options
     static constexpr uint8_t DEFAULT_TTL = 128;  //!< A reasonable default TTL value
     static constexpr uint8_t PROTO_TCP = 6;      //!< Protocol number for [tcp](\ref rfc::rfc793)
+    static constexpr size_t CKSUM_OFFSET = 10;   //!< Byte offset of the checksum field in a serialized header
 
     //! \struct IPv4Header
     //! ~~~{.txt}
@@ -52,6 +53,10 @@ struct IPv4Header {
     //! Serialize the IP fields
     std::string serialize() const;
 
+    //! \brief Serialize the IP fields into a caller's buffer, which must have room for `4 * hlen` bytes
+    //! \returns the number of bytes written, `4 * hlen` (the checksum is written as it is, not recomputed)
+    size_t serialize_into(uint8_t *out, const size_t size) const;
+
     //! Length of the payload
     uint16_t payload_length() const;
 
@@ -2,6 +2,7 @@
 #define SPONGE_LIBSPONGE_LOSSY_FD_ADAPTER_HH
 
 #include "file_descriptor.hh"
+#include "four_tuple.hh"
 #include "tcp_config.hh"
 #include "tcp_segment.hh"
 #include "util.hh"
@@ -56,6 +57,24 @@ class LossyFdAdapter {
         return _adapter.write(seg);
     }
 
+    //! \brief Read a segment for any connection from the underlying AdapterT instance, potentially dropping it
+    //! \param[out] tuple is set to the connection the segment belongs to
+    std::optional<TCPSegment> read_any(FourTuple &tuple) {
+        auto ret = _adapter.read_any(tuple);
+        if (_should_drop(false)) {
+            return {};
+        }
+        return ret;
+    }
+
+    //! \brief Write a segment on the connection `tuple` to the underlying AdapterT instance, or drop it
+    void write_to(TCPSegment &seg, const FourTuple &tuple) {
+        if (_should_drop(true)) {
+            return;
+        }
+        _adapter.write_to(seg, tuple);
+    }
+
     //! \name
     //! Passthrough functions to the underlying AdapterT instance
 
@@ -63,9 +82,17 @@ class LossyFdAdapter {
     void set_listening(const bool l) { _adapter.set_listening(l); }      //!< FdAdapterBase::set_listening passthrough
     const FdAdapterConfig &config() const { return _adapter.config(); }  //!< FdAdapterBase::config passthrough
     FdAdapterConfig &config_mut() { return _adapter.config_mut(); }      //!< FdAdapterBase::config_mut passthrough
+    size_t mss() const { return _adapter.mss(); }                        //!< AdapterT::mss passthrough
     void tick(const size_t ms_since_last_tick) {
         _adapter.tick(ms_since_last_tick);
     }  //!< FdAdapterBase::tick passthrough
+    std::optional<uint64_t> ms_until_next_timer() const {
+        return _adapter.ms_until_next_timer();
+    }  //!< FdAdapterBase::ms_until_next_timer passthrough
+    bool has_buffered_input() const {
+        return _adapter.has_buffered_input();
+    }                                   //!< FdAdapterBase::has_buffered_input passthrough
+    void flush() { _adapter.flush(); }  //!< FdAdapterBase::flush passthrough
     //!@}
 };
 
@@ -12,14 +12,44 @@
 class TCPConfig {
   public:
     static constexpr size_t DEFAULT_CAPACITY = 64000;  //!< Default capacity
-    static constexpr size_t MAX_PAYLOAD_SIZE = 1000;   //!< Conservative max payload size for real Internet
+    static constexpr size_t MAX_PAYLOAD_SIZE = 1000;   //!< Conservative max payload size (the default MSS)
     static constexpr uint16_t TIMEOUT_DFLT = 1000;     //!< Default re-transmit timeout is 1 second
     static constexpr unsigned MAX_RETX_ATTEMPTS = 8;   //!< Maximum re-transmit attempts before giving up
+    static constexpr unsigned DUP_ACK_THRESHOLD = 3;   //!< Duplicate ACKs that trigger a fast retransmit
+    static constexpr uint16_t RTO_MIN_DFLT = 200;      //!< Default lower bound of the adaptive RTO, in milliseconds
+    static constexpr uint32_t RTO_MAX_DFLT = 60000;    //!< Default upper bound of the adaptive RTO, in milliseconds
+    static constexpr uint16_t DELAYED_ACK_DFLT = 40;   //!< Typical delayed_ack, in milliseconds (it is off by default)
+    static constexpr uint16_t CORK_TIMEOUT_DFLT = 200;  //!< Default cork_timeout, in milliseconds (as TCP_CORK)
+
+    //! Congestion control algorithm run by the TCPSender
+    enum class CongestionControl {
+        None,     //!< no congestion window; only the receiver's window limits the sender
+        Reno,     //!< slow start + AIMD congestion avoidance + fast recovery (RFC 5681)
+        NewReno,  //!< Reno that stays in fast recovery across partial ACKs (RFC 6582)
+        Cubic     //!< slow start + CUBIC congestion avoidance (RFC 9438) + NewReno fast recovery
+    };
 
     uint16_t rt_timeout = TIMEOUT_DFLT;       //!< Initial value of the retransmission timeout, in milliseconds
     size_t recv_capacity = DEFAULT_CAPACITY;  //!< Receive capacity, in bytes
     size_t send_capacity = DEFAULT_CAPACITY;  //!< Sender capacity, in bytes
     std::optional<WrappingInt32> fixed_isn{};
+    //! Largest payload per segment, also offered to the peer as our MSS option. When unset, TCPSpongeSocket
+    //! derives it from its adapter's MTU, and a bare TCPConnection uses MAX_PAYLOAD_SIZE.
+    std::optional<size_t> mss{};
+    CongestionControl congestion_control = CongestionControl::None;  //!< Congestion control algorithm
+    bool adaptive_rto = false;        //!< Derive the RTO from measured RTTs (RFC 6298) instead of from rt_timeout
+    uint16_t rto_min = RTO_MIN_DFLT;  //!< Lower bound of the adaptive RTO, in milliseconds
+    uint32_t rto_max = RTO_MAX_DFLT;  //!< Upper bound of the adaptive RTO (including backoff), in milliseconds
+    bool sack = false;                //!< Offer (and, if the peer agrees, use) selective acknowledgments (RFC 2018)
+    bool window_scaling = false;      //!< Offer window scaling, so windows above 64 KiB can be used (RFC 7323)
+    bool timestamps = false;          //!< Offer timestamps, which give an RTT sample on every ACK (RFC 7323)
+    //! Hold the ACK for in-order data up to this many milliseconds, acknowledging at least every second
+    //! segment (RFC 1122, 4.2.3.2); 0 acknowledges every segment at once
+    uint16_t delayed_ack = 0;
+    bool nagle = false;  //!< Hold back a partial segment while earlier data is unacknowledged (RFC 896)
+    //! Longest a partial segment is held back (by nagle or TCPSender::cork()) before it is sent anyway
+    uint16_t cork_timeout = CORK_TIMEOUT_DFLT;
+    bool pacing = false;  //!< Spread segments across the RTT instead of sending the whole window at once
 };
 
 //! Config for classes derived from FdAdapter
@@ -0,0 +1,488 @@
+#include "tcp_engine.hh"
+
+#include "util.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <exception>
+#include <iostream>
+#include <pthread.h>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+
+using namespace std;
+
+//! \returns a pair of connected AF_UNIX stream sockets
+static pair<LocalStreamSocket, LocalStreamSocket> local_socket_pair() {
+    int fds[2];
+    SystemCall("socketpair", ::socketpair(AF_UNIX, SOCK_STREAM, 0, static_cast<int *>(fds)));
+    return {LocalStreamSocket(FileDescriptor(fds[0])), LocalStreamSocket(FileDescriptor(fds[1]))};
+}
+
+//! \returns whether `state` is still part of the handshake
+static bool handshaking(const TCPState &state) {
+    return state == TCPState::State::LISTEN or state == TCPState::State::SYN_RCVD or
+           state == TCPState::State::SYN_SENT;
+}
+
+//! Keep SIGPIPE from the calling thread: a write to a data socket whose owner has closed it should fail
+//! with EPIPE, not kill the process
+static void block_sigpipe() {
+    sigset_t sigpipe;
+    sigemptyset(&sigpipe);
+    sigaddset(&sigpipe, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigpipe, nullptr);
+}
+
+template <typename AdaptT>
+TCPEngine<AdaptT>::Doorbell::Doorbell() : sockets(local_socket_pair()) {}
+
+template <typename AdaptT>
+void TCPEngine<AdaptT>::Doorbell::ring() {
+    if (not rung.exchange(true)) {
+        sockets.first.write("!");
+    }
+}
+
+template <typename AdaptT>
+void TCPEngine<AdaptT>::Doorbell::answer() {
+    sockets.second.read();
+    // an exchange, not a store: it reads the ring()er's `true`, which orders whatever it queued before this
+    rung.exchange(false);
+}
+
+template <typename AdaptT>
+TCPEngine<AdaptT>::TCPEngine(AdaptT &&adapter,
+                             const TCPConfig &c_tcp,
+                             const FdAdapterConfig &c_ad,
+                             const size_t workers)
+    : _adapter(move(adapter)), _tcp_config(c_tcp), _accept_ready(local_socket_pair()) {
+    if (workers == 0) {
+        throw runtime_error("TCPEngine needs at least one worker");
+    }
+    _adapter.config_mut() = c_ad;
+    if (not _tcp_config.mss.has_value()) {
+        _tcp_config.mss = _adapter.mss();
+    }
+
+    for (size_t i = 0; i < workers; i++) {
+        _workers.push_back(make_unique<Worker>());
+        Worker &worker = *_workers.back();
+
+        // requests from the owner, and (sharded) segments from the I/O thread
+        worker.eventloop.add_rule(worker.doorbell.sockets.second, Direction::In, [this, &worker] {
+            worker.doorbell.answer();
+            deque<function<void()>> commands;
+            {
+                lock_guard<mutex> lock(worker.mutex);
+                commands.swap(worker.commands);
+            }
+            for (auto &command : commands) {
+                command();
+            }
+            while (auto packet = worker.inbound.pop()) {
+                _segment_received(worker, packet->first, packet->second);
+            }
+        });
+    }
+
+    if (not _sharded()) {
+        // inbound segments, for every connection
+        Worker &worker = *_workers.front();
+        worker.eventloop.add_rule(_adapter, Direction::In, [this, &worker] {
+            // the adapter may have read a batch of datagrams; take them all, since the fd will not report them again
+            do {
+                FourTuple tuple;
+                auto seg = _adapter.read_any(tuple);
+                if (seg) {
+                    _segment_received(worker, tuple, seg.value());
+                }
+            } while (_adapter.has_buffered_input());
+        });
+    } else {
+        _io_eventloop.add_rule(_adapter, Direction::In, [&] { _dispatch(); });
+
+        // segments the workers have sent
+        _io_eventloop.add_rule(_io_doorbell.sockets.second, Direction::In, [&] {
+            _io_doorbell.answer();
+            for (auto &worker : _workers) {
+                while (auto packet = worker->outbound.pop()) {
+                    _adapter.write_to(packet->second, packet->first);
+                }
+            }
+        });
+        _io_thread = thread(&TCPEngine::_io_main, this);
+    }
+
+    for (auto &worker : _workers) {
+        worker->thread = thread(&TCPEngine::_worker_main, this, ref(*worker));
+    }
+}
+
+template <typename AdaptT>
+TCPEngine<AdaptT>::~TCPEngine() {
+    try {
+        _abort.store(true);
+        size_t open = 0;
+        for (auto &worker : _workers) {
+            worker->doorbell.ring();
+            worker->thread.join();
+            open += worker->connections.size();
+        }
+        if (_io_thread.joinable()) {
+            _io_doorbell.ring();
+            _io_thread.join();
+        }
+        if (open > 0) {
+            cerr << "Warning: TCPEngine destroyed with " << open << " connection(s) still open\n";
+        }
+    } catch (const exception &e) {
+        cerr << "Exception destructing TCPEngine: " << e.what() << endl;
+    }
+}
+
+//! \param[in] worker is the worker to run `command`
+//! \param[in] command is run on the worker's thread, after any commands queued before it
+template <typename AdaptT>
+void TCPEngine<AdaptT>::_run_in_worker(Worker &worker, function<void()> &&command) {
+    {
+        lock_guard<mutex> lock(worker.mutex);
+        worker.commands.push_back(move(command));
+    }
+    worker.doorbell.ring();
+}
+
+template <typename AdaptT>
+void TCPEngine<AdaptT>::_worker_main(Worker &worker) {
+    try {
+        block_sigpipe();
+        // an unsharded worker is the whole engine, so its Buffers never meet another thread; sharded ones hand
+        // payloads to and from the I/O thread, and keep atomic counts
+        optional<BufferStorage::ThreadConfined> confined;
+        if (not _sharded()) {
+            confined.emplace();
+        }
+        while (not _abort.load()) {
+            // the doorbell rule is always interested, so the loop only sleeps until an fd or a timer needs it
+            worker.eventloop.wait_next_event(-1);
+            if (not _sharded()) {
+                _adapter.flush();
+            } else if (worker.sent) {
+                worker.sent = false;
+                _io_doorbell.ring();
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception in TCPEngine worker thread: " << e.what() << "\n";
+        throw;
+    }
+}
+
+template <typename AdaptT>
+void TCPEngine<AdaptT>::_io_main() {
+    try {
+        while (not _abort.load()) {
+            _io_eventloop.wait_next_event(-1);
+            _adapter.flush();
+        }
+    } catch (const exception &e) {
+        cerr << "Exception in TCPEngine I/O thread: " << e.what() << "\n";
+        throw;
+    }
+}
+
+template <typename AdaptT>
+void TCPEngine<AdaptT>::_dispatch() {
+    // wake each worker once for everything it was given, rather than once per segment
+    vector<bool> given(_workers.size(), false);
+    do {
+        FourTuple tuple;
+        auto seg = _adapter.read_any(tuple);
+        if (not seg) {
+            continue;
+        }
+        const size_t index = hash<FourTuple>{}(tuple) % _workers.size();
+        // a worker whose ring is full is too far behind to take more; TCP will retransmit what it drops
+        given[index] = _workers[index]->inbound.push({tuple, move(seg.value())}) or given[index];
+    } while (_adapter.has_buffered_input());
+
+    for (size_t i = 0; i < _workers.size(); i++) {
+        if (given[i]) {
+            _workers[i]->doorbell.ring();
+        }
+    }
+}
+
+//! \param[in] worker is the worker that owns `tuple`
+//! \param[in] tuple is the connection the segment belongs to, as the adapter reported it
+//! \param[in] seg is the segment
+template <typename AdaptT>
+void TCPEngine<AdaptT>::_segment_received(Worker &worker, const FourTuple &tuple, const TCPSegment &seg) {
+    if (const auto it = worker.connections.find(tuple); it != worker.connections.end()) {
+        const shared_ptr<Connection> conn = it->second;  // a copy: _service() may take it out of the table
+        _tick(*conn);
+        conn->tcp.segment_received(seg);
+        _service(worker, conn);
+        return;
+    }
+
+    // anything but a SYN to the listening address is for a connection that no longer exists (or never did)
+    const TCPHeader &header = seg.header();
+    if (not worker.listener.has_value() or not header.syn or header.ack or header.rst) {
+        return;
+    }
+    const FourTuple &local = worker.listener->local;
+    if (tuple.local_port != local.local_port or (local.local_ip != 0 and tuple.local_ip != local.local_ip)) {
+        return;
+    }
+    {
+        lock_guard<mutex> lock(_mutex);
+        if (_handshaking + _accept_queue.size() >= worker.listener->backlog) {
+            return;  // as with a full SYN queue, the peer will try again
+        }
+        _handshaking++;
+    }
+
+    auto sockets = local_socket_pair();
+    const auto conn = _add_connection(worker, tuple, move(sockets.first));
+    conn->owner_end.emplace(move(sockets.second));
+    conn->tcp.segment_received(seg);
+    _service(worker, conn);
+}
+
+//! \param[in] worker is the worker that owns `tuple`
+//! \param[in] tuple is the new connection's FourTuple
+//! \param[in] data is the engine's end of the socket that carries the connection's bytes to and from the owner
+template <typename AdaptT>
+shared_ptr<typename TCPEngine<AdaptT>::Connection> TCPEngine<AdaptT>::_add_connection(Worker &worker,
+                                                                                      const FourTuple &tuple,
+                                                                                      LocalStreamSocket &&data) {
+    // one thread serves every connection of the worker, so it must never block on one owner
+    data.set_blocking(false);
+    const auto conn = make_shared<Connection>(tuple, _tcp_config, move(data), timestamp_ms());
+    worker.connections.emplace(tuple, conn);
+
+    // The rules (and the connection's timer) hold the connection, so it outlives its place in the table
+    // until _retire() closes its data socket, which cancels them.
+
+    // bytes from the owner into the outbound stream
+    worker.eventloop.add_rule(
+        conn->data,
+        Direction::In,
+        [this, &worker, conn] {
+            _tick(*conn);
+            auto bytes = conn->data.read(conn->tcp.remaining_outbound_capacity());
+            const auto len = bytes.size();
+            if (conn->tcp.write(Buffer(move(bytes))) != len) {
+                throw runtime_error("TCPConnection::write() accepted less than advertised length");
+            }
+            if (conn->data.eof()) {
+                conn->tcp.end_input_stream();
+                conn->outbound_shutdown = true;
+            }
+            _service(worker, conn);
+        },
+        [conn] {
+            return conn->tcp.active() and not conn->outbound_shutdown and
+                   conn->tcp.remaining_outbound_capacity() > 0;
+        },
+        [this, &worker, conn] {
+            // (a retired connection's rules are canceled by closing its data socket; there is nothing to do then)
+            if (not conn->data.closed() and conn->tcp.active() and not conn->outbound_shutdown) {
+                conn->tcp.end_input_stream();
+                conn->outbound_shutdown = true;
+                _service(worker, conn);
+            }
+        });
+
+    // bytes from the inbound stream to the owner
+    worker.eventloop.add_rule(
+        conn->data,
+        Direction::Out,
+        [this, &worker, conn] {
+            ByteStream &inbound = conn->tcp.inbound_stream();
+            const size_t amount_to_write = min(size_t(65536), inbound.buffer_size());
+            try {
+                inbound.pop_output(conn->data.write(inbound.peek_output_views(amount_to_write), false));
+            } catch (const unix_error &e) {
+                if (e.code().value() == EAGAIN) {
+                    return;
+                }
+                if (e.code().value() != EPIPE) {
+                    throw;
+                }
+                // the owner has closed its end, so nobody will read the rest
+                inbound.pop_output(inbound.buffer_size());
+                conn->inbound_shutdown = true;
+            }
+
+            if ((inbound.eof() or inbound.error()) and not conn->inbound_shutdown) {
+                conn->data.shutdown(SHUT_WR);
+                conn->inbound_shutdown = true;
+            }
+            _tick(*conn);
+            _service(worker, conn);
+        },
+        [conn] {
+            const ByteStream &inbound = conn->tcp.inbound_stream();
+            return (not inbound.buffer_empty()) or
+                   ((inbound.eof() or inbound.error()) and not conn->inbound_shutdown);
+        });
+
+    return conn;
+}
+
+template <typename AdaptT>
+void TCPEngine<AdaptT>::_tick(Connection &conn) {
+    const uint64_t now = timestamp_ms();
+    conn.tcp.tick(now - conn.last_tick_ms);
+    conn.last_tick_ms = now;
+}
+
+template <typename AdaptT>
+void TCPEngine<AdaptT>::_retire(Worker &worker, const shared_ptr<Connection> &conn) {
+    if (conn->timer.has_value()) {
+        worker.eventloop.timers().cancel(conn->timer.value());
+        conn->timer.reset();
+    }
+    conn->data.close();
+    worker.connections.erase(conn->tuple);
+}
+
+//! \param[in] conn is a connection that may have changed: received a segment, been written to, or ticked
+template <typename AdaptT>
+void TCPEngine<AdaptT>::_service(Worker &worker, const shared_ptr<Connection> &conn) {
+    TCPConnection &tcp = conn->tcp;
+    while (not tcp.segments_out().empty()) {
+        if (not _sharded()) {
+            _adapter.write_to(tcp.segments_out().front(), conn->tuple);
+        } else {
+            Packet packet{conn->tuple, move(tcp.segments_out().front())};
+            // the I/O thread never waits for a worker, so a full ring always drains -- unless the engine is being
+            // destroyed, and the I/O thread may have exited already; then the segment is dropped
+            while (not worker.outbound.push(move(packet))) {
+                if (_abort.load()) {
+                    break;
+                }
+                _io_doorbell.ring();
+                this_thread::yield();
+            }
+            worker.sent = true;
+        }
+        tcp.segments_out().pop();
+    }
+
+    // hand the connection to the owner once it is established, or report that it failed
+    bool failed = false;
+    if (not conn->handed_over and not (tcp.active() and handshaking(tcp.state()))) {
+        conn->handed_over = true;
+        failed = not tcp.active();
+        if (conn->connected.has_value()) {
+            if (tcp.active()) {
+                conn->connected->set_value();
+            } else {
+                conn->connected->set_exception(
+                    make_exception_ptr(runtime_error("TCPEngine: could not connect " + conn->tuple.to_string())));
+            }
+        } else {
+            {
+                lock_guard<mutex> lock(_mutex);
+                _handshaking--;
+                if (tcp.active()) {
+                    _accept_queue.emplace_back(move(conn->owner_end.value()), conn->tuple);
+                }
+            }
+            if (tcp.active()) {
+                _accept_ready.first.write("!");
+            }
+        }
+        conn->owner_end.reset();
+    }
+
+    // a connection is done with if its handshake failed, if it never got past LISTEN (the SYN was
+    // refused), or once it has finished and passed on every inbound byte
+    const bool refused = tcp.state() == TCPState::State::LISTEN;
+    if (failed or refused or (not tcp.active() and conn->inbound_shutdown)) {
+        if (refused) {
+            lock_guard<mutex> lock(_mutex);
+            _handshaking--;
+        }
+        _retire(worker, conn);
+        return;
+    }
+
+    TimerWheel &timers = worker.eventloop.timers();
+    if (conn->timer.has_value()) {
+        timers.cancel(conn->timer.value());
+        conn->timer.reset();
+    }
+    if (const auto next = tcp.ms_until_next_timer(); next.has_value()) {
+        // deadlines count from the last tick, which is where the connection's clocks stand
+        conn->timer = timers.schedule(conn->last_tick_ms + next.value(), [this, &worker, conn] {
+            conn->timer.reset();
+            _tick(*conn);
+            _service(worker, conn);
+        });
+    }
+}
+
+//! \param[in] local is the address (and port) to accept connections on
+//! \param[in] backlog is the most connections that may wait for accept(), counted from their SYN
+template <typename AdaptT>
+void TCPEngine<AdaptT>::listen(const Address &local, const size_t backlog) {
+    const FourTuple tuple = FourTuple::from_addresses(local, local);
+    for (auto &worker : _workers) {
+        Worker *const w = worker.get();
+        _run_in_worker(*w, [w, tuple, backlog] { w->listener = Listener{tuple, backlog}; });
+    }
+}
+
+template <typename AdaptT>
+pair<LocalStreamSocket, FourTuple> TCPEngine<AdaptT>::accept() {
+    // one byte per connection queued; blocks until there is one
+    _accept_ready.second.read(1);
+    lock_guard<mutex> lock(_mutex);
+    auto accepted = move(_accept_queue.front());
+    _accept_queue.pop_front();
+    return accepted;
+}
+
+//! \param[in] c_ad holds the connection's local address (source) and the address to connect to (destination)
+template <typename AdaptT>
+LocalStreamSocket TCPEngine<AdaptT>::connect(const FdAdapterConfig &c_ad) {
+    const FourTuple tuple = FourTuple::from_addresses(c_ad.source, c_ad.destination);
+    auto sockets = local_socket_pair();
+
+    // std::function needs a copyable callable, so the engine's socket and the promise travel by shared_ptr
+    auto request = make_shared<pair<LocalStreamSocket, promise<void>>>(move(sockets.first), promise<void>{});
+    auto established = request->second.get_future();
+    Worker &worker = _worker_for(tuple);
+    _run_in_worker(worker, [this, &worker, tuple, request] {
+        if (worker.connections.count(tuple) != 0) {
+            request->second.set_exception(
+                make_exception_ptr(runtime_error("TCPEngine: " + tuple.to_string() + " is already in use")));
+            return;
+        }
+        const auto conn = _add_connection(worker, tuple, move(request->first));
+        conn->connected.emplace(move(request->second));
+        conn->tcp.connect();
+        _service(worker, conn);
+    });
+
+    established.get();  // rethrows a failure to connect
+    return move(sockets.second);
+}
+
+//! Specialization of TCPEngine for TCPOverUDPSocketAdapter
+template class TCPEngine<TCPOverUDPSocketAdapter>;
+
+//! Specialization of TCPEngine for TCPOverIPv4OverTunFdAdapter
+template class TCPEngine<TCPOverIPv4OverTunFdAdapter>;
+
+//! Specialization of TCPEngine for LossyTCPOverUDPSocketAdapter
+template class TCPEngine<LossyTCPOverUDPSocketAdapter>;
+
+//! Specialization of TCPEngine for LossyTCPOverIPv4OverTunFdAdapter
+template class TCPEngine<LossyTCPOverIPv4OverTunFdAdapter>;
@@ -0,0 +1,224 @@
+#ifndef SPONGE_LIBSPONGE_TCP_ENGINE_HH
+#define SPONGE_LIBSPONGE_TCP_ENGINE_HH
+
+#include "eventloop.hh"
+#include "fd_adapter.hh"
+#include "file_descriptor.hh"
+#include "four_tuple.hh"
+#include "socket.hh"
+#include "spsc_ring.hh"
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "timer_wheel.hh"
+#include "tuntap_adapter.hh"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//! \brief Many TCPConnections over one datagram adapter, run by one thread or sharded over several
+template <typename AdaptT>
+class TCPEngine {
+  private:
+    //! One connection, and the engine's end of the stream socket that carries its bytes to and from the owner
+    struct Connection {
+        FourTuple tuple;
+        TCPConnection tcp;
+        LocalStreamSocket data;
+        uint64_t last_tick_ms;                          //!< timestamp_ms() up to which `tcp` has been ticked
+        std::optional<TimerWheel::TimerId> timer{};     //!< wakes the engine for `tcp`'s next deadline
+        bool handed_over{false};                        //!< has the owner been given the other end of `data`?
+        std::optional<LocalStreamSocket> owner_end{};   //!< (listened) the other end of `data`, until accept()
+        std::optional<std::promise<void>> connected{};  //!< (connect()ed) fulfilled once established
+        bool inbound_shutdown{false};                   //!< has the inbound stream been passed on in full?
+        bool outbound_shutdown{false};                  //!< has the owner finished writing?
+
+        Connection(const FourTuple &t, const TCPConfig &cfg, LocalStreamSocket &&socket, const uint64_t now)
+            : tuple(t), tcp(cfg), data(std::move(socket)), last_tick_ms(now) {}
+    };
+
+    //! A listen() in force: SYNs to `local` start connections, up to `backlog` of them not yet accept()ed
+    struct Listener {
+        FourTuple local;  //!< only the local half is used; a local_ip of 0 matches any address
+        size_t backlog;
+    };
+
+    //! A segment passed between the I/O thread and a worker, with the connection it belongs to
+    using Packet = std::pair<FourTuple, TCPSegment>;
+
+    //! Slots in each worker's inbound and outbound rings
+    static constexpr size_t RING_SIZE = 4096;
+
+    //! \brief Wakes a thread that sleeps in an EventLoop, with a system call only if it has not been woken already
+    //! \details ring() writes a byte to `sockets.first` unless an earlier one is still unanswered. The woken
+    //! thread calls answer(), which reads `sockets.second`, before it looks for work, so no ring() goes unseen.
+    struct Doorbell {
+        std::pair<LocalStreamSocket, LocalStreamSocket> sockets;
+        std::atomic_bool rung{false};
+
+        Doorbell();
+        void ring();
+        void answer();
+    };
+
+    //! One worker thread, with its own EventLoop (and so its own timers) and the connections hashed to it
+    struct Worker {
+        EventLoop eventloop{EventLoop::Backend::Epoll};
+        std::unordered_map<FourTuple, std::shared_ptr<Connection>> connections{};
+        std::optional<Listener> listener{};
+
+        std::mutex mutex{};                            //!< guards `commands`
+        std::deque<std::function<void()>> commands{};  //!< run by the worker, in order
+        Doorbell doorbell{};                           //!< rung for `commands`, `inbound`, and on abort
+
+        //! \name Rings to and from the I/O thread (only when there is more than one worker)
+        //!@{
+        SPSCRing<Packet> inbound{RING_SIZE};   //!< segments the I/O thread has read for this worker
+        SPSCRing<Packet> outbound{RING_SIZE};  //!< segments for the I/O thread to write
+        bool sent{false};                      //!< pushed to `outbound` since the I/O thread was last rung?
+        //!@}
+
+        std::thread thread{};
+    };
+
+    AdaptT _adapter;        //!< the datagram adapter every connection shares
+    TCPConfig _tcp_config;  //!< configuration of every connection
+
+    //! The workers; with only one, it also reads and writes the adapter itself, and there is no I/O thread
+    std::vector<std::unique_ptr<Worker>> _workers{};
+
+    //! \name I/O thread state (only when there is more than one worker)
+    //!@{
+    EventLoop _io_eventloop{EventLoop::Backend::Epoll};
+    Doorbell _io_doorbell{};  //!< rung by workers with segments in their `outbound` ring, and on abort
+    std::thread _io_thread{};
+    //!@}
+
+    //! \name Shared between the owner and the workers
+    //!@{
+    std::mutex _mutex{};
+    size_t _handshaking{0};  //!< connections started by a listener that are not yet established
+    //! accepted connections waiting for accept(), with the owner's end of each data socket
+    std::deque<std::pair<LocalStreamSocket, FourTuple>> _accept_queue{};
+    std::atomic_bool _abort{false};
+    //!@}
+
+    //! The engine writes a byte to `first` per connection it puts in `_accept_queue`; accept() reads `second`
+    std::pair<LocalStreamSocket, LocalStreamSocket> _accept_ready;
+
+    //! Whether the adapter is served by an I/O thread of its own, which passes segments to and from the workers
+    bool _sharded() const { return _workers.size() > 1; }
+
+    //! The worker that owns the connection `tuple` names
+    Worker &_worker_for(const FourTuple &tuple) {
+        return *_workers[std::hash<FourTuple>{}(tuple) % _workers.size()];
+    }
+
+    //! Queue `command` for a worker thread and wake it
+    void _run_in_worker(Worker &worker, std::function<void()> &&command);
+
+    //! Body of each worker thread
+    void _worker_main(Worker &worker);
+
+    //! Body of the I/O thread
+    void _io_main();
+
+    //! (I/O thread) Read what the adapter has, and pass each segment to the worker that owns its connection
+    void _dispatch();
+
+    //! Demultiplex one inbound segment to its connection, starting one if it is a SYN for the listener
+    void _segment_received(Worker &worker, const FourTuple &tuple, const TCPSegment &seg);
+
+    //! Make a connection for `tuple`, with event loop rules that move its bytes to and from the owner
+    std::shared_ptr<Connection> _add_connection(Worker &worker, const FourTuple &tuple, LocalStreamSocket &&data);
+
+    //! Tick a connection up to the current time
+    void _tick(Connection &conn);
+
+    //! Send a connection's segments, hand it over once established, re-arm its timer, and retire it when done
+    void _service(Worker &worker, const std::shared_ptr<Connection> &conn);
+
+    //! Take a connection out of the table, and close its data socket, which cancels its rules
+    void _retire(Worker &worker, const std::shared_ptr<Connection> &conn);
+
+  public:
+    //! \param[in] adapter the datagram adapter every connection will share
+    //! \param[in] c_tcp the configuration of every connection
+    //! \param[in] c_ad the adapter configuration; its addresses are only used by adapters that have a
+    //!                 single local address (TCPOverUDPSocketAdapter), since each connection has its own
+    //! \param[in] workers the number of worker threads to spread the connections over
+    TCPEngine(AdaptT &&adapter, const TCPConfig &c_tcp, const FdAdapterConfig &c_ad = {}, const size_t workers = 1);
+
+    //! Stops the engine's threads; connections still open are abandoned (their peers will time out)
+    ~TCPEngine();
+
+    //! \brief Start accepting connections to `local` (with INADDR_ANY matching every local address)
+    //! \param[in] backlog most connections, from SYN onwards, that may wait for accept() before SYNs are ignored
+    void listen(const Address &local, const size_t backlog = 128);
+
+    //! \brief Wait for a connection to the listen()ing address to be established, and take it over
+    //! \returns the owner's end of the connection's data socket, and the connection's addresses
+    std::pair<LocalStreamSocket, FourTuple> accept();
+
+    //! \brief Connect from `c_ad.source` to `c_ad.destination`; blocks until established
+    //! \returns the owner's end of the connection's data socket
+    LocalStreamSocket connect(const FdAdapterConfig &c_ad);
+
+    //! Readable whenever accept() would not block, so that an EventLoop can wait for connections
+    const FileDescriptor &accept_fd() const { return _accept_ready.second; }
+
+    //! \name
+    //! The engine's threads refer to the engine, so it cannot be moved or copied
+
+    //!@{
+    TCPEngine(const TCPEngine &) = delete;
+    TCPEngine(TCPEngine &&) = delete;
+    TCPEngine &operator=(const TCPEngine &) = delete;
+    TCPEngine &operator=(TCPEngine &&) = delete;
+    //!@}
+};
+
+using TCPOverUDPEngine = TCPEngine<TCPOverUDPSocketAdapter>;
+using TCPOverIPv4Engine = TCPEngine<TCPOverIPv4OverTunFdAdapter>;
+
+using LossyTCPOverUDPEngine = TCPEngine<LossyTCPOverUDPSocketAdapter>;
+using LossyTCPOverIPv4Engine = TCPEngine<LossyTCPOverIPv4OverTunFdAdapter>;
+
+//! \class TCPEngine
+//! Where a TCPSpongeSocket runs one TCPConnection on a thread of its own, a TCPEngine keeps a table of
+//! connections, keyed by FourTuple, and (by default) runs all of them from one EventLoop on one thread:
+//!
+//! - each segment the adapter reads is handed to the connection its FourTuple names. A SYN that
+//!   names no connection starts a new one, if it is addressed to the listen()ing address and fewer
+//!   than `backlog` connections are waiting for accept(); anything else is dropped.
+//! - segments a connection sends are written through the same adapter, addressed by its FourTuple.
+//! - each connection's retransmission and other timers are kept in the EventLoop's TimerWheel, so
+//!   an idle connection costs nothing until one of its deadlines comes due.
+//! - as with TCPSpongeSocket, the owner sees each connection as a LocalStreamSocket (accept() and
+//!   connect() return them), and the engine moves bytes between that socket and the TCPConnection.
+//!
+//! With more than one worker, connections are spread over the workers by the hash of their FourTuple,
+//! as receive-side scaling spreads flows over a NIC's queues. Each worker owns its connections outright:
+//! its own table, EventLoop and timers, so that nothing a connection touches is shared. An I/O thread
+//! reads the adapter and passes each segment to its connection's worker through a lock-free
+//! single-producer, single-consumer ring (SPSCRing); each worker passes the segments it sends back to
+//! the I/O thread through a second ring. A thread is woken (with a byte on a socket) only if it has not
+//! already been, so a busy worker is handed a whole batch for one wakeup. If a worker falls so far behind
+//! that its inbound ring fills, further segments for it are dropped, as a NIC drops on a full queue, and
+//! left to TCP to retransmit. Only the handshake (the backlog and accept queue) takes a lock.
+//!
+//! A connection leaves the table once it has finished (including any linger in TIME_WAIT) and its
+//! inbound bytes have all been passed to the owner. The owner may close its socket at any time;
+//! that ends the outbound stream, as shutdown(SHUT_WR) would.
+
+#endif  // SPONGE_LIBSPONGE_TCP_ENGINE_HH
@@ -1,9 +1,62 @@
 #include "tcp_header.hh"
 
+#include <algorithm>
+#include <array>
 #include <sstream>
+#include <stdexcept>
 
 using namespace std;
 
+//! Encode the options carried by `header` at `out`, padded to a multiple of four bytes
+//! \param[in] room how many bytes the options may take; options (or SACK blocks) that do not fit are left out
+//! \returns the number of bytes written
+static size_t serialize_options(const TCPHeader &header, uint8_t *const out, const size_t room) {
+    uint8_t *p = out;
+    const auto used = [&] { return static_cast<size_t>(p - out); };
+    // each option is preceded by NOPs so that it ends on a 32-bit boundary
+    if (header.mss.has_value() && used() + 4 <= room) {
+        p = NetUnparser::u8(p, TCPHeader::OPT_MSS);
+        p = NetUnparser::u8(p, 4);
+        p = NetUnparser::u16(p, header.mss.value());
+    }
+    if (header.window_scale.has_value() && used() + 4 <= room) {
+        p = NetUnparser::u8(p, TCPHeader::OPT_NOP);
+        p = NetUnparser::u8(p, TCPHeader::OPT_WINDOW_SCALE);
+        p = NetUnparser::u8(p, 3);
+        p = NetUnparser::u8(p, header.window_scale.value());
+    }
+    if (header.sack_permitted && used() + 4 <= room) {
+        p = NetUnparser::u8(p, TCPHeader::OPT_NOP);
+        p = NetUnparser::u8(p, TCPHeader::OPT_NOP);
+        p = NetUnparser::u8(p, TCPHeader::OPT_SACK_PERMITTED);
+        p = NetUnparser::u8(p, 2);
+    }
+    // timestamps come before SACK blocks, which give way when space runs short
+    if (header.has_timestamps && used() + TCPHeader::TIMESTAMPS_LENGTH <= room) {
+        p = NetUnparser::u8(p, TCPHeader::OPT_NOP);
+        p = NetUnparser::u8(p, TCPHeader::OPT_NOP);
+        p = NetUnparser::u8(p, TCPHeader::OPT_TIMESTAMPS);
+        p = NetUnparser::u8(p, 10);
+        p = NetUnparser::u32(p, header.tsval);
+        p = NetUnparser::u32(p, header.tsecr);
+    }
+    if (header.n_sack_blocks > 0 && used() + 4 + 8 <= room) {
+        const size_t n_blocks = min<size_t>(header.n_sack_blocks, (room - used() - 4) / 8);
+        p = NetUnparser::u8(p, TCPHeader::OPT_NOP);
+        p = NetUnparser::u8(p, TCPHeader::OPT_NOP);
+        p = NetUnparser::u8(p, TCPHeader::OPT_SACK);
+        p = NetUnparser::u8(p, 2 + 8 * n_blocks);
+        for (size_t i = 0; i < n_blocks; i++) {
+            p = NetUnparser::u32(p, header.sack_blocks[i].first.raw_value());
+            p = NetUnparser::u32(p, header.sack_blocks[i].second.raw_value());
+        }
+    }
+    while (used() % 4 != 0) {
+        p = NetUnparser::u8(p, TCPHeader::OPT_EOL);
+    }
+    return used();
+}
+
 //! \param[in,out] p is a NetParser from which the TCP fields will be extracted
 //! \returns a ParseResult indicating success or the reason for failure
 //! \details It is important to check for (at least) the following potential errors
@@ -37,8 +90,75 @@ ParseResult TCPHeader::parse(NetParser &p) {
         return ParseResult::HeaderTooShort;
     }
 
-    // skip any options or anything extra in the header
-    p.remove_prefix(doff * 4 - TCPHeader::LENGTH);
+    mss.reset();
+    window_scale.reset();
+    has_timestamps = false;
+    tsval = tsecr = 0;
+    sack_permitted = false;
+    n_sack_blocks = 0;
+
+    // walk the options; unknown ones are skipped, and a malformed one ends the list
+    size_t remaining = doff * 4 - TCPHeader::LENGTH;
+    while (remaining > 0 && !p.error()) {
+        const uint8_t kind = p.u8();
+        remaining--;
+        if (kind == OPT_EOL) {
+            break;
+        }
+        if (kind == OPT_NOP) {
+            continue;
+        }
+        if (remaining == 0) {
+            break;
+        }
+        const uint8_t len = p.u8();
+        remaining--;
+        if (len < 2 || len - 2u > remaining) {
+            break;
+        }
+        size_t body = len - 2u;
+        remaining -= body;
+
+        switch (kind) {
+            case OPT_MSS:
+                if (body == 2) {
+                    mss = p.u16();
+                    body = 0;
+                }
+                break;
+            case OPT_WINDOW_SCALE:
+                if (body == 1) {
+                    window_scale = p.u8();
+                    body = 0;
+                }
+                break;
+            case OPT_TIMESTAMPS:
+                if (body == 8) {
+                    has_timestamps = true;
+                    tsval = p.u32();
+                    tsecr = p.u32();
+                    body = 0;
+                }
+                break;
+            case OPT_SACK_PERMITTED:
+                sack_permitted = true;
+                break;
+            case OPT_SACK:
+                // the options area has room for MAX_SACK_BLOCKS; any more are skipped
+                for (; body >= 8 && n_sack_blocks < MAX_SACK_BLOCKS; body -= 8) {
+                    const WrappingInt32 left{p.u32()};
+                    const WrappingInt32 right{p.u32()};
+                    sack_blocks[n_sack_blocks++] = {left, right};
+                }
+                break;
+            default:
+                break;
+        }
+        p.remove_prefix(body);
+    }
+
+    // skip padding or anything extra in the header
+    p.remove_prefix(remaining);
 
     if (p.error()) {
         return p.get_error();
@@ -49,35 +169,50 @@ ParseResult TCPHeader::parse(NetParser &p) {
 
 //! Serialize the TCPHeader to a string (does not recompute the checksum)
 string TCPHeader::serialize() const {
-    // sanity check
+    string ret(4 * doff, '\0');
+    serialize_into(reinterpret_cast<uint8_t *>(ret.data()), ret.size());
+    return ret;
+}
+
+//! \param[out] out is where to write the header
+//! \param[in] size is the room at `out`, which must be at least `4 * doff` bytes
+size_t TCPHeader::serialize_into(uint8_t *const out, const size_t size) const {
+    // sanity checks
     if (doff < 5) {
         throw runtime_error("TCP header too short");
     }
+    if (size < 4 * size_t{doff}) {
+        throw runtime_error("TCPHeader::serialize_into: no room for the header");
+    }
 
-    string ret;
-    ret.reserve(4 * doff);
-
-    NetUnparser::u16(ret, sport);              // source port
-    NetUnparser::u16(ret, dport);              // destination port
-    NetUnparser::u32(ret, seqno.raw_value());  // sequence number
-    NetUnparser::u32(ret, ackno.raw_value());  // ack number
-    NetUnparser::u8(ret, doff << 4);           // data offset
+    uint8_t *p = out;
+    p = NetUnparser::u16(p, sport);              // source port
+    p = NetUnparser::u16(p, dport);              // destination port
+    p = NetUnparser::u32(p, seqno.raw_value());  // sequence number
+    p = NetUnparser::u32(p, ackno.raw_value());  // ack number
+    p = NetUnparser::u8(p, doff << 4);           // data offset
 
     const uint8_t fl_b = (urg ? 0b0010'0000 : 0) | (ack ? 0b0001'0000 : 0) | (psh ? 0b0000'1000 : 0) |
                          (rst ? 0b0000'0100 : 0) | (syn ? 0b0000'0010 : 0) | (fin ? 0b0000'0001 : 0);
-    NetUnparser::u8(ret, fl_b);  // flags
-    NetUnparser::u16(ret, win);  // window size
+    p = NetUnparser::u8(p, fl_b);  // flags
+    p = NetUnparser::u16(p, win);  // window size
 
-    NetUnparser::u16(ret, cksum);  // checksum
+    p = NetUnparser::u16(p, cksum);  // checksum
 
-    NetUnparser::u16(ret, uptr);  // urgent pointer
+    p = NetUnparser::u16(p, uptr);  // urgent pointer
 
-    ret.resize(4 * doff);  // expand header to advertised size
+    const size_t room = 4 * doff - LENGTH;
+    const size_t options = serialize_options(*this, p, room);  // options
+    fill(p + options, p + room, 0);                            // expand header to advertised size
 
-    return ret;
+    return 4 * doff;
+}
+
+size_t TCPHeader::options_length() const {
+    array<uint8_t, MAX_OPTIONS_LENGTH> scratch;
+    return serialize_options(*this, scratch.data(), scratch.size());
 }
 
-//! \returns A string with the header's contents
 string TCPHeader::to_string() const {
     stringstream ss{};
     ss << hex << boolalpha << "TCP source port: " << +sport << '\n'
@@ -90,13 +225,32 @@ string TCPHeader::to_string() const {
        << "TCP winsize: " << +win << '\n'
        << "TCP cksum: " << +cksum << '\n'
        << "TCP uptr: " << +uptr << '\n';
+    if (mss.has_value()) {
+        ss << "TCP option: MSS " << mss.value() << '\n';
+    }
+    if (window_scale.has_value()) {
+        ss << "TCP option: window scale " << +window_scale.value() << '\n';
+    }
+    if (has_timestamps) {
+        ss << "TCP option: timestamps " << tsval << ' ' << tsecr << '\n';
+    }
+    if (sack_permitted) {
+        ss << "TCP option: SACK permitted\n";
+    }
+    for (size_t i = 0; i < n_sack_blocks; i++) {
+        ss << "TCP option: SACK " << sack_blocks[i].first << " - " << sack_blocks[i].second << '\n';
+    }
     return ss.str();
 }
 
 string TCPHeader::summary() const {
     stringstream ss{};
     ss << "Header(flags=" << (syn ? "S" : "") << (ack ? "A" : "") << (rst ? "R" : "") << (fin ? "F" : "")
-       << ",seqno=" << seqno << ",ack=" << ackno << ",win=" << win << ")";
+       << ",seqno=" << seqno << ",ack=" << ackno << ",win=" << win;
+    for (size_t i = 0; i < n_sack_blocks; i++) {
+        ss << ",sack=" << sack_blocks[i].first << "-" << sack_blocks[i].second;
+    }
+    ss << ")";
     return ss.str();
 }
 
@@ -104,5 +258,11 @@ bool TCPHeader::operator==(const TCPHeader &other) const {
     // TODO(aozdemir) more complete check (right now we omit cksum, src, dst
     return seqno == other.seqno && ackno == other.ackno && doff == other.doff && urg == other.urg && ack == other.ack &&
            psh == other.psh && rst == other.rst && syn == other.syn && fin == other.fin && win == other.win &&
-           uptr == other.uptr;
+           uptr == other.uptr && mss == other.mss && window_scale == other.window_scale &&
+           has_timestamps == other.has_timestamps && tsval == other.tsval && tsecr == other.tsecr &&
+           sack_permitted == other.sack_permitted &&
+           equal(sack_blocks.begin(),
+                 sack_blocks.begin() + n_sack_blocks,
+                 other.sack_blocks.begin(),
+                 other.sack_blocks.begin() + other.n_sack_blocks);
 }
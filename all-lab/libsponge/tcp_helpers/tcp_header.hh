@@ -4,10 +4,34 @@
 #include "parser.hh"
 #include "wrapping_integers.hh"
 
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
 //! \brief [TCP](\ref rfc::rfc793) segment header
-//! \note TCP options are not supported
+//! \note Of the TCP options, only MSS (RFC 9293), window scale and timestamps (RFC 7323), and SACK-permitted and
+//! SACK (RFC 2018) are understood; others are skipped
 struct TCPHeader {
-    static constexpr size_t LENGTH = 20;  //!< [TCP](\ref rfc::rfc793) header length, not including options
+    static constexpr size_t LENGTH = 20;              //!< [TCP](\ref rfc::rfc793) header length, without options
+    static constexpr size_t MAX_OPTIONS_LENGTH = 40;  //!< Longest options area that `doff` can describe
+    static constexpr size_t MAX_SACK_BLOCKS = 4;      //!< Most SACK blocks that fit in the options area
+    static constexpr uint8_t MAX_WINDOW_SCALE = 14;   //!< Largest window scale shift allowed (RFC 7323)
+    static constexpr size_t TIMESTAMPS_LENGTH = 12;   //!< Bytes the (padded) timestamps option takes
+
+    //! \name TCP option kinds
+    //!@{
+    static constexpr uint8_t OPT_EOL = 0;             //!< End of option list
+    static constexpr uint8_t OPT_NOP = 1;             //!< No-operation (padding)
+    static constexpr uint8_t OPT_MSS = 2;             //!< Maximum segment size, SYN only
+    static constexpr uint8_t OPT_WINDOW_SCALE = 3;    //!< Window scale shift, SYN only (RFC 7323)
+    static constexpr uint8_t OPT_SACK_PERMITTED = 4;  //!< SACK-permitted, SYN only (RFC 2018)
+    static constexpr uint8_t OPT_SACK = 5;            //!< SACK blocks (RFC 2018)
+    static constexpr uint8_t OPT_TIMESTAMPS = 8;      //!< Timestamps (RFC 7323)
+    //!@}
+
+    //! A SACK block: the sequence numbers [left edge, right edge) have been received
+    using SACKBlock = std::pair<WrappingInt32, WrappingInt32>;
 
     //! \struct TCPHeader
     //! ~~~{.txt}
@@ -50,12 +74,36 @@ struct TCPHeader {
     uint16_t uptr = 0;          //!< urgent pointer
     //!@}
 
+    //! \name TCP options
+    //! \note `serialize()` only writes the options that fit in `doff`; see options_length()
+    //!@{
+    std::optional<uint16_t> mss{};          //!< maximum segment size offered in a SYN
+    std::optional<uint8_t> window_scale{};  //!< window scale shift offered in a SYN
+    bool has_timestamps = false;            //!< timestamps option present
+    uint32_t tsval = 0;                     //!< timestamp value (sender's clock)
+    uint32_t tsecr = 0;                     //!< timestamp echo reply
+    bool sack_permitted = false;            //!< SACK-permitted option present
+    uint8_t n_sack_blocks = 0;              //!< number of SACK option blocks, the first ones of `sack_blocks`
+    //! SACK option blocks, in place so that a header never allocates (at most four fit in the header)
+    std::array<SACKBlock, MAX_SACK_BLOCKS> sack_blocks{{{WrappingInt32{0}, WrappingInt32{0}},
+                                                        {WrappingInt32{0}, WrappingInt32{0}},
+                                                        {WrappingInt32{0}, WrappingInt32{0}},
+                                                        {WrappingInt32{0}, WrappingInt32{0}}}};
+    //!@}
+
     //! Parse the TCP fields from the provided NetParser
     ParseResult parse(NetParser &p);
 
     //! Serialize the TCP fields
     std::string serialize() const;
 
+    //! \brief Serialize the TCP fields into a caller's buffer, which must have room for `4 * doff` bytes
+    //! \returns the number of bytes written, `4 * doff`
+    size_t serialize_into(uint8_t *out, const size_t size) const;
+
+    //! Bytes the options need in the header (a multiple of four); `doff` should cover LENGTH plus this
+    size_t options_length() const;
+
     //! Return a string containing a header in human-readable format
     std::string to_string() const;
 
@@ -3,6 +3,7 @@
 #include "ipv4_datagram.hh"
 #include "ipv4_header.hh"
 #include "parser.hh"
+#include "util.hh"
 
 #include <arpa/inet.h>
 #include <stdexcept>
@@ -73,14 +74,40 @@ optional<TCPSegment> TCPOverIPv4Adapter::unwrap_tcp_in_ip(const InternetDatagram
 //! Takes a TCP segment, sets port numbers as necessary, and wraps it in an IPv4 datagram
 //! \param[in] seg is the TCP segment to convert
 InternetDatagram TCPOverIPv4Adapter::wrap_tcp_in_ip(TCPSegment &seg) {
+    return wrap_tcp_in_ip(seg, FourTuple::from_addresses(config().source, config().destination));
+}
+
+//! \details Unlike unwrap_tcp_in_ip(), this function does no filtering beyond checking that the
+//! datagram carries a valid TCP segment; the caller decides from `tuple` which connection, if any,
+//! the segment is for.
+//! \param[in] ip_dgram is the datagram to unwrap
+//! \param[out] tuple is set to the connection the segment belongs to, seen from the receiving end
+//! \returns a std::optional<TCPSegment> that is empty if the datagram did not carry a valid TCP segment
+optional<TCPSegment> TCPOverIPv4Adapter::unwrap_any_tcp_in_ip(const InternetDatagram &ip_dgram, FourTuple &tuple) {
+    if (ip_dgram.header().proto != IPv4Header::PROTO_TCP) {
+        return {};
+    }
+
+    TCPSegment tcp_seg;
+    if (ParseResult::NoError != tcp_seg.parse(ip_dgram.payload(), ip_dgram.header().pseudo_cksum())) {
+        return {};
+    }
+
+    tuple = {ip_dgram.header().dst, tcp_seg.header().dport, ip_dgram.header().src, tcp_seg.header().sport};
+    return tcp_seg;
+}
+
+//! \param[in] seg is the TCP segment to convert
+//! \param[in] tuple is the connection to send it on
+InternetDatagram TCPOverIPv4Adapter::wrap_tcp_in_ip(TCPSegment &seg, const FourTuple &tuple) {
     // set the port numbers in the TCP segment
-    seg.header().sport = config().source.port();
-    seg.header().dport = config().destination.port();
+    seg.header().sport = tuple.local_port;
+    seg.header().dport = tuple.remote_port;
 
     // create an Internet Datagram and set its addresses and length
     InternetDatagram ip_dgram;
-    ip_dgram.header().src = config().source.ipv4_numeric();
-    ip_dgram.header().dst = config().destination.ipv4_numeric();
+    ip_dgram.header().src = tuple.local_ip;
+    ip_dgram.header().dst = tuple.remote_ip;
     ip_dgram.header().len = ip_dgram.header().hlen * 4 + seg.header().doff * 4 + seg.payload().size();
 
     // set payload, calculating TCP checksum using information from IP header
@@ -88,3 +115,40 @@ InternetDatagram TCPOverIPv4Adapter::wrap_tcp_in_ip(TCPSegment &seg) {
 
     return ip_dgram;
 }
+
+//! \param[in] seg is the TCP segment to send
+//! \param[in] tuple is the connection to send it on
+//! \param[out] out is where to write the headers
+//! \param[in] size is the room at `out`; MAX_HEADERS_LENGTH is always enough
+size_t TCPOverIPv4Adapter::serialize_headers_into(TCPSegment &seg,
+                                                  const FourTuple &tuple,
+                                                  uint8_t *const out,
+                                                  const size_t size) {
+    // the same header wrap_tcp_in_ip() would make, without the IPv4Datagram (whose payload list allocates)
+    seg.header().sport = tuple.local_port;
+    seg.header().dport = tuple.remote_port;
+
+    IPv4Header ip_header;
+    ip_header.src = tuple.local_ip;
+    ip_header.dst = tuple.remote_ip;
+    ip_header.len = ip_header.hlen * 4 + seg.header().doff * 4 + seg.payload().size();
+
+    const size_t ip_len = ip_header.serialize_into(out, size);
+    InternetChecksum check;
+    check.add({reinterpret_cast<const char *>(out), ip_len});
+    NetUnparser::u16(out + IPv4Header::CKSUM_OFFSET, check.value());
+
+    return ip_len + seg.serialize_header_into(out + ip_len, size - ip_len, ip_header.pseudo_cksum());
+}
+
+//! \param[in] seg is the TCP segment to send
+//! \param[in] tuple is the connection to send it on
+//! \param[in] pool supplies the packet; its headroom must fit the headers, and its tailroom the payload
+PacketBuffer TCPOverIPv4Adapter::wrap_tcp_in_ip(TCPSegment &seg, const FourTuple &tuple, PacketPool &pool) {
+    PacketBuffer packet = pool.acquire();
+    packet.append(seg.payload().str());
+
+    const size_t headers_len = IPv4Header::LENGTH + 4 * size_t{seg.header().doff};
+    serialize_headers_into(seg, tuple, packet.prepend(headers_len), headers_len);
+    return packet;
+}
@@ -3,7 +3,9 @@
 
 #include "buffer.hh"
 #include "fd_adapter.hh"
+#include "four_tuple.hh"
 #include "ipv4_datagram.hh"
+#include "packet_pool.hh"
 #include "tcp_segment.hh"
 
 #include <optional>
@@ -14,6 +16,28 @@ class TCPOverIPv4Adapter : public FdAdapterBase {
     std::optional<TCPSegment> unwrap_tcp_in_ip(const InternetDatagram &ip_dgram);
 
     InternetDatagram wrap_tcp_in_ip(TCPSegment &seg);
+
+    //! Unwraps the TCP segment in any IPv4 datagram, and reports the connection it belongs to
+    static std::optional<TCPSegment> unwrap_any_tcp_in_ip(const InternetDatagram &ip_dgram, FourTuple &tuple);
+
+    //! Wraps a TCP segment in an IPv4 datagram for the connection `tuple`, whatever config() says
+    static InternetDatagram wrap_tcp_in_ip(TCPSegment &seg, const FourTuple &tuple);
+
+    //! Longest IPv4 and TCP headers (with every option) that serialize_headers_into() can write
+    static constexpr size_t MAX_HEADERS_LENGTH = IPv4Header::LENGTH + TCPHeader::LENGTH + TCPHeader::MAX_OPTIONS_LENGTH;
+
+    //! \brief Write the IPv4 and TCP headers that wrap_tcp_in_ip(seg, tuple) would, checksums included, into a
+    //! caller's buffer, without allocating; the datagram is then those bytes followed by `seg.payload()`
+    //! \returns the number of bytes written
+    static size_t serialize_headers_into(TCPSegment &seg, const FourTuple &tuple, uint8_t *out, const size_t size);
+
+    //! \brief Wrap a TCP segment in an IPv4 datagram for the connection `tuple`, built in a packet from `pool`
+    //! \details The payload is copied into the packet once and the headers are written in place in front of it,
+    //! leaving the rest of the headroom for lower layers (e.g. NetworkInterface's Ethernet header).
+    static PacketBuffer wrap_tcp_in_ip(TCPSegment &seg, const FourTuple &tuple, PacketPool &pool);
+
+    //! Largest TCP payload, without options, that fits in an IPv4 datagram of `mtu` bytes
+    static size_t mss_for_mtu(const size_t mtu) { return mtu - IPv4Header::LENGTH - TCPHeader::LENGTH; }
 };
 
 #endif  // SPONGE_LIBSPONGE_TCP_OVER_IP_HH
@@ -3,10 +3,14 @@
 #include "parser.hh"
 #include "util.hh"
 
+#include <utility>
 #include <variant>
 
 using namespace std;
 
+//! byte offset of the checksum field in a serialized TCPHeader
+static constexpr size_t CKSUM_OFFSET = 16;
+
 //! \param[in] buffer string/Buffer to be parsed
 //! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
 ParseResult TCPSegment::parse(const Buffer buffer, const uint32_t datagram_layer_checksum) {
@@ -28,18 +32,31 @@ size_t TCPSegment::length_in_sequence_space() const {
 
 //! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
 BufferList TCPSegment::serialize(const uint32_t datagram_layer_checksum) const {
-    TCPHeader header_out = _header;
-    header_out.cksum = 0;
-
-    // calculate checksum -- taken over entire segment
-    InternetChecksum check(datagram_layer_checksum);
-    check.add(header_out.serialize());
-    check.add(_payload);
-    header_out.cksum = check.value();
+    string header_bytes(4 * _header.doff, '\0');
+    serialize_header_into(
+        reinterpret_cast<uint8_t *>(header_bytes.data()), header_bytes.size(), datagram_layer_checksum);
 
     BufferList ret;
-    ret.append(header_out.serialize());
+    ret.append(move(header_bytes));
     ret.append(_payload);
 
     return ret;
 }
+
+//! \param[out] out is where to write the header
+//! \param[in] size is the room at `out`
+//! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
+size_t TCPSegment::serialize_header_into(uint8_t *const out,
+                                         const size_t size,
+                                         const uint32_t datagram_layer_checksum) const {
+    const size_t len = _header.serialize_into(out, size);
+    NetUnparser::u16(out + CKSUM_OFFSET, 0);
+
+    // calculate checksum -- taken over entire segment -- and patch it into the header in place
+    InternetChecksum check(datagram_layer_checksum);
+    check.add({reinterpret_cast<const char *>(out), len});
+    check.add(_payload);
+    NetUnparser::u16(out + CKSUM_OFFSET, check.value());
+
+    return len;
+}
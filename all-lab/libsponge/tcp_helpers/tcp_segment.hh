@@ -19,6 +19,11 @@ class TCPSegment {
     //! \brief Serialize the segment to a string
     BufferList serialize(const uint32_t datagram_layer_checksum = 0) const;
 
+    //! \brief Serialize the header, checksum included, into a caller's buffer, which must have room for
+    //! `4 * header().doff` bytes; the segment is then those bytes followed by payload(), which is not copied
+    //! \returns the number of bytes written
+    size_t serialize_header_into(uint8_t *out, const size_t size, const uint32_t datagram_layer_checksum = 0) const;
+
     //! \name Accessors
     //!@{
     const TCPHeader &header() const { return _header; }
@@ -18,27 +18,85 @@
 
 using namespace std;
 
-static constexpr size_t TCP_TICK_MS = 10;
+//! Longest the TCP thread sleeps with no deadline pending (a safety net: uncork() and _abort ring `_wakeup`)
+static constexpr int TCP_IDLE_WAKEUP_MS = 1000;
+
+//! \brief Call [socketpair](\ref man2::socketpair) and return connected Unix-domain sockets of specified type
+//! \param[in] type is the type of AF_UNIX sockets to create (e.g., SOCK_SEQPACKET)
+//! \returns a std::pair of connected sockets
+static inline pair<FileDescriptor, FileDescriptor> socket_pair_helper(const int type) {
+    int fds[2];
+    SystemCall("socketpair", ::socketpair(AF_UNIX, type, 0, static_cast<int *>(fds)));
+    return {FileDescriptor(fds[0]), FileDescriptor(fds[1])};
+}
 
 //! \param[in] condition is a function returning true if loop should continue
 template <typename AdaptT>
 void TCPSpongeSocket<AdaptT>::_tcp_loop(const function<bool()> &condition) {
-    auto base_time = timestamp_ms();
+    _last_tick_ms = timestamp_ms();
     while (condition()) {
-        auto ret = _eventloop.wait_next_event(TCP_TICK_MS);
+        // sleep until an fd is ready or the next timer (RTO, delayed ACK, pacing, linger, ARP retry) is due
+        _arm_tick_timer();
+        auto ret = _eventloop.wait_next_event(TCP_IDLE_WAKEUP_MS);
         if (ret == EventLoop::Result::Exit or _abort) {
             break;
         }
 
         if (_tcp.value().active()) {
-            const auto next_time = timestamp_ms();
-            _tcp.value().tick(next_time - base_time);
-            _datagram_adapter.tick(next_time - base_time);
-            base_time = next_time;
+            _apply_cork();
+            _tick();
         }
     }
 }
 
+template <typename AdaptT>
+void TCPSpongeSocket<AdaptT>::_tick() {
+    const auto now = timestamp_ms();
+    if (_tcp.value().active()) {
+        _tcp.value().tick(now - _last_tick_ms);
+        _datagram_adapter.tick(now - _last_tick_ms);
+    }
+    _last_tick_ms = now;
+}
+
+template <typename AdaptT>
+void TCPSpongeSocket<AdaptT>::_arm_tick_timer() {
+    TimerWheel &timers = _eventloop.timers();
+    if (_tick_timer.has_value()) {
+        timers.cancel(_tick_timer.value());
+        _tick_timer.reset();
+    }
+
+    optional<uint64_t> next = _tcp.value().ms_until_next_timer();
+    if (const auto adapter_next = _datagram_adapter.ms_until_next_timer(); adapter_next.has_value()) {
+        next = min(next.value_or(adapter_next.value()), adapter_next.value());
+    }
+    if (next.has_value()) {
+        // deadlines count from the last tick, which is where the connection's clocks stand
+        _tick_timer = timers.schedule(_last_tick_ms + next.value(), [&] { _tick_timer.reset(); });
+    }
+}
+
+template <typename AdaptT>
+void TCPSpongeSocket<AdaptT>::_wake() {
+    if (not _wakeup_rung.exchange(true)) {
+        _wakeup.first.write("!");
+    }
+}
+
+template <typename AdaptT>
+void TCPSpongeSocket<AdaptT>::_apply_cork() {
+    const bool corked = _corked.load();
+    if (corked == _tcp->corked()) {
+        return;
+    }
+    if (corked) {
+        _tcp->cork();
+    } else {
+        _tcp->uncork();
+    }
+}
+
 //! \param[in] data_socket_pair is a pair of connected AF_UNIX SOCK_STREAM sockets
 //! \param[in] datagram_interface is the interface for reading and writing datagrams
 template <typename AdaptT>
@@ -46,17 +104,23 @@ TCPSpongeSocket<AdaptT>::TCPSpongeSocket(pair<FileDescriptor, FileDescriptor> da
                                          AdaptT &&datagram_interface)
     : LocalStreamSocket(move(data_socket_pair.first))
     , _thread_data(move(data_socket_pair.second))
-    , _datagram_adapter(move(datagram_interface)) {
+    , _datagram_adapter(move(datagram_interface))
+    , _wakeup(socket_pair_helper(SOCK_STREAM)) {
     _thread_data.set_blocking(false);
 }
 
 template <typename AdaptT>
 void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
-    _tcp.emplace(config);
+    // unless the caller chose an MSS, send the largest segments the adapter's MTU allows
+    TCPConfig tcp_config = config;
+    if (not tcp_config.mss.has_value()) {
+        tcp_config.mss = _datagram_adapter.mss();
+    }
+    _tcp.emplace(tcp_config);
 
     // Set up the event loop
 
-    // There are four possible events to handle:
+    // There are five possible events to handle:
     //
     // 1) Incoming datagram received (needs to be given to
     //    TCPConnection::segment_received method)
@@ -71,15 +135,23 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
     //
     // 4) Outbound segment generated by TCP (needs to be
     //    given to underlying datagram socket)
+    //
+    // 5) A wakeup from the owner (uncork() or an abort)
 
     // rule 1: read from filtered packet stream and dump into TCPConnection
     _eventloop.add_rule(_datagram_adapter,
                         Direction::In,
                         [&] {
-                            auto seg = _datagram_adapter.read();
-                            if (seg) {
-                                _tcp->segment_received(move(seg.value()));
-                            }
+                            // the adapter may have read a batch of datagrams; take them all before the fd is polled
+                            // again, since it will not report the ones already read
+                            do {
+                                auto seg = _datagram_adapter.read();
+                                if (seg) {
+                                    // bring the clocks up to date first, so RTT samples are exact to the millisecond
+                                    _tick();
+                                    _tcp->segment_received(move(seg.value()));
+                                }
+                            } while (_datagram_adapter.has_buffered_input() and _tcp->active());
 
                             // debugging output:
                             if (_thread_data.eof() and _tcp.value().bytes_in_flight() == 0 and not _fully_acked) {
@@ -96,9 +168,11 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
         _thread_data,
         Direction::In,
         [&] {
-            const auto data = _thread_data.read(_tcp->remaining_outbound_capacity());
+            // the owner stores _corked before writing, so these bytes see its latest cork()
+            _apply_cork();
+            auto data = _thread_data.read(_tcp->remaining_outbound_capacity());
             const auto len = data.size();
-            const auto amount_written = _tcp->write(move(data));
+            const auto amount_written = _tcp->write(Buffer(move(data)));
             if (amount_written != len) {
                 throw runtime_error("TCPConnection::write() accepted less than advertised length");
             }
@@ -110,7 +184,8 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
                 // debugging output:
                 cerr << "DEBUG: Outbound stream to " << _datagram_adapter.config().destination.to_string()
                      << " finished (" << _tcp.value().bytes_in_flight() << " byte"
-                     << (_tcp.value().bytes_in_flight() == 1 ? "" : "s") << " still in flight).\n";
+                     << (_tcp.value().bytes_in_flight() == 1 ? "" : "s") << " still in flight, srtt "
+                     << _tcp.value().srtt() << " ms, rto " << _tcp.value().retransmission_timeout() << " ms).\n";
             }
         },
         [&] { return (_tcp->active()) and (not _outbound_shutdown) and (_tcp->remaining_outbound_capacity() > 0); },
@@ -129,8 +204,7 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
             // the pipe, handling the possibility of a partial
             // write (i.e., only pop what was actually written).
             const size_t amount_to_write = min(size_t(65536), inbound.buffer_size());
-            const std::string buffer = inbound.peek_output(amount_to_write);
-            const auto bytes_written = _thread_data.write(move(buffer), false);
+            const auto bytes_written = _thread_data.write(inbound.peek_output_views(amount_to_write), false);
             inbound.pop_output(bytes_written);
 
             if (inbound.eof() or inbound.error()) {
@@ -158,17 +232,21 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
                                 _datagram_adapter.write(_tcp->segments_out().front());
                                 _tcp->segments_out().pop();
                             }
+                            _datagram_adapter.flush();
                         },
                         [&] { return not _tcp->segments_out().empty(); });
-}
 
-//! \brief Call [socketpair](\ref man2::socketpair) and return connected Unix-domain sockets of specified type
-//! \param[in] type is the type of AF_UNIX sockets to create (e.g., SOCK_SEQPACKET)
-//! \returns a std::pair of connected sockets
-static inline pair<FileDescriptor, FileDescriptor> socket_pair_helper(const int type) {
-    int fds[2];
-    SystemCall("socketpair", ::socketpair(AF_UNIX, type, 0, static_cast<int *>(fds)));
-    return {FileDescriptor(fds[0]), FileDescriptor(fds[1])};
+    // rule 5: wake up for the owner's uncork() or _abort, which _tcp_loop checks once the wait returns
+    _eventloop.add_rule(
+        _wakeup.second,
+        Direction::In,
+        [&] {
+            _wakeup.second.read();
+            // an exchange, not a store: it reads the waker's `true`, which orders the _corked or _abort before it
+            _wakeup_rung.exchange(false);
+        },
+        // for as long as the loop has anything else to wait for (rule 3 outlives the connection until EOF is passed on)
+        [&] { return _tcp->active() or not _inbound_shutdown; });
 }
 
 //! \param[in] datagram_interface is the underlying interface (e.g. to UDP, IP, or Ethernet)
@@ -183,6 +261,7 @@ TCPSpongeSocket<AdaptT>::~TCPSpongeSocket() {
             cerr << "Warning: unclean shutdown of TCPSpongeSocket\n";
             // force the other side to exit
             _abort.store(true);
+            _wake();
             _tcp_thread.join();
         }
     } catch (const exception &e) {
@@ -254,6 +333,8 @@ void TCPSpongeSocket<AdaptT>::listen_and_accept(const TCPConfig &c_tcp, const Fd
 template <typename AdaptT>
 void TCPSpongeSocket<AdaptT>::_tcp_main() {
     try {
+        // every Buffer of the connection stays on this thread, so none needs an atomic reference count
+        const BufferStorage::ThreadConfined confined;
         if (not _tcp.has_value()) {
             throw runtime_error("no TCP");
         }
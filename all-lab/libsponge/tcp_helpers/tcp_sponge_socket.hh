@@ -14,6 +14,7 @@
 #include <cstdint>
 #include <optional>
 #include <thread>
+#include <utility>
 #include <vector>
 
 //! Multithreaded wrapper around TCPConnection that approximates the Unix sockets API
@@ -35,11 +36,23 @@ class TCPSpongeSocket : public LocalStreamSocket {
     std::optional<TCPConnection> _tcp{};
 
     //! eventloop that handles all the events (new inbound datagram, new outbound bytes, new inbound bytes)
-    EventLoop _eventloop{};
+    EventLoop _eventloop{EventLoop::Backend::Epoll};
 
     //! Process events while specified condition is true
     void _tcp_loop(const std::function<bool()> &condition);
 
+    //! The timestamp_ms() up to which the TCPConnection and adapter have been ticked
+    uint64_t _last_tick_ms{0};
+
+    //! The EventLoop timer that wakes the loop for the next TCP or adapter deadline, if one is armed
+    std::optional<TimerWheel::TimerId> _tick_timer{};
+
+    //! Tick the TCPConnection and the adapter up to the current time
+    void _tick();
+
+    //! Re-arm `_tick_timer` for the earliest deadline of the TCPConnection or the adapter
+    void _arm_tick_timer();
+
     //! Main loop of TCPConnection thread
     void _tcp_main();
 
@@ -51,6 +64,19 @@ class TCPSpongeSocket : public LocalStreamSocket {
 
     std::atomic_bool _abort{false};  //!< Flag used by the owner to force the TCPConnection thread to shut down
 
+    std::atomic_bool _corked{false};  //!< Set by the owner's cork(); applied to the TCPConnection by its thread
+
+    //! Connected sockets the owner writes a byte to, so the TCPConnection thread wakes for uncork() and _abort
+    std::pair<FileDescriptor, FileDescriptor> _wakeup;
+
+    std::atomic_bool _wakeup_rung{false};  //!< Is a byte written to `_wakeup` not yet read by the TCPConnection thread?
+
+    //! Wake the TCPConnection thread from its EventLoop, with a system call only if it is not already woken
+    void _wake();
+
+    //! Bring the TCPConnection's cork state in line with `_corked` (TCPConnection thread only)
+    void _apply_cork();
+
     bool _inbound_shutdown{false};  //!< Has TCPSpongeSocket shut down the incoming data to the owner?
 
     bool _outbound_shutdown{false};  //!< Has the owner shut down the outbound data to the TCP connection?
@@ -72,6 +98,16 @@ class TCPSpongeSocket : public LocalStreamSocket {
     //! Listen and accept using the specified configurations; blocks until accept succeeds or fails
     void listen_and_accept(const TCPConfig &c_tcp, const FdAdapterConfig &c_ad);
 
+    //! \brief Hold back partial segments until uncork(), as with TCP_CORK; bytes written after this call are covered
+    void cork() { _corked.store(true); }
+
+    //! \brief Send whatever cork() held back, waking the TCPConnection thread to do it
+    void uncork() {
+        if (_corked.exchange(false)) {
+            _wake();
+        }
+    }
+
     //! When a connected socket is destructed, it will send a RST
     ~TCPSpongeSocket();
 
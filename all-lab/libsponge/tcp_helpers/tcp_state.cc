@@ -79,7 +79,7 @@ TCPState::TCPState(const TCPSender &sender, const TCPReceiver &receiver, const b
     , _active(active)
     , _linger_after_streams_finish(active ? linger : false) {}
 
-string TCPState::state_summary(const TCPReceiver &receiver) {
+const string &TCPState::state_summary(const TCPReceiver &receiver) {
     if (receiver.stream_out().error()) {
         return TCPReceiverStateSummary::ERROR;
     } else if (not receiver.ackno().has_value()) {
@@ -91,7 +91,7 @@ string TCPState::state_summary(const TCPReceiver &receiver) {
     }
 }
 
-string TCPState::state_summary(const TCPSender &sender) {
+const string &TCPState::state_summary(const TCPSender &sender) {
     if (sender.stream_in().error()) {
         return TCPSenderStateSummary::ERROR;
     } else if (sender.next_seqno_absolute() == 0) {
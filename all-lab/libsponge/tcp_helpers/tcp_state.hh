@@ -57,10 +57,12 @@ class TCPState {
     TCPState(const TCPState::State state);
 
     //! \brief Summarize the state of a TCPReceiver in a string
-    static std::string state_summary(const TCPReceiver &receiver);
+    //! \returns one of the TCPReceiverStateSummary constants, so the per-segment checks never allocate
+    static const std::string &state_summary(const TCPReceiver &receiver);
 
     //! \brief Summarize the state of a TCPSender in a string
-    static std::string state_summary(const TCPSender &receiver);
+    //! \returns one of the TCPSenderStateSummary constants
+    static const std::string &state_summary(const TCPSender &receiver);
 };
 
 namespace TCPReceiverStateSummary {
@@ -2,6 +2,85 @@
 
 using namespace std;
 
+//! A pool whose slabs hold the default headroom and then the largest frame a device with this MTU carries
+static PacketPool pool_for_mtu(const size_t mtu) {
+    const size_t largest = PacketPool::DEFAULT_HEADROOM + EthernetHeader::LENGTH + mtu;
+    return PacketPool(PacketPool::DEFAULT_HEADROOM, max(PacketPool::DEFAULT_SLAB_SIZE, largest));
+}
+
+//! \param[in] tun TUN device that will be owned by the adapter
+TCPOverIPv4OverTunFdAdapter::TCPOverIPv4OverTunFdAdapter(TunFD &&tun)
+    : _tun(move(tun)), _pool(pool_for_mtu(_tun.mtu())) {
+    // read() drains the device a batch at a time, and must come back empty-handed once it is dry
+    _tun.set_blocking(false);
+    _outbound.reserve(FileDescriptor::PACKET_BATCH);
+    _flushing.reserve(FileDescriptor::PACKET_BATCH);
+}
+
+optional<InternetDatagram> TCPOverIPv4OverTunFdAdapter::_read_datagram() {
+    if (not has_buffered_input()) {
+        _inbound.clear();
+        _next_inbound = 0;
+        if (_tun.read_packets(_pool, _inbound) == 0) {
+            return {};
+        }
+    }
+
+    InternetDatagram ip_dgram;
+    if (ip_dgram.parse(_inbound[_next_inbound++].buffer()) != ParseResult::NoError) {
+        return {};
+    }
+    return ip_dgram;
+}
+
+//! \param[in] seg the TCPSegment to send
+//! \param[in] tuple the connection to send it on
+void TCPOverIPv4OverTunFdAdapter::_write_segment(TCPSegment &seg, const FourTuple &tuple) {
+    Outbound &datagram = _outbound.emplace_back();
+    datagram.headers_length = serialize_headers_into(seg, tuple, datagram.headers.data(), datagram.headers.size());
+    datagram.payload = seg.payload();
+    if (_outbound.size() >= FileDescriptor::PACKET_BATCH) {
+        flush();
+    }
+}
+
+optional<TCPSegment> TCPOverIPv4OverTunFdAdapter::read() {
+    const auto ip_dgram = _read_datagram();
+    if (not ip_dgram.has_value()) {
+        return {};
+    }
+    return unwrap_tcp_in_ip(ip_dgram.value());
+}
+
+//! \param[out] tuple is set to the connection the segment belongs to, if one was read
+optional<TCPSegment> TCPOverIPv4OverTunFdAdapter::read_any(FourTuple &tuple) {
+    const auto ip_dgram = _read_datagram();
+    if (not ip_dgram.has_value()) {
+        return {};
+    }
+    return unwrap_any_tcp_in_ip(ip_dgram.value(), tuple);
+}
+
+//! \param[in] seg the TCPSegment to send
+void TCPOverIPv4OverTunFdAdapter::write(TCPSegment &seg) {
+    _write_segment(seg, FourTuple::from_addresses(config().source, config().destination));
+}
+
+void TCPOverIPv4OverTunFdAdapter::flush() {
+    if (_outbound.empty()) {
+        return;
+    }
+    // like a write(2) to a full device, a datagram the device cannot take right now is lost, and TCP will resend it
+    _flushing.clear();
+    for (const auto &datagram : _outbound) {
+        BufferViewList &packet = _flushing.emplace_back(
+            string_view{reinterpret_cast<const char *>(datagram.headers.data()), datagram.headers_length});
+        packet.append(datagram.payload);
+    }
+    _tun.write_packets(_flushing);
+    _outbound.clear();
+}
+
 //! \param[in] tap Raw network device that will be owned by the adapter
 //! \param[in] eth_address Ethernet address (local address) of the adapter
 //! \param[in] ip_address IP address (local address) of the adapter
@@ -10,7 +89,7 @@ TCPOverIPv4OverEthernetAdapter::TCPOverIPv4OverEthernetAdapter(TapFD &&tap,
                                                                const EthernetAddress &eth_address,
                                                                const Address &ip_address,
                                                                const Address &next_hop)
-    : _tap(move(tap)), _interface(eth_address, ip_address), _next_hop(next_hop) {
+    : _tap(move(tap)), _pool(pool_for_mtu(_tap.mtu())), _interface(eth_address, ip_address), _next_hop(next_hop) {
     // Linux seems to ignore the first frame sent on a TAP device, so send a dummy frame to prime the pump :-(
     EthernetFrame dummy_frame;
     _tap.write(dummy_frame.serialize());
@@ -18,8 +97,10 @@ TCPOverIPv4OverEthernetAdapter::TCPOverIPv4OverEthernetAdapter(TapFD &&tap,
 
 optional<TCPSegment> TCPOverIPv4OverEthernetAdapter::read() {
     // Read Ethernet frame from the raw device
+    PacketBuffer packet = _pool.acquire();
+    _tap.read(packet);
     EthernetFrame frame;
-    if (frame.parse(_tap.read()) != ParseResult::NoError) {
+    if (frame.parse(packet.buffer()) != ParseResult::NoError) {
         return {};
     }
 
@@ -44,7 +125,11 @@ void TCPOverIPv4OverEthernetAdapter::tick(const size_t ms_since_last_tick) {
 
 //! \param[in] seg the TCPSegment to send
 void TCPOverIPv4OverEthernetAdapter::write(TCPSegment &seg) {
-    _interface.send_datagram(wrap_tcp_in_ip(seg), _next_hop);
+    // build the frame in place: payload, then the TCP, IPv4 and (if the next hop is known) Ethernet headers
+    PacketBuffer packet = wrap_tcp_in_ip(seg, FourTuple::from_addresses(config().source, config().destination), _pool);
+    if (_interface.send_datagram(packet, _next_hop)) {
+        _tap.write(packet.str());
+    }
     send_pending();
 }
 
@@ -3,33 +3,71 @@
 
 #include "ethernet_header.hh"
 #include "network_interface.hh"
+#include "packet_pool.hh"
 #include "tun.hh"
 #include "tcp_over_ip.hh"
 
+#include <array>
 #include <optional>
+#include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 //! \brief A FD adapter for IPv4 datagrams read from and written to a TUN device
+
+//! Datagrams cross the TUN device in batches of up to FileDescriptor::PACKET_BATCH (see
+//! FileDescriptor::read_packets and FileDescriptor::write_packets): read() refills a queue of
+//! inbound datagrams when it runs dry, and write() queues each datagram until flush(). Inbound
+//! datagrams are read straight into packets from a PacketPool, which the parsed segments share.
 class TCPOverIPv4OverTunFdAdapter : public TCPOverIPv4Adapter {
   private:
     TunFD _tun;
+    PacketPool _pool;  //!< slabs that inbound datagrams are read into
+
+    std::vector<PacketBuffer> _inbound{};  //!< datagrams read from the device but not yet returned by read()
+    size_t _next_inbound{0};               //!< index of the next datagram in `_inbound` for read() to return
+
+    //! A datagram written but not yet flushed: its headers, serialized in place, and its payload
+    struct Outbound {
+        std::array<uint8_t, MAX_HEADERS_LENGTH> headers{};
+        size_t headers_length{0};
+        Buffer payload{};
+    };
+    //! datagrams written but not yet flushed to the device; its capacity is kept, so queueing does not allocate
+    std::vector<Outbound> _outbound{};
+    std::vector<BufferViewList> _flushing{};  //!< flush()'s views of `_outbound`, kept for their capacity
+
+    //! The next datagram from the device, read a batch at a time; empty if none is waiting or it does not parse
+    std::optional<InternetDatagram> _read_datagram();
+
+    //! Queue a segment for the device, flushing once a batch is full
+    void _write_segment(TCPSegment &seg, const FourTuple &tuple);
 
   public:
-    //! Construct from a TunFD
-    explicit TCPOverIPv4OverTunFdAdapter(TunFD &&tun) : _tun(std::move(tun)) {}
+    //! Construct from a TunFD, which the adapter puts in non-blocking mode
+    explicit TCPOverIPv4OverTunFdAdapter(TunFD &&tun);
 
     //! Attempts to read and parse an IPv4 datagram containing a TCP segment related to the current connection
-    std::optional<TCPSegment> read() {
-        InternetDatagram ip_dgram;
-        if (ip_dgram.parse(_tun.read()) != ParseResult::NoError) {
-            return {};
-        }
-        return unwrap_tcp_in_ip(ip_dgram);
-    }
+    std::optional<TCPSegment> read();
 
-    //! Creates an IPv4 datagram from a TCP segment and writes it to the TUN device
-    void write(TCPSegment &seg) { _tun.write(wrap_tcp_in_ip(seg).serialize()); }
+    //! Whether read() can return a datagram already read from the device, without waiting for it to be readable
+    bool has_buffered_input() const { return _next_inbound < _inbound.size(); }
+
+    //! Creates an IPv4 datagram from a TCP segment and queues it for the TUN device
+    void write(TCPSegment &seg);
+
+    //! Reads an IPv4 datagram containing a TCP segment for any connection, and reports which one
+    std::optional<TCPSegment> read_any(FourTuple &tuple);
+
+    //! Queues a TCP segment for the connection `tuple`, whatever config() says
+    void write_to(TCPSegment &seg, const FourTuple &tuple) { _write_segment(seg, tuple); }
+
+    //! Writes the queued datagrams to the TUN device
+    void flush();
+
+    //! Largest TCP payload that fits in one datagram at the TUN device's MTU, with no TCP options
+    size_t mss() const { return mss_for_mtu(_tun.mtu()); }
 
     //! Access the underlying TUN device
     operator TunFD &() { return _tun; }
@@ -46,6 +84,8 @@ class TCPOverIPv4OverEthernetAdapter : public TCPOverIPv4Adapter {
   private:
     TapFD _tap;  //!< Raw Ethernet connection
 
+    PacketPool _pool;  //!< slabs that frames are read into and built in
+
     NetworkInterface _interface;  //!< NIC abstraction
 
     Address _next_hop;  //!< IP address of the next hop
@@ -67,6 +107,12 @@ class TCPOverIPv4OverEthernetAdapter : public TCPOverIPv4Adapter {
     //! Called periodically when time elapses
     void tick(const size_t ms_since_last_tick);
 
+    //! Milliseconds until tick() must retry ARP resolution, if a datagram is waiting on it
+    std::optional<uint64_t> ms_until_next_timer() const { return _interface.ms_until_next_timer(); }
+
+    //! Largest TCP payload that fits in one Ethernet frame at the TAP device's MTU, with no TCP options
+    size_t mss() const { return mss_for_mtu(_tap.mtu()); }
+
     //! Access the underlying raw Ethernet connection
     operator TapFD &() { return _tap; }
 
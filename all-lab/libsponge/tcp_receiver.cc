@@ -1,5 +1,7 @@
 #include "tcp_receiver.hh"
 
+#include <algorithm>
+
 using namespace std;
 
 void TCPReceiver::segment_received(const TCPSegment &seg) {
@@ -30,7 +32,40 @@ void TCPReceiver::segment_received(const TCPSegment &seg) {
         return; 
     }
 
-    _reassembler.push_substring(seg.payload().copy(), stream_index, header.fin);
+    if (seg.payload().size() > 0 && stream_index > _reassembler.stream_out().bytes_written()) {
+        _last_out_of_order_idx = stream_index;
+    }
+
+    // 直接传入 payload 的 Buffer，避免每个报文都拷贝一次
+    _reassembler.push_substring(seg.payload(), stream_index, header.fin);
+}
+
+vector<TCPHeader::SACKBlock> TCPReceiver::sack_blocks(const size_t max_blocks) const {
+    vector<TCPHeader::SACKBlock> ret;
+    if (!_syn_received || max_blocks == 0) {
+        return ret;
+    }
+
+    auto intervals = _reassembler.unassembled_intervals();
+    // RFC 2018：第一个 block 必须包含最近收到的那个报文段
+    if (_last_out_of_order_idx.has_value()) {
+        const uint64_t idx = _last_out_of_order_idx.value();
+        const auto recent = find_if(intervals.begin(), intervals.end(), [idx](const auto &interval) {
+            return interval.first <= idx && idx < interval.second;
+        });
+        if (recent != intervals.end()) {
+            rotate(intervals.begin(), recent, recent + 1);
+        }
+    }
+
+    // stream index i is absolute seqno i + 1 (the SYN occupies seqno 0)
+    for (const auto &[begin, end] : intervals) {
+        if (ret.size() == max_blocks) {
+            break;
+        }
+        ret.emplace_back(wrap(begin + 1, _isn), wrap(end + 1, _isn));
+    }
+    return ret;
 }
 
 optional<WrappingInt32> TCPReceiver::ackno() const {
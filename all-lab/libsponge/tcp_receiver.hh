@@ -7,6 +7,7 @@
 #include "wrapping_integers.hh"
 
 #include <optional>
+#include <vector>
 
 //! \brief The "receiver" part of a TCP implementation.
 
@@ -24,6 +25,9 @@ class TCPReceiver {
     bool _syn_received {false};
     WrappingInt32 _isn {0};
 
+    //! stream index of the most recent segment that arrived out of order (reported first in SACK blocks)
+    std::optional<uint64_t> _last_out_of_order_idx{};
+
   public:
     //! \brief Construct a TCP receiver
     //!
@@ -52,6 +56,12 @@ class TCPReceiver {
     //! accepted by the receiver) and (b) the sequence number of the
     //! beginning of the window (the ackno).
     size_t window_size() const;
+
+    //! \brief SACK blocks (RFC 2018) describing the out-of-order data held for reassembly
+    //! \param max_blocks the most blocks to report
+    //! \details The block holding the most recently received out-of-order segment comes first,
+    //! followed by the rest in ascending order. Empty if nothing is held out of order.
+    std::vector<TCPHeader::SACKBlock> sack_blocks(const size_t max_blocks) const;
     //!@}
 
     //! \brief number of bytes stored but not yet reassembled
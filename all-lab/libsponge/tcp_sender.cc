@@ -1,8 +1,11 @@
 #include "tcp_sender.hh"
 #include "tcp_config.hh"
 
-#include <random>
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <random>
+#include <utility>
 
 using namespace std;
 
@@ -13,7 +16,23 @@ TCPSender::TCPSender(const size_t capacity, const uint16_t retx_timeout, const s
     : _isn(fixed_isn.value_or(WrappingInt32{std::random_device{}()}))
     , _initial_retransmission_timeout{retx_timeout}
     , _current_rto{retx_timeout}
-    , _stream(capacity) {}
+    , _stream(capacity, ByteStream::Storage::Chunked)
+    , _rtt(retx_timeout, TCPConfig::RTO_MIN_DFLT, TCPConfig::RTO_MAX_DFLT) {}
+
+//! \param[in] cfg supplies the send capacity, retransmission timeout, ISN, MSS and congestion control algorithm
+TCPSender::TCPSender(const TCPConfig &cfg) : TCPSender(cfg.send_capacity, cfg.rt_timeout, cfg.fixed_isn) {
+    _mss = cfg.mss.value_or(TCPConfig::MAX_PAYLOAD_SIZE);
+    _cc_algorithm = cfg.congestion_control;
+    _cc = make_congestion_controller(_cc_algorithm, _mss);
+    _rtt = RTTEstimator(cfg.rt_timeout, cfg.rto_min, cfg.rto_max);
+    _adaptive_rto = cfg.adaptive_rto;
+    _nagle = cfg.nagle;
+    _cork_timeout = cfg.cork_timeout;
+    _pacing = cfg.pacing;
+    if (_adaptive_rto) {
+        _current_rto = static_cast<unsigned int>(_rtt.rto());
+    }
+}
 
 uint64_t TCPSender::bytes_in_flight() const {
     return _next_seqno - _last_ack_seqno;
@@ -24,7 +43,11 @@ void TCPSender::fill_window() {
         return;
     }
 
-    size_t current_window = _window_size == 0 ? 1 : _window_size;
+    _update_pacing_rate();
+    _pacer_blocked = false;
+
+    // 零窗口时发 1 字节探测；否则取接收方窗口与拥塞窗口中较小者
+    size_t current_window = _window_size == 0 ? 1 : min<size_t>(_window_size, congestion_window());
 
     while (current_window > bytes_in_flight()) {
         TCPSegment seg;
@@ -36,9 +59,22 @@ void TCPSender::fill_window() {
 
         size_t window_remain = current_window - bytes_in_flight();
         size_t payload_capacity = window_remain - (seg.header().syn ? 1 : 0);
-        
-        string payload = _stream.read(min(payload_capacity, TCPConfig::MAX_PAYLOAD_SIZE));
-        seg.payload() = Buffer(std::move(payload));
+
+        if (!_pacer.can_send()) {
+            // tick() tries again once the bucket has refilled
+            _pacer_blocked = _stream.buffer_size() > 0 || _stream.eof();
+            break;
+        }
+
+        if (_hold_partial_segment()) {
+            if (!_held_since.has_value()) {
+                _held_since = _now_ms;
+            }
+            break;
+        }
+
+        // the outbound stream is chunked, so this usually shares the writer's Buffer instead of copying it
+        seg.payload() = _stream.read_buffer(min(payload_capacity, _mss));
 
         if (!_fin_sent && _stream.eof() && (seg.length_in_sequence_space() < window_remain)) {
             seg.header().fin = true;
@@ -50,26 +86,86 @@ void TCPSender::fill_window() {
         }
 
         seg.header().seqno = wrap(_next_seqno, _isn);
-        
-        _segments_out.push(seg);
-        _segments_outstanding.push_back(seg);
-        
+        const bool fin = seg.header().fin;
+
+        if (seg.payload().size() > 0) {
+            _held_since.reset();
+        }
+        _pacer.on_send(seg.length_in_sequence_space());
+
+        // 重传队列里的副本与发出的段共享同一个 payload Buffer，只增加引用计数
+        _outstanding.push(_next_seqno, seg);
         _next_seqno += seg.length_in_sequence_space();
+        _segments_out.push(move(seg));
+
+        if (!_rtt_timing) {
+            _rtt_timing = true;
+            _rtt_seqno = _next_seqno;
+            _rtt_start_ms = _now_ms;
+        }
 
         if (!_timer_running) {
             _timer_running = true;
             _time_elapsed = 0;
         }
 
-        if (seg.header().fin) {
+        if (fin) {
             break;
         }
     }
 }
 
+bool TCPSender::_hold_partial_segment() const {
+    const size_t buffered = _stream.buffer_size();
+    // 满一个 MSS 的数据、流的结尾（FIN 随最后一段立即发出）以及计时器到期时都不再等待
+    if (buffered == 0 || buffered >= _mss || _stream.input_ended() || _flush || _next_seqno == 0) {
+        return false;
+    }
+    return _corked || (_nagle && bytes_in_flight() > 0);
+}
+
+void TCPSender::_update_pacing_rate() {
+    if (!_pacing || !_rtt.has_sample()) {
+        return;
+    }
+    // 与 Linux 相同：慢启动阶段按 2 倍、拥塞避免阶段按 1.2 倍的 window/SRTT 发送，给窗口增长留出余地
+    const size_t window = min<size_t>(_window_size, congestion_window());
+    const double gain = _cc && _cc->in_slow_start() ? 2.0 : 1.2;
+    const double srtt = static_cast<double>(max<uint64_t>(_rtt.srtt(), 1));
+    _pacer.set_rate(gain * static_cast<double>(window) / srtt, _mss);
+}
+
+optional<uint64_t> TCPSender::pacing_delay() const {
+    if (!_pacer_blocked) {
+        return nullopt;
+    }
+    return _pacer.ms_until_send();
+}
+
+optional<uint64_t> TCPSender::ms_until_next_timer() const {
+    optional<uint64_t> next = pacing_delay();
+    const auto consider = [&next](const uint64_t ms) { next = min(next.value_or(ms), ms); };
+
+    if (_timer_running && !_outstanding.empty()) {
+        consider(_time_elapsed >= _current_rto ? 0 : _current_rto - _time_elapsed);
+    }
+    if (_held_since.has_value()) {
+        const uint64_t held = _now_ms - _held_since.value();
+        consider(held >= _cork_timeout ? 0 : _cork_timeout - held);
+    }
+    return next;
+}
+
+void TCPSender::uncork() {
+    _corked = false;
+    fill_window();
+}
+
 //! \param ackno The remote receiver's ackno (acknowledgment number)
 //! \param window_size The remote receiver's advertised window size
-void TCPSender::ack_received(const WrappingInt32 ackno, const uint16_t window_size) {
+//! \param carries_data whether the segment carrying the ACK also occupied sequence space
+void TCPSender::ack_received(const WrappingInt32 ackno, const size_t window_size, const bool carries_data) {
+    const optional<uint32_t> ts_echo = exchange(_ts_echo, nullopt);
     uint64_t abs_ack = unwrap(ackno, _isn, _next_seqno);
 
     // unacceptable ackno
@@ -77,35 +173,90 @@ void TCPSender::ack_received(const WrappingInt32 ackno, const uint16_t window_si
         return;
     }
 
+    // RFC 5681 中的重复 ACK：不带数据、ackno 与窗口都没变，并且还有未确认的数据
+    const bool is_dup_ack = !carries_data && _last_ack_seqno > 0 && abs_ack == _last_ack_seqno &&
+                            window_size == _window_size && !_outstanding.empty();
+
     _window_size = window_size;
 
     bool is_new_data = false;
+    uint64_t acked_bytes = 0;
 
     if (abs_ack > _last_ack_seqno) {
+        acked_bytes = abs_ack - _last_ack_seqno;
+        // the ACK of our SYN carries no data, so it does not open the congestion window;
+        // during fast recovery cwnd is managed by the recovery steps below instead
+        if (_cc && _last_ack_seqno > 0 && !_in_recovery) {
+            _cc->on_ack(acked_bytes, _now_ms);
+        }
         _last_ack_seqno = abs_ack;
         is_new_data = true;
+        _dup_acks = 0;
 
-        _current_rto = _initial_retransmission_timeout;
+        if (ts_echo.has_value()) {
+            // RFC 7323 (4.1)：回显的时间戳对应实际被确认的那次发送，因此重传也能采样
+            const uint32_t rtt = static_cast<uint32_t>(_now_ms) - ts_echo.value();
+            if (rtt <= _now_ms) {
+                _rtt.sample(rtt);
+            }
+            _rtt_timing = false;
+        } else if (_rtt_timing && abs_ack >= _rtt_seqno) {
+            _rtt.sample(_now_ms - _rtt_start_ms);
+            _rtt_timing = false;
+        }
+
+        _current_rto = _adaptive_rto ? static_cast<unsigned int>(_rtt.rto()) : _initial_retransmission_timeout;
         _consecutive_retransmissions = 0;
 
         _time_elapsed = 0;
     }
 
-    while (!_segments_outstanding.empty()) {
-        TCPSegment &seg = _segments_outstanding.front();
-        uint64_t seg_len = seg.length_in_sequence_space();
-        uint64_t seg_abs_seq = unwrap(seg.header().seqno, _isn, _next_seqno);
-        
-        if (seg_abs_seq + seg_len <= abs_ack) {
-            _segments_outstanding.pop_front();
-        } else {
+    _outstanding.acknowledge(abs_ack);
+
+    // 累计确认已覆盖的 SACK 区间不再需要记录
+    while (!_sacked.empty() && _sacked.begin()->first < abs_ack) {
+        auto node = _sacked.extract(_sacked.begin());
+        if (node.mapped() > abs_ack) {
+            node.key() = abs_ack;
+            _sacked.insert(move(node));
             break;
         }
     }
 
+    if (is_new_data && _in_recovery) {
+        if (abs_ack >= _recovery_point || !_cc->partial_ack_recovery()) {
+            _in_recovery = false;
+            _cc->on_recovery_exit(bytes_in_flight());
+        } else {
+            // NewReno：部分确认说明下一个未确认的报文段也丢了，立即重传它；
+            // 有 SACK 信息时只重传尚未重传过的空洞
+            _retx_next = max(_retx_next, abs_ack);
+            if (_sacked.empty()) {
+                _retransmit(abs_ack);
+            } else {
+                _retransmit_next_hole();
+            }
+            _cc->on_partial_ack(acked_bytes);
+        }
+    } else if (is_dup_ack && _cc) {
+        _dup_acks++;
+        if (_in_recovery) {
+            _cc->on_recovery_dup_ack();
+            _retransmit_next_hole();
+        } else if (_dup_acks == TCPConfig::DUP_ACK_THRESHOLD && _last_ack_seqno >= _recovery_point) {
+            // fast retransmit; the recovery point keeps one loss event from halving cwnd twice
+            _in_recovery = true;
+            _recovery_point = _next_seqno;
+            _cc->on_fast_retransmit(bytes_in_flight(), _now_ms);
+            const uint64_t hole_end = _sacked.empty() ? numeric_limits<uint64_t>::max() : _sacked.begin()->first;
+            _retx_next = _retransmit(abs_ack, hole_end);
+            _rtt_timing = false;
+        }
+    }
+
     fill_window();
 
-    if (_segments_outstanding.empty()) {
+    if (_outstanding.empty()) {
         _timer_running = false;
         _time_elapsed = 0; // set to 0 when timer stops
     } else if (is_new_data) {
@@ -115,17 +266,42 @@ void TCPSender::ack_received(const WrappingInt32 ackno, const uint16_t window_si
 
 //! \param[in] ms_since_last_tick the number of milliseconds since the last call to this method
 void TCPSender::tick(const size_t ms_since_last_tick) {
+    _now_ms += ms_since_last_tick;
+
+    _pacer.tick(ms_since_last_tick);
+    if (_pacer_blocked) {
+        fill_window();
+    }
+
+    if (_held_since.has_value() && _now_ms - _held_since.value() >= _cork_timeout) {
+        _held_since.reset();
+        _flush = true;
+        fill_window();
+        _flush = false;
+    }
     if (!_timer_running) {
         return;
     }
 
     _time_elapsed += ms_since_last_tick;
 
-    if (_time_elapsed >= _current_rto && !_segments_outstanding.empty()) {
-        _segments_out.push(_segments_outstanding.front());
+    if (_time_elapsed >= _current_rto && !_outstanding.empty()) {
+        // 超时重发最早的那个段本身，不与后面的段合并
+        _retransmit(_outstanding.front_sent_seqno(), _outstanding.front_end_seqno());
+        // Karn 算法：重传之后的 ACK 无法区分对应哪一次发送，放弃本次测量
+        _rtt_timing = false;
 
+        // a lost zero-window probe says nothing about congestion
         if (_window_size > 0) {
-            _current_rto *= 2;
+            _current_rto =
+                _adaptive_rto ? static_cast<unsigned int>(_rtt.clamp(2 * _current_rto)) : 2 * _current_rto;
+            if (_cc) {
+                _cc->on_timeout(bytes_in_flight(), _now_ms);
+            }
+            // a timeout ends fast recovery; duplicate ACKs for data sent before it are ignored (RFC 6582, Section 4)
+            _in_recovery = false;
+            _recovery_point = _next_seqno;
+            _dup_acks = 0;
         }
         
         _consecutive_retransmissions++;
@@ -133,10 +309,86 @@ void TCPSender::tick(const size_t ms_since_last_tick) {
     }
 }
 
+//! \param blocks the SACK blocks carried by an incoming segment
+void TCPSender::sack_received(const TCPHeader::SACKBlock *blocks, const size_t n_blocks) {
+    for (size_t i = 0; i < n_blocks; i++) {
+        const auto &[left, right] = blocks[i];
+        uint64_t begin = unwrap(left, _isn, _next_seqno);
+        uint64_t end = unwrap(right, _isn, _next_seqno);
+        // ignore blocks that are malformed or that describe data we never sent
+        if (begin >= end || end > _next_seqno || end <= _last_ack_seqno) {
+            continue;
+        }
+        begin = max(begin, _last_ack_seqno);
+
+        // merge with every overlapping or adjacent range already on the scoreboard
+        auto it = _sacked.upper_bound(begin);
+        if (it != _sacked.begin() && prev(it)->second >= begin) {
+            --it;
+        }
+        while (it != _sacked.end() && it->first <= end) {
+            begin = min(begin, it->first);
+            end = max(end, it->second);
+            it = _sacked.erase(it);
+        }
+        _sacked.emplace(begin, end);
+    }
+}
+
+bool TCPSender::_retransmit_next_hole() {
+    if (_sacked.empty() || _outstanding.empty()) {
+        return false;
+    }
+    // skip whatever the peer already holds; the hole runs up to the next SACKed range
+    uint64_t begin = max(_retx_next, _outstanding.begin_seqno());
+    auto it = _sacked.upper_bound(begin);
+    if (it != _sacked.begin() && prev(it)->second > begin) {
+        begin = prev(it)->second;
+    }
+    // only data below the highest SACKed byte is known to be missing
+    if (it == _sacked.end()) {
+        return false;
+    }
+    _retx_next = _retransmit(begin, it->first);
+    return true;
+}
+
+//! \param[in] seqno absolute seqno of the first byte to resend
+//! \param[in] limit the segment stops short of this seqno
+uint64_t TCPSender::_retransmit(const uint64_t seqno, const uint64_t limit) {
+    TCPSegment seg = _outstanding.repacketize(seqno, _mss, limit);
+    seg.header().seqno = wrap(seqno, _isn);
+    const uint64_t end = seqno + seg.length_in_sequence_space();
+    _segments_out.push(move(seg));
+    return end;
+}
+
+uint64_t TCPSender::sacked_bytes() const {
+    uint64_t ret = 0;
+    for (const auto &[begin, end] : _sacked) {
+        ret += end - begin;
+    }
+    return ret;
+}
+
+//! \param[in] mss the new payload limit; ignored unless smaller than the current one
+void TCPSender::set_mss(const size_t mss) {
+    if (mss == 0 || mss >= _mss) {
+        return;
+    }
+    _mss = mss;
+    // the initial window is counted in segments, so start the controller over at the new size
+    _cc = make_congestion_controller(_cc_algorithm, _mss);
+}
+
 unsigned int TCPSender::consecutive_retransmissions() const {
     return _consecutive_retransmissions;
 }
 
+size_t TCPSender::congestion_window() const { return _cc ? _cc->cwnd() : numeric_limits<size_t>::max(); }
+
+size_t TCPSender::slow_start_threshold() const { return _cc ? _cc->ssthresh() : numeric_limits<size_t>::max(); }
+
 void TCPSender::send_empty_segment() {
     TCPSegment seg;
     seg.header().seqno = wrap(_next_seqno, _isn);
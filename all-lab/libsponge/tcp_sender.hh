@@ -2,11 +2,19 @@
 #define SPONGE_LIBSPONGE_TCP_SENDER_HH
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
+#include "pacer.hh"
+#include "retransmission_queue.hh"
+#include "rtt_estimator.hh"
 #include "tcp_config.hh"
 #include "tcp_segment.hh"
 #include "wrapping_integers.hh"
 
 #include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <vector>
 #include <queue>
 #include <deque>  // [修改1] 添加 deque 头文件，因为下面使用了 std::deque
 
@@ -36,8 +44,72 @@ class TCPSender {
     unsigned int _time_elapsed {0};
     bool _timer_running {false};
     unsigned int _consecutive_retransmissions {0};
-    std::deque<TCPSegment> _segments_outstanding {};
-    uint16_t _window_size {1};
+    //! segments sent but not yet acknowledged, keyed by absolute seqno
+    RetransmissionQueue _outstanding{};
+    size_t _window_size {1};
+
+    //! largest payload per segment
+    size_t _mss{TCPConfig::MAX_PAYLOAD_SIZE};
+
+    //! congestion controller; null when TCPConfig::CongestionControl::None is selected
+    TCPConfig::CongestionControl _cc_algorithm{TCPConfig::CongestionControl::None};
+    std::unique_ptr<CongestionController> _cc{};
+
+    //! milliseconds elapsed since construction, as reported by tick()
+    uint64_t _now_ms{0};
+
+    //! SRTT/RTTVAR estimate; drives the RTO only when `_adaptive_rto` is set
+    RTTEstimator _rtt;
+    bool _adaptive_rto{false};
+
+    //! fast recovery: duplicate ACKs seen in a row, and the _next_seqno at the time recovery began
+    unsigned int _dup_acks{0};
+    bool _in_recovery{false};
+    uint64_t _recovery_point{0};
+
+    //! SACK scoreboard: absolute seqno ranges [begin, end) above the cumulative ACK that the peer holds
+    std::map<uint64_t, uint64_t> _sacked{};
+    //! during recovery, holes below this seqno have already been retransmitted
+    uint64_t _retx_next{0};
+
+    //! \brief Retransmit the first hole in the SACK scoreboard at or above `_retx_next`
+    //! \returns `true` if a segment was queued
+    bool _retransmit_next_hole();
+
+    //! \brief Queue a fresh segment of up to one MSS of the outstanding data starting at `seqno`
+    //! \param[in] limit the segment stops short of this seqno
+    //! \returns the absolute seqno just past the retransmitted segment
+    uint64_t _retransmit(const uint64_t seqno, const uint64_t limit = std::numeric_limits<uint64_t>::max());
+
+    //! \name Coalescing of small writes
+    //!@{
+    bool _nagle{false};                                    //!< hold a partial segment while data is unacknowledged
+    bool _corked{false};                                   //!< hold every partial segment until uncork()
+    uint16_t _cork_timeout{TCPConfig::CORK_TIMEOUT_DFLT};  //!< flush held data after this many milliseconds
+    std::optional<uint64_t> _held_since{};                 //!< when a partial segment was first held back
+    bool _flush{false};                                    //!< the hold timer fired: send what is buffered
+    //!@}
+
+    //! \brief Whether fill_window() should wait for more data before sending what is buffered
+    bool _hold_partial_segment() const;
+
+    //! \name Pacing
+    //!@{
+    bool _pacing{false};         //!< pace segments at a rate derived from the window and SRTT
+    Pacer _pacer{};              //!< token bucket; inactive until the first RTT sample
+    bool _pacer_blocked{false};  //!< the last fill_window() left data unsent for lack of tokens
+    //!@}
+
+    //! \brief Set the pacing rate from the current window and SRTT
+    void _update_pacing_rate();
+
+    //! one segment at a time is timed: the sample completes when `_rtt_seqno` is acknowledged
+    bool _rtt_timing{false};
+    uint64_t _rtt_seqno{0};
+    uint64_t _rtt_start_ms{0};
+
+    //! TSecr of the segment whose ACK is about to be processed; replaces the timed segment when set
+    std::optional<uint32_t> _ts_echo{};
 
   public:
     //! Initialize a TCPSender
@@ -45,6 +117,9 @@ class TCPSender {
               const uint16_t retx_timeout = TCPConfig::TIMEOUT_DFLT,
               const std::optional<WrappingInt32> fixed_isn = {});
 
+    //! Initialize a TCPSender from the sender-related fields of a TCPConfig
+    explicit TCPSender(const TCPConfig &cfg);
+
     //! \name "Input" interface for the writer
     //!@{
     ByteStream &stream_in() { return _stream; }
@@ -55,7 +130,17 @@ class TCPSender {
     //!@{
 
     //! \brief A new acknowledgment was received
-    void ack_received(const WrappingInt32 ackno, const uint16_t window_size);
+    //! \param window_size the advertised window, already scaled if window scaling is in use
+    //! \param carries_data whether the segment carrying the ACK also occupied sequence space
+    //! (such a segment is never counted as a duplicate ACK)
+    void ack_received(const WrappingInt32 ackno, const size_t window_size, const bool carries_data = false);
+
+    //! \brief SACK blocks arrived (call before ack_received() for the same segment)
+    void sack_received(const TCPHeader::SACKBlock *blocks, const size_t n_blocks);
+
+    //! \brief The segment carrying the next ACK echoed one of our timestamps, taken from now_ms()
+    //! (call before ack_received() for the same segment)
+    void timestamp_echo_received(const uint32_t tsecr) { _ts_echo = tsecr; }
 
     //! \brief Generate an empty-payload segment (useful for creating empty ACK segments)
     void send_empty_segment();
@@ -67,9 +152,27 @@ class TCPSender {
     void tick(const size_t ms_since_last_tick);
     //!@}
 
+    //! \name Coalescing of small writes
+    //!@{
+
+    //! \brief Send only full segments until uncork(), or until data has been held for the cork timeout
+    void cork() { _corked = true; }
+
+    //! \brief Stop holding partial segments and send what is buffered
+    void uncork();
+
+    bool corked() const { return _corked; }
+    //!@}
+
+    //! \brief Lower the payload size per segment, e.g. to the peer's MSS option (before any data is sent)
+    void set_mss(const size_t mss);
+
     //! \name Accessors
     //!@{
 
+    //! \brief Largest payload per segment, in bytes
+    size_t mss() const { return _mss; }
+
     //! \brief How many sequence numbers are occupied by segments sent but not yet acknowledged?
     //! \note count is in "sequence space," i.e. SYN and FIN each count for one byte
     //! (see TCPSegment::length_in_sequence_space())
@@ -78,6 +181,40 @@ class TCPSender {
     //! \brief Number of consecutive retransmissions that have occurred in a row
     unsigned int consecutive_retransmissions() const;
 
+    //! \brief Current congestion window, in bytes
+    //! \note Without a congestion controller this is unbounded (`std::numeric_limits<size_t>::max()`)
+    size_t congestion_window() const;
+
+    //! \brief Current slow start threshold, in bytes (unbounded without a congestion controller)
+    size_t slow_start_threshold() const;
+
+    //! \brief Smoothed round-trip time, in milliseconds (0 until the first measurement)
+    uint64_t srtt() const { return _rtt.srtt(); }
+
+    //! \brief Round-trip time variation, in milliseconds (0 until the first measurement)
+    uint64_t rttvar() const { return _rtt.rttvar(); }
+
+    //! \brief The current retransmission timeout, including any exponential backoff, in milliseconds
+    unsigned int retransmission_timeout() const { return _current_rto; }
+
+    //! \brief Whether the sender is in fast recovery after a fast retransmit
+    bool in_fast_recovery() const { return _in_recovery; }
+
+    //! \brief Outstanding bytes that the peer has reported (via SACK) as received
+    uint64_t sacked_bytes() const;
+
+    //! \brief Milliseconds until the pacer releases the next segment, if it is holding data back
+    std::optional<uint64_t> pacing_delay() const;
+
+    //! \brief Milliseconds until tick() next has work to do (retransmission, cork flush or pacing), if anything is pending
+    std::optional<uint64_t> ms_until_next_timer() const;
+
+    //! \brief Pacing rate in bytes per millisecond (0 while pacing is off or inactive)
+    double pacing_rate() const { return _pacer.rate(); }
+
+    //! \brief Milliseconds since construction, as reported by tick(); the clock behind TCP timestamps
+    uint64_t now_ms() const { return _now_ms; }
+
     //! \brief TCPSegments that the TCPSender has enqueued for transmission.
     //! \note These must be dequeued and sent by the TCPConnection,
     //! which will need to fill in the fields that are set by the TCPReceiver
@@ -2,12 +2,32 @@
 
 using namespace std;
 
+//! ThreadConfined objects alive on this thread
+static thread_local size_t confinements = 0;
+
+BufferStorage::BufferStorage(string &&bytes) : _atomic(confinements == 0), _bytes(move(bytes)) {}
+
+BufferStorage::ThreadConfined::ThreadConfined() { confinements++; }
+
+BufferStorage::ThreadConfined::~ThreadConfined() { confinements--; }
+
 void Buffer::remove_prefix(const size_t n) {
     if (n > str().size()) {
         throw out_of_range("Buffer::remove_prefix");
     }
     _starting_offset += n;
-    if (_storage and _starting_offset == _storage->size()) {
+    _length -= n;
+    if (_storage and _length == 0) {
+        _storage.reset();
+    }
+}
+
+void Buffer::remove_suffix(const size_t n) {
+    if (n > str().size()) {
+        throw out_of_range("Buffer::remove_suffix");
+    }
+    _length -= n;
+    if (_storage and _length == 0) {
         _storage.reset();
     }
 }
@@ -16,6 +36,7 @@ void BufferList::append(const BufferList &other) {
     for (const auto &buf : other._buffers) {
         _buffers.push_back(buf);
     }
+    _size += other._size;
 }
 
 BufferList::operator Buffer() const {
@@ -40,14 +61,6 @@ string BufferList::concatenate() const {
     return ret;
 }
 
-size_t BufferList::size() const {
-    size_t ret = 0;
-    for (const auto &buf : _buffers) {
-        ret += buf.size();
-    }
-    return ret;
-}
-
 void BufferList::remove_prefix(size_t n) {
     while (n > 0) {
         if (_buffers.empty()) {
@@ -56,20 +69,29 @@ void BufferList::remove_prefix(size_t n) {
 
         if (n < _buffers.front().str().size()) {
             _buffers.front().remove_prefix(n);
+            _size -= n;
             n = 0;
         } else {
             n -= _buffers.front().str().size();
+            _size -= _buffers.front().str().size();
             _buffers.pop_front();
         }
     }
 }
 
-BufferViewList::BufferViewList(const BufferList &buffers) {
+BufferViewList::BufferViewList(const BufferList &buffers) : _size(buffers.size()) {
     for (const auto &x : buffers.buffers()) {
         _views.push_back(x);
     }
 }
 
+void BufferViewList::append(string_view str) {
+    if (not str.empty()) {
+        _views.push_back(str);
+        _size += str.size();
+    }
+}
+
 void BufferViewList::remove_prefix(size_t n) {
     while (n > 0) {
         if (_views.empty()) {
@@ -78,27 +100,28 @@ void BufferViewList::remove_prefix(size_t n) {
 
         if (n < _views.front().size()) {
             _views.front().remove_prefix(n);
+            _size -= n;
             n = 0;
         } else {
             n -= _views.front().size();
+            _size -= _views.front().size();
             _views.pop_front();
         }
     }
 }
 
-size_t BufferViewList::size() const {
-    size_t ret = 0;
-    for (const auto &buf : _views) {
-        ret += buf.size();
-    }
+vector<iovec> BufferViewList::as_iovecs() const {
+    vector<iovec> ret(_views.size());
+    as_iovecs(ret.data(), ret.size());
     return ret;
 }
 
-vector<iovec> BufferViewList::as_iovecs() const {
-    vector<iovec> ret;
-    ret.reserve(_views.size());
-    for (const auto &x : _views) {
-        ret.push_back({const_cast<char *>(x.data()), x.size()});
+//! \param[out] out is where to write the `iovec`s
+//! \param[in] capacity is the room at `out`; views past it are left out
+size_t BufferViewList::as_iovecs(iovec *const out, const size_t capacity) const {
+    const size_t count = min(capacity, _views.size());
+    for (size_t i = 0; i < count; i++) {
+        out[i] = {const_cast<char *>(_views[i].data()), _views[i].size()};
     }
-    return ret;
+    return count;
 }
@@ -1,27 +1,140 @@
 #ifndef SPONGE_LIBSPONGE_BUFFER_HH
 #define SPONGE_LIBSPONGE_BUFFER_HH
 
+#include "small_vector.hh"
+
 #include <algorithm>
-#include <deque>
+#include <atomic>
 #include <memory>
 #include <numeric>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <sys/uio.h>
+#include <utility>
 #include <vector>
 
-//! \brief A reference-counted read-only string that can discard bytes from the front
+//! \brief The bytes behind one or more Buffers, with the count of references to them kept alongside
+
+//! Keeping the count in the storage (rather than in a std::shared_ptr control block) makes each Buffer one
+//! allocation, and lets each BufferStorage decide, when it is made, whether its count needs atomic instructions.
+//! By default it does, so Buffers may be copied, dropped and handed between threads as freely as a
+//! std::shared_ptr. Storage made on a thread while a ThreadConfined is alive there uses plain increments and
+//! decrements instead: it is for threads that run a whole TCP stack themselves (a TCPSpongeSocket's, or an
+//! unsharded TCPEngine's), whose Buffers are only ever touched by one thread at a time.
+class BufferStorage {
+  private:
+    std::atomic<size_t> _refs{0};
+    const bool _atomic;
+    std::string _bytes;
+
+  public:
+    //! \brief Take ownership of `bytes`, with an atomic count unless this thread is confined
+    explicit BufferStorage(std::string &&bytes);
+
+    //! \brief While one exists, storage made on the constructing thread has a non-atomic count
+    //! \note Such storage (and every Buffer of it) must not be used by two threads at once. Handing it over
+    //! with a happens-before edge between (e.g. a thread's start or join) is fine.
+    class ThreadConfined {
+      public:
+        ThreadConfined();
+        ~ThreadConfined();
+        ThreadConfined(const ThreadConfined &other) = delete;
+        ThreadConfined &operator=(const ThreadConfined &other) = delete;
+    };
+
+    //! \brief Add a reference
+    void retain() {
+        if (_atomic) {
+            _refs.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            _refs.store(_refs.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
+
+    //! \brief Drop a reference
+    //! \returns true if it was the last one, and the storage is the caller's to delete
+    bool release() {
+        if (_atomic) {
+            return _refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        }
+        const size_t refs = _refs.load(std::memory_order_relaxed) - 1;
+        _refs.store(refs, std::memory_order_relaxed);
+        return refs == 0;
+    }
+
+    //! \brief The number of references; with an atomic count, once it reads 1, the other holders' writes are visible
+    size_t use_count() const { return _refs.load(_atomic ? std::memory_order_acquire : std::memory_order_relaxed); }
+
+    //! \brief Whether the count is atomic, i.e. the storage was not made on a ThreadConfined thread
+    bool atomic() const { return _atomic; }
+
+    //! \name The bytes
+    //!@{
+    std::string &bytes() { return _bytes; }
+    const std::string &bytes() const { return _bytes; }
+    //!@}
+};
+
+//! \brief A counted reference to a BufferStorage, which is deleted along with the last reference
+class BufferRef {
+  private:
+    BufferStorage *_storage{nullptr};
+
+  public:
+    BufferRef() = default;
+
+    //! \brief Take a reference to `storage` (which may be null)
+    explicit BufferRef(BufferStorage *storage) noexcept : _storage(storage) {
+        if (_storage) {
+            _storage->retain();
+        }
+    }
+
+    //! \brief New storage, owning `bytes`
+    static BufferRef make(std::string &&bytes) { return BufferRef(new BufferStorage(std::move(bytes))); }
+
+    BufferRef(const BufferRef &other) noexcept : BufferRef(other._storage) {}
+    BufferRef(BufferRef &&other) noexcept : _storage(std::exchange(other._storage, nullptr)) {}
+    BufferRef &operator=(BufferRef other) noexcept {
+        std::swap(_storage, other._storage);
+        return *this;
+    }
+    ~BufferRef() { reset(); }
+
+    //! \brief Drop the reference, deleting the storage if it was the last
+    void reset() {
+        if (_storage and _storage->release()) {
+            delete _storage;
+        }
+        _storage = nullptr;
+    }
+
+    BufferStorage *get() const { return _storage; }
+    BufferStorage *operator->() const { return _storage; }
+    explicit operator bool() const { return _storage != nullptr; }
+};
+
+//! \brief A reference-counted read-only string that can discard bytes from the front or back
 class Buffer {
   private:
-    std::shared_ptr<std::string> _storage{};
+    BufferRef _storage{};
     size_t _starting_offset{};
+    size_t _length{};
 
   public:
     Buffer() = default;
 
     //! \brief Construct by taking ownership of a string
-    Buffer(std::string &&str) noexcept : _storage(std::make_shared<std::string>(std::move(str))) {}
+    Buffer(std::string &&str) noexcept : _storage(BufferRef::make(std::move(str))), _length(_storage->bytes().size()) {}
+
+    //! \brief Construct as a view of `length` bytes at `offset` in storage shared with others (e.g. a PacketPool slab)
+    Buffer(BufferRef storage, const size_t offset, const size_t length)
+        : _storage(std::move(storage)), _starting_offset(offset), _length(length) {
+        if (_starting_offset + _length > _storage->bytes().size()) {
+            throw std::out_of_range("Buffer view extends past its storage");
+        }
+    }
 
     //! \name Expose contents as a std::string_view
     //!@{
@@ -29,7 +142,7 @@ class Buffer {
         if (not _storage) {
             return {};
         }
-        return {_storage->data() + _starting_offset, _storage->size() - _starting_offset};
+        return {_storage->bytes().data() + _starting_offset, _length};
     }
 
     operator std::string_view() const { return str(); }
@@ -47,6 +160,10 @@ class Buffer {
     //! \brief Discard the first `n` bytes of the string (does not require a copy or move)
     //! \note Doesn't free any memory until the whole string has been discarded in all copies of the Buffer.
     void remove_prefix(const size_t n);
+
+    //! \brief Discard the last `n` bytes of the string (does not require a copy or move)
+    //! \note Used to slice a shared Buffer; the storage is shared with all other copies.
+    void remove_suffix(const size_t n);
 };
 
 //! \brief A reference-counted discontiguous string that can discard bytes from the front
@@ -54,9 +171,20 @@ class Buffer {
 //! + a payload. This allows us to prepend headers (e.g., to
 //! encapsulate a TCP payload in a TCPSegment, and then encapsulate
 //! the TCPSegment in an IPv4Datagram) without copying the payload.
+//! The first few Buffers (enough for a packet's headers and payload) are kept inline, without allocating.
 class BufferList {
+  public:
+    static constexpr size_t INLINE_BUFFERS = 4;  //!< Buffers kept without allocating
+    using Buffers = SmallVector<Buffer, INLINE_BUFFERS>;
+
   private:
-    std::deque<Buffer> _buffers{};
+    Buffers _buffers{};
+    size_t _size{0};  //!< total length of `_buffers`
+
+    void _push_back(Buffer buffer) {
+        _size += buffer.size();
+        _buffers.push_back(std::move(buffer));
+    }
 
   public:
     //! \name Constructors
@@ -65,17 +193,14 @@ class BufferList {
     BufferList() = default;
 
     //! \brief Construct from a Buffer
-    BufferList(Buffer buffer) : _buffers{buffer} {}
+    BufferList(Buffer buffer) { _push_back(std::move(buffer)); }
 
     //! \brief Construct by taking ownership of a std::string
-    BufferList(std::string &&str) noexcept {
-        Buffer buf{std::move(str)};
-        append(buf);
-    }
+    BufferList(std::string &&str) noexcept { _push_back(Buffer{std::move(str)}); }
     //!@}
 
-    //! \brief Access the underlying queue of Buffers
-    const std::deque<Buffer> &buffers() const { return _buffers; }
+    //! \brief Access the underlying sequence of Buffers
+    const Buffers &buffers() const { return _buffers; }
 
     //! \brief Append a BufferList
     void append(const BufferList &other);
@@ -88,20 +213,28 @@ class BufferList {
     void remove_prefix(size_t n);
 
     //! \brief Size of the string
-    size_t size() const;
+    size_t size() const { return _size; }
 
     //! \brief Make a copy to a new std::string
     std::string concatenate() const;
 };
 
 //! \brief A non-owning temporary view (similar to std::string_view) of a discontiguous string
+//! \note The first few views are kept inline, so a packet's worth of them costs no allocation.
 class BufferViewList {
-    std::deque<std::string_view> _views{};
+  public:
+    static constexpr size_t INLINE_VIEWS = 4;  //!< views kept without allocating
+
+  private:
+    SmallVector<std::string_view, INLINE_VIEWS> _views{};
+    size_t _size{0};  //!< total length of `_views`
 
   public:
     //! \name Constructors
     //!@{
 
+    BufferViewList() = default;
+
     //! \brief Construct from a std::string
     BufferViewList(const std::string &str) : BufferViewList(std::string_view(str)) {}
 
@@ -112,19 +245,29 @@ class BufferViewList {
     BufferViewList(const BufferList &buffers);
 
     //! \brief Construct from a std::string_view
-    BufferViewList(std::string_view str) { _views.push_back({const_cast<char *>(str.data()), str.size()}); }
+    BufferViewList(std::string_view str) : _size(str.size()) { _views.push_back(str); }
     //!@}
 
+    //! \brief Append a view to the end of the list (empty views are skipped)
+    void append(std::string_view str);
+
     //! \brief Discard the first `n` bytes of the string (does not require a copy or move)
     void remove_prefix(size_t n);
 
     //! \brief Size of the string
-    size_t size() const;
+    size_t size() const { return _size; }
+
+    //! \brief Number of views, i.e. of `iovec`s that as_iovecs() produces
+    size_t views() const { return _views.size(); }
 
     //! \brief Convert to a vector of `iovec` structures
     //! \note used for system calls that write discontiguous buffers,
     //! e.g. [writev(2)](\ref man2::writev) and [sendmsg(2)](\ref man2::sendmsg)
     std::vector<iovec> as_iovecs() const;
+
+    //! \brief Fill a caller's array (e.g. on the stack) with the first `capacity` views as `iovec` structures
+    //! \returns the number of `iovec`s written, the lesser of views() and `capacity`
+    size_t as_iovecs(iovec *out, const size_t capacity) const;
 };
 
 #endif  // SPONGE_LIBSPONGE_BUFFER_HH
@@ -2,7 +2,9 @@
 
 #include "util.hh"
 
+#include <algorithm>
 #include <cerrno>
+#include <limits>
 #include <stdexcept>
 #include <system_error>
 #include <utility>
@@ -10,6 +12,21 @@
 
 using namespace std;
 
+//! Submission queue size for Backend::IoUring; more requests than this are submitted in several steps
+static constexpr unsigned IO_URING_ENTRIES = 256;
+
+EventLoop::EventLoop(const Backend backend) : _timers(timestamp_ms()), _backend(backend) {
+    if (_backend == Backend::IoUring and not ::IoUring::available()) {
+        _backend = Backend::Epoll;
+    }
+
+    if (_backend == Backend::Epoll or _backend == Backend::EpollEdge) {
+        _epoll.emplace(SystemCall("epoll_create1", ::epoll_create1(EPOLL_CLOEXEC)));
+    } else if (_backend == Backend::IoUring) {
+        _ring = make_unique<::IoUring>(IO_URING_ENTRIES);
+    }
+}
+
 unsigned int EventLoop::Rule::service_count() const {
     return direction == Direction::In ? fd.read_count() : fd.write_count();
 }
@@ -25,19 +42,137 @@ void EventLoop::add_rule(const FileDescriptor &fd,
                          const CallbackT &callback,
                          const InterestT &interest,
                          const CallbackT &cancel) {
-    _rules.push_back({fd.duplicate(), direction, callback, interest, cancel});
+    if (_epoll.has_value()) {
+        // a closed fd's number can be handed out again before wait_next_event() gets to cancel its rules
+        for (auto reg = _registrations.find(fd.fd_num()); reg != _registrations.end();
+             reg = _registrations.find(fd.fd_num())) {
+            Rule *stale = reg->second.in != nullptr ? reg->second.in : reg->second.out;
+            if (not stale->fd.closed()) {
+                break;
+            }
+            _cancel_rule(find_if(_rules.begin(), _rules.end(), [stale](const Rule &r) { return &r == stale; }));
+        }
+    }
+
+    _rules.push_back({fd.duplicate(), direction, callback, interest, cancel, false, 0});
+    if (not _epoll.has_value()) {
+        return;
+    }
+
+    // the kernel is told about the rule once wait_next_event() finds it interested
+    Rule *&slot = direction == Direction::In ? _registrations[fd.fd_num()].in : _registrations[fd.fd_num()].out;
+    if (slot != nullptr) {
+        _rules.pop_back();
+        throw runtime_error("EventLoop: the epoll backend allows only one rule per fd and direction");
+    }
+    slot = &_rules.back();
+}
+
+list<EventLoop::Rule>::iterator EventLoop::_cancel_rule(list<Rule>::iterator it) {
+    it->cancel();
+    if (_ring) {
+        _disarm(*it);
+    }
+    if (_epoll.has_value()) {
+        const int fd_num = it->fd.fd_num();
+        Registration &reg = _registrations.at(fd_num);
+        (it->direction == Direction::In ? reg.in : reg.out) = nullptr;
+        it->armed = false;
+        if (it->fd.closed()) {
+            // closing the fd already removed it from the epoll set (and its number may be reused);
+            // any rule for the other direction shares the fd, so it is closed too and is canceled next
+            for (Rule *other : {reg.in, reg.out}) {
+                if (other != nullptr) {
+                    other->armed = false;
+                }
+            }
+            reg.events = 0;
+        }
+        _update_registration(fd_num);
+    }
+    return _rules.erase(it);
+}
+
+void EventLoop::_disarm(Rule &rule) {
+    if (not rule.armed) {
+        return;
+    }
+    io_uring_sqe &sqe = _ring->next_sqe();
+    sqe.opcode = IORING_OP_POLL_REMOVE;
+    sqe.addr = rule.poll_id;
+    sqe.user_data = 0;
+    _polls.erase(rule.poll_id);
+    rule.armed = false;
+}
+
+void EventLoop::_update_registration(const int fd_num) {
+    const auto reg = _registrations.find(fd_num);
+    uint32_t events = 0;
+    if (reg->second.in != nullptr and reg->second.in->armed) {
+        events |= EPOLLIN;
+    }
+    if (reg->second.out != nullptr and reg->second.out->armed) {
+        events |= EPOLLOUT;
+    }
+    if (events != 0 and _backend == Backend::EpollEdge) {
+        events |= EPOLLET;
+    }
+
+    // an fd nobody is interested in is removed outright: the kernel reports hangups even with no events requested
+    if (events != reg->second.events) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd_num;
+        const int op = reg->second.events == 0 ? EPOLL_CTL_ADD : events == 0 ? EPOLL_CTL_DEL : EPOLL_CTL_MOD;
+        SystemCall("epoll_ctl", ::epoll_ctl(_epoll->fd_num(), op, fd_num, &ev));
+        reg->second.events = events;
+    }
+
+    if (reg->second.in == nullptr and reg->second.out == nullptr) {
+        _registrations.erase(reg);
+    }
 }
 
-//! \param[in] timeout_ms is the timeout value passed to [poll(2)](\ref man2::poll); `wait_next_event`
+int EventLoop::_timeout_for(const int timeout_ms) const {
+    const auto deadline = _timers.next_deadline();
+    if (not deadline.has_value()) {
+        return timeout_ms;
+    }
+    const uint64_t now = timestamp_ms();
+    const uint64_t until = deadline.value() > now ? deadline.value() - now : 0;
+    const uint64_t limit = timeout_ms < 0 ? numeric_limits<int>::max() : timeout_ms;
+    return static_cast<int>(min(until, limit));
+}
+
+//! \param[in] timeout_ms is the longest the call may wait (negative means no limit); `wait_next_event`
 //!                       returns Result::Timeout if no fd is ready after the timeout expires.
 //! \returns Eventloop::Result indicating success, timeout, or no more Rule objects to poll.
 //!
+//! The steps below describe Backend::Poll; the epoll backends behave the same way, except that only
+//! the rules whose fds are ready are visited after waiting (see the EventLoop class documentation).
+EventLoop::Result EventLoop::wait_next_event(const int timeout_ms) {
+    const int timeout = _timeout_for(timeout_ms);
+    switch (_backend) {
+        case Backend::Poll:
+            return _wait_poll(timeout);
+        case Backend::IoUring:
+            return _wait_io_uring(timeout);
+        default:
+            return _wait_epoll(timeout);
+    }
+}
+
+//! \param[in] timeout_ms is the timeout value passed to [poll(2)](\ref man2::poll)
+//! \returns Eventloop::Result indicating success, timeout, or no more Rule objects to poll.
+//!
 //! For each Rule, this function first calls Rule::interest; if `true`, Rule::fd is added to the
 //! list of file descriptors to be polled for readability (if Rule::direction == Direction::In) or
 //! writability (if Rule::direction == Direction::Out) unless Rule::fd has reached EOF, in which case
 //! the Rule is canceled (i.e., deleted from EventLoop::_rules).
 //!
-//! Next, this function calls [poll(2)](\ref man2::poll) with timeout value `timeout_ms`.
+//! Next, this function calls [poll(2)](\ref man2::poll) with timeout value `timeout_ms` (which
+//! wait_next_event has shortened to the time left until the earliest deadline on EventLoop::timers),
+//! and then fires every timer that has expired.
 //!
 //! Then, for each ready file descriptor, this function calls Rule::callback. If fd reaches EOF or
 //! if the Rule was registered using EventLoop::add_cancelable_rule and Rule::callback returns true,
@@ -58,7 +193,7 @@ void EventLoop::add_rule(const FileDescriptor &fd,
 //! because [poll(2)](\ref man2::poll) is level triggered, so failing to act on a ready file descriptor
 //! will result in a busy loop (poll returns on a ready file descriptor; file descriptor is not read or
 //! written, so it is still ready; the next call to poll will immediately return).
-EventLoop::Result EventLoop::wait_next_event(const int timeout_ms) {
+EventLoop::Result EventLoop::_wait_poll(const int timeout_ms) {
     vector<pollfd> pollfds{};
     pollfds.reserve(_rules.size());
     bool something_to_poll = false;
@@ -95,7 +230,9 @@ EventLoop::Result EventLoop::wait_next_event(const int timeout_ms) {
 
     // call poll -- wait until one of the fds satisfies one of the rules (writeable/readable)
     try {
-        if (0 == SystemCall("poll", ::poll(pollfds.data(), pollfds.size(), timeout_ms))) {
+        const int ready = SystemCall("poll", ::poll(pollfds.data(), pollfds.size(), timeout_ms));
+        _timers.advance(timestamp_ms());
+        if (0 == ready) {
             return Result::Timeout;
         }
     } catch (unix_error const &e) {
@@ -104,9 +241,9 @@ EventLoop::Result EventLoop::wait_next_event(const int timeout_ms) {
         }
     }
 
-    // go through the poll results
+    // go through the poll results; rules a callback adds are appended, and first polled on the next call
 
-    for (auto [it, idx] = make_pair(_rules.begin(), size_t(0)); it != _rules.end(); ++idx) {
+    for (auto [it, idx] = make_pair(_rules.begin(), size_t(0)); it != _rules.end() and idx < pollfds.size(); ++idx) {
         const auto &this_pollfd = pollfds[idx];
 
         const auto poll_error = static_cast<bool>(this_pollfd.revents & (POLLERR | POLLNVAL));
@@ -143,3 +280,177 @@ EventLoop::Result EventLoop::wait_next_event(const int timeout_ms) {
 
     return Result::Success;
 }
+
+//! \param[in] timeout_ms is the timeout value passed to [epoll_wait(2)](\ref man2::epoll_wait)
+EventLoop::Result EventLoop::_wait_epoll(const int timeout_ms) {
+    bool something_to_poll = false;
+
+    // cancel finished rules, and tell the kernel about any change of interest
+    for (auto it = _rules.begin(); it != _rules.end();) {  // NOTE: it gets erased or incremented in loop body
+        if ((it->direction == Direction::In && it->fd.eof()) || it->fd.closed()) {
+            it = _cancel_rule(it);
+            continue;
+        }
+
+        const bool interested = it->interest();
+        if (interested != it->armed) {
+            it->armed = interested;
+            _update_registration(it->fd.fd_num());
+        }
+        something_to_poll |= interested;
+        ++it;
+    }
+
+    // quit if there is nothing left to poll
+    if (not something_to_poll) {
+        return Result::Exit;
+    }
+
+    _ready.resize(max<size_t>(_registrations.size(), 1));
+    int ready = 0;
+    try {
+        ready = SystemCall(
+            "epoll_wait", ::epoll_wait(_epoll->fd_num(), _ready.data(), static_cast<int>(_ready.size()), timeout_ms));
+    } catch (unix_error const &e) {
+        if (e.code().value() == EINTR) {
+            return Result::Exit;
+        }
+        throw;
+    }
+    _timers.advance(timestamp_ms());
+    if (0 == ready) {
+        return Result::Timeout;
+    }
+
+    // go through the ready fds only
+    for (int i = 0; i < ready; i++) {
+        const epoll_event &ev = _ready[i];
+        if (ev.events & EPOLLERR) {
+            throw runtime_error("EventLoop: error on polled file descriptor");
+        }
+
+        for (const auto direction : {Direction::In, Direction::Out}) {
+            // look the fd up again each time: a callback may have added rules or canceled this one
+            const auto reg = _registrations.find(ev.data.fd);
+            if (reg == _registrations.end()) {
+                break;
+            }
+            Rule *const rule = direction == Direction::In ? reg->second.in : reg->second.out;
+            if (rule == nullptr or not rule->armed) {
+                continue;
+            }
+
+            const auto poll_ready = static_cast<bool>(ev.events & (direction == Direction::In ? EPOLLIN : EPOLLOUT));
+            if ((ev.events & EPOLLHUP) && !poll_ready) {
+                // same as the poll backend: a hangup with nothing to do means this fd is defunct
+                const auto it = find_if(_rules.begin(), _rules.end(), [rule](const Rule &r) { return &r == rule; });
+                _cancel_rule(it);
+                continue;
+            }
+
+            if (poll_ready) {
+                const auto count_before = rule->service_count();
+                rule->callback();
+
+                // edge-triggered rules are legitimately left with data the kernel won't report again
+                if (_backend == Backend::Epoll and count_before == rule->service_count() and rule->interest()) {
+                    throw runtime_error(
+                        "EventLoop: busy wait detected: callback did not read/write fd and is still interested");
+                }
+            }
+        }
+    }
+
+    return Result::Success;
+}
+
+//! \param[in] timeout_ms is the longest io_uring_enter waits for a poll request to complete
+EventLoop::Result EventLoop::_wait_io_uring(const int timeout_ms) {
+    bool something_to_poll = false;
+
+    // cancel finished rules, queue a poll request for each newly interested rule, and withdraw the rest
+    for (auto it = _rules.begin(); it != _rules.end();) {  // NOTE: it gets erased or incremented in loop body
+        if ((it->direction == Direction::In && it->fd.eof()) || it->fd.closed()) {
+            it = _cancel_rule(it);
+            continue;
+        }
+
+        const bool interested = it->interest();
+        if (interested and not it->armed) {
+            io_uring_sqe &sqe = _ring->next_sqe();
+            sqe.opcode = IORING_OP_POLL_ADD;
+            sqe.fd = it->fd.fd_num();
+            sqe.poll32_events = static_cast<uint32_t>(it->direction);
+            sqe.user_data = it->poll_id = _next_poll_id++;
+            _polls.emplace(it->poll_id, &*it);
+            it->armed = true;
+        } else if (not interested) {
+            _disarm(*it);
+        }
+        something_to_poll |= interested;
+        ++it;
+    }
+
+    // quit if there is nothing left to poll
+    if (not something_to_poll) {
+        return Result::Exit;
+    }
+
+    // one system call submits every request queued above and waits for the first completion
+    try {
+        _ring->enter(1, timeout_ms);
+    } catch (unix_error const &e) {
+        if (e.code().value() == EINTR) {
+            return Result::Exit;
+        }
+        throw;
+    }
+    _timers.advance(timestamp_ms());
+
+    vector<pair<Rule *, int>> fired{};
+    _ring->reap([&](const io_uring_cqe &cqe) {
+        const auto poll = _polls.find(cqe.user_data);
+        if (poll == _polls.end()) {
+            return;  // a withdrawal, or a request withdrawn before it completed
+        }
+        Rule *const rule = poll->second;
+        _polls.erase(poll);
+        rule->armed = false;
+        if (cqe.res == -ECANCELED) {
+            return;
+        }
+        if (cqe.res < 0) {
+            throw unix_error("io_uring poll", -cqe.res);
+        }
+        fired.emplace_back(rule, cqe.res);
+    });
+    if (fired.empty()) {
+        return Result::Timeout;
+    }
+
+    for (const auto &[rule, revents] : fired) {
+        if (revents & (POLLERR | POLLNVAL)) {
+            throw runtime_error("EventLoop: error on polled file descriptor");
+        }
+
+        const auto poll_ready = static_cast<bool>(revents & static_cast<short>(rule->direction));
+        if ((revents & POLLHUP) && !poll_ready) {
+            // same as the poll backend: a hangup with nothing to do means this fd is defunct
+            _cancel_rule(find_if(_rules.begin(), _rules.end(), [rule = rule](const Rule &r) { return &r == rule; }));
+            continue;
+        }
+
+        if (poll_ready) {
+            const auto count_before = rule->service_count();
+            rule->callback();
+
+            // only check for busy wait if we're not canceling or exiting
+            if (count_before == rule->service_count() and rule->interest()) {
+                throw runtime_error(
+                    "EventLoop: busy wait detected: callback did not read/write fd and is still interested");
+            }
+        }
+    }
+
+    return Result::Success;
+}
@@ -2,11 +2,19 @@
 #define SPONGE_LIBSPONGE_EVENTLOOP_HH
 
 #include "file_descriptor.hh"
+#include "io_uring.hh"
+#include "timer_wheel.hh"
 
+#include <cstdint>
 #include <cstdlib>
 #include <functional>
 #include <list>
+#include <memory>
+#include <optional>
 #include <poll.h>
+#include <sys/epoll.h>
+#include <unordered_map>
+#include <vector>
 
 //! Waits for events on file descriptors and executes corresponding callbacks.
 class EventLoop {
@@ -17,6 +25,21 @@ class EventLoop {
         Out = POLLOUT  //!< Callback will be triggered when Rule::fd is writable.
     };
 
+    //! The system call an EventLoop waits in.
+    enum class Backend {
+        Poll,      //!< [poll(2)](\ref man2::poll), rebuilt from every Rule on each call
+        Epoll,     //!< level-triggered [epoll(7)](\ref man7::epoll), updated only when a Rule's interest changes
+        EpollEdge,  //!< edge-triggered epoll; each callback must drain its fd (read or write until EAGAIN)
+        IoUring     //!< io_uring poll requests, all re-armed in one submission; Epoll if the kernel lacks io_uring
+    };
+
+    //! Returned by each call to EventLoop::wait_next_event.
+    enum class Result {
+        Success,  //!< At least one Rule was triggered.
+        Timeout,  //!< No rules were triggered before timeout.
+        Exit  //!< All rules have been canceled or were uninterested; make no further calls to EventLoop::wait_next_event.
+    };
+
   private:
     using CallbackT = std::function<void(void)>;  //!< Callback for ready Rule::fd
     using InterestT = std::function<bool(void)>;  //!< `true` return indicates Rule::fd should be polled.
@@ -30,6 +53,8 @@ class EventLoop {
         CallbackT callback;   //!< A callback that reads or writes fd.
         InterestT interest;   //!< A callback that returns `true` whenever fd should be polled.
         CallbackT cancel;     //!< A callback that is called when the rule is cancelled (e.g. on hangup)
+        bool armed;           //!< (epoll, io_uring) whether the kernel is watching fd for this rule's direction
+        uint64_t poll_id;     //!< (io_uring) user_data of the rule's outstanding poll request
 
         //! Returns the number of times fd has been read or written, depending on the value of Rule::direction.
         //! \details This function is used internally by EventLoop; you will not need to call it
@@ -38,14 +63,55 @@ class EventLoop {
 
     std::list<Rule> _rules{};  //!< All rules that have been added and not canceled.
 
-  public:
-    //! Returned by each call to EventLoop::wait_next_event.
-    enum class Result {
-        Success,  //!< At least one Rule was triggered.
-        Timeout,  //!< No rules were triggered before timeout.
-        Exit  //!< All rules have been canceled or were uninterested; make no further calls to EventLoop::wait_next_event.
+    TimerWheel _timers;  //!< Deadlines that bound how long wait_next_event() may sleep
+
+    Backend _backend;
+
+    //! \name epoll state
+    //!@{
+
+    //! The rules watching one fd, and the events the kernel currently watches it for
+    struct Registration {
+        Rule *in{nullptr};
+        Rule *out{nullptr};
+        uint32_t events{0};
     };
 
+    std::optional<FileDescriptor> _epoll{};                 //!< the epoll instance, unless Backend::Poll
+    std::unordered_map<int, Registration> _registrations{};  //!< keyed by fd number
+    std::vector<epoll_event> _ready{};                      //!< filled in by epoll_wait
+    //!@}
+
+    //! \name io_uring state
+    //!@{
+    std::unique_ptr<::IoUring> _ring{};             //!< unless the backend is something else
+    std::unordered_map<uint64_t, Rule *> _polls{};  //!< the rule each outstanding poll request belongs to
+    uint64_t _next_poll_id{1};                      //!< 0 marks requests whose completions are ignored
+    //!@}
+
+    //! (io_uring) Withdraw a rule's outstanding poll request, if it has one
+    void _disarm(Rule &rule);
+
+    //! Shorten `timeout_ms` so that the wait ends by the earliest timer deadline
+    int _timeout_for(const int timeout_ms) const;
+
+    //! Cancel a rule: run its cancel callback and forget it
+    std::list<Rule>::iterator _cancel_rule(std::list<Rule>::iterator it);
+
+    //! Bring the kernel's epoll registration for `fd_num` in line with its rules' `armed` flags
+    void _update_registration(const int fd_num);
+
+    Result _wait_poll(const int timeout_ms);
+    Result _wait_epoll(const int timeout_ms);
+    Result _wait_io_uring(const int timeout_ms);
+
+  public:
+    //! \param[in] backend selects poll(2) (the default), epoll(7) or io_uring(7)
+    explicit EventLoop(const Backend backend = Backend::Poll);
+
+    //! The backend in use, which is Backend::Epoll if Backend::IoUring was asked for but is unavailable
+    Backend backend() const { return _backend; }
+
     //! Add a rule whose callback will be called when `fd` is ready in the specified Direction.
     void add_rule(const FileDescriptor &fd,
                   const Direction direction,
@@ -53,8 +119,11 @@ class EventLoop {
                   const InterestT &interest = [] { return true; },
                   const CallbackT &cancel = [] {});
 
-    //! Calls [poll(2)](\ref man2::poll) and then executes callback for each ready fd.
+    //! Calls [poll(2)](\ref man2::poll) and then executes callback for each ready fd and each expired timer.
     Result wait_next_event(const int timeout_ms);
+
+    //! \brief Timers fired by wait_next_event(), on the timestamp_ms() clock
+    TimerWheel &timers() { return _timers; }
 };
 
 using Direction = EventLoop::Direction;
@@ -72,5 +141,21 @@ using Direction = EventLoop::Direction;
 //! A Rule installed using EventLoop::add_cancelable_rule will be polled and canceled under the
 //! same conditions, with the additional condition that if Rule::callback returns `true`, the
 //! Rule will be canceled.
+//!
+//! With Backend::Epoll or Backend::EpollEdge, each fd is registered with the kernel once and the
+//! registration is only changed when a Rule's interest changes, so a wakeup costs one epoll_wait
+//! plus work proportional to the number of ready fds. Interest callbacks and EOF checks still run
+//! once per call, but they are in-process and issue no system calls. An fd may then have at most one
+//! Rule per Direction. With Backend::EpollEdge the kernel only reports transitions to readiness, so a
+//! callback that leaves data unread will not be called again until more arrives (or the Rule's
+//! interest goes from `false` to `true`); the busy-wait check is skipped in that mode.
+//!
+//! Backend::IoUring keeps one one-shot poll request outstanding per interested Rule. Requests that
+//! fired, and withdrawals of rules that lost interest, are all submitted together with the wait in a
+//! single io_uring_enter. Rules behave as with Backend::Poll (level-triggered, several per fd).
+//!
+//! Callbacks can also be scheduled on the EventLoop's TimerWheel (see EventLoop::timers). The
+//! poll in EventLoop::wait_next_event never sleeps past the earliest pending deadline, and
+//! expired timers fire once polling returns, so a caller can block for as long as nothing is due.
 
 #endif  // SPONGE_LIBSPONGE_EVENTLOOP_HH
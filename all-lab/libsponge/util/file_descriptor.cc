@@ -1,8 +1,10 @@
 #include "file_descriptor.hh"
 
+#include "io_uring.hh"
 #include "util.hh"
 
 #include <algorithm>
+#include <cerrno>
 #include <fcntl.h>
 #include <iostream>
 #include <stdexcept>
@@ -73,13 +75,26 @@ string FileDescriptor::read(const size_t limit) {
     return ret;
 }
 
+//! \param[in,out] packet is where the packet lands; a packet larger than its tailroom is truncated
+void FileDescriptor::read(PacketBuffer &packet) {
+    const ssize_t bytes_read = SystemCall("read", ::read(fd_num(), packet.tail(), packet.tailroom()));
+    if (bytes_read == 0 and packet.tailroom() > 0) {
+        _internal_fd->_eof = true;
+    }
+    packet.append(static_cast<size_t>(bytes_read));
+
+    register_read();
+}
+
 size_t FileDescriptor::write(BufferViewList buffer, const bool write_all) {
     size_t total_bytes_written = 0;
 
+    array<iovec, WRITE_IOVECS> iovecs;
     do {
-        auto iovecs = buffer.as_iovecs();
+        // a list of more views than fit goes out over several writes, as a short write would
+        const size_t count = buffer.as_iovecs(iovecs.data(), iovecs.size());
 
-        const ssize_t bytes_written = SystemCall("writev", ::writev(fd_num(), iovecs.data(), iovecs.size()));
+        const ssize_t bytes_written = SystemCall("writev", ::writev(fd_num(), iovecs.data(), count));
         if (bytes_written == 0 and buffer.size() != 0) {
             throw runtime_error("write returned 0 given non-empty input buffer");
         }
@@ -98,6 +113,80 @@ size_t FileDescriptor::write(BufferViewList buffer, const bool write_all) {
     return total_bytes_written;
 }
 
+PacketRing &FileDescriptor::_ring() {
+    if (not _internal_fd->_packet_ring) {
+        _internal_fd->_packet_ring = make_unique<PacketRing>(PACKET_BATCH, MAX_PACKET);
+    }
+    return *_internal_fd->_packet_ring;
+}
+
+//! \param[out] packets receives the packets, in the order they were read
+//! \returns the number of packets read (0 if none was waiting)
+size_t FileDescriptor::read_packets(vector<string> &packets) {
+    size_t count = 0;
+    if (IoUring::available()) {
+        count = _ring().read(fd_num(), packets);
+    } else {
+        string buffer(MAX_PACKET, '\0');
+        while (count < PACKET_BATCH) {
+            const ssize_t bytes_read = SystemCall("read", ::read(fd_num(), buffer.data(), buffer.size()), EAGAIN);
+            if (bytes_read <= 0) {
+                break;
+            }
+            packets.emplace_back(buffer.data(), bytes_read);
+            count++;
+        }
+    }
+
+    register_read();
+    return count;
+}
+
+//! \param[in] pool supplies the packets; reads land after its headroom, and are truncated at the end of a slab
+//! \param[out] packets receives the packets, in the order they were read
+//! \returns the number of packets read (0 if none was waiting)
+size_t FileDescriptor::read_packets(PacketPool &pool, vector<PacketBuffer> &packets) {
+    size_t count = 0;
+    if (IoUring::available()) {
+        count = _ring().read(fd_num(), pool, packets);
+    } else {
+        while (count < PACKET_BATCH) {
+            PacketBuffer packet = pool.acquire();
+            const ssize_t bytes_read =
+                SystemCall("read", ::read(fd_num(), packet.tail(), packet.tailroom()), EAGAIN);
+            if (bytes_read <= 0) {
+                break;
+            }
+            packet.append(static_cast<size_t>(bytes_read));
+            packets.push_back(move(packet));
+            count++;
+        }
+    }
+
+    register_read();
+    return count;
+}
+
+//! \param[in] packets the packets to send, in order
+size_t FileDescriptor::write_packets(const vector<BufferViewList> &packets) {
+    size_t count = 0;
+    if (IoUring::available()) {
+        count = _ring().write(fd_num(), packets);
+    } else {
+        vector<iovec> &iovecs = _internal_fd->_iovecs;
+        for (const auto &packet : packets) {
+            iovecs.resize(packet.views());
+            packet.as_iovecs(iovecs.data(), iovecs.size());
+            if (SystemCall("writev", ::writev(fd_num(), iovecs.data(), iovecs.size()), EAGAIN) >= 0) {
+                count++;
+            }
+        }
+    }
+
+    register_write();
+    return count;
+}
+
 void FileDescriptor::set_blocking(const bool blocking_state) {
     int flags = SystemCall("fcntl", fcntl(fd_num(), F_GETFL));
     if (blocking_state) {
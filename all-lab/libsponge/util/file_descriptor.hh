@@ -2,11 +2,16 @@
 #define SPONGE_LIBSPONGE_FILE_DESCRIPTOR_HH
 
 #include "buffer.hh"
+#include "packet_pool.hh"
 
 #include <array>
 #include <cstddef>
 #include <limits>
 #include <memory>
+#include <string>
+#include <vector>
+
+class PacketRing;
 
 //! A reference-counted handle to a file descriptor
 class FileDescriptor {
@@ -19,6 +24,8 @@ class FileDescriptor {
         bool _closed = false;       //!< Flag indicating whether FDWrapper::_fd has been closed
         unsigned _read_count = 0;   //!< The number of times FDWrapper::_fd has been read
         unsigned _write_count = 0;  //!< The numberof times FDWrapper::_fd has been written
+        std::unique_ptr<PacketRing> _packet_ring{};  //!< io_uring for read_packets()/write_packets(), made on first use
+        std::vector<iovec> _iovecs{};  //!< write_packets() scratch space, without io_uring: one packet's iovecs
 
         //! Construct from a file descriptor number returned by the kernel
         explicit FDWrapper(const int fd);
@@ -44,6 +51,9 @@ class FileDescriptor {
     // private constructor used to duplicate the FileDescriptor (increase the reference count)
     explicit FileDescriptor(std::shared_ptr<FDWrapper> other_shared_ptr);
 
+    //! The fd's PacketRing, set up on first use
+    PacketRing &_ring();
+
   protected:
     void register_read() { ++_internal_fd->_read_count; }    //!< increment read count
     void register_write() { ++_internal_fd->_write_count; }  //!< increment write count
@@ -61,15 +71,39 @@ class FileDescriptor {
     //! Read up to `limit` bytes into `str` (caller can allocate storage)
     void read(std::string &str, const size_t limit = std::numeric_limits<size_t>::max());
 
+    //! Read one packet into the tailroom of `packet`, which grows by the bytes read
+    void read(PacketBuffer &packet);
+
     //! Write a string, possibly blocking until all is written
     size_t write(const char *str, const bool write_all = true) { return write(BufferViewList(str), write_all); }
 
     //! Write a string, possibly blocking until all is written
     size_t write(const std::string &str, const bool write_all = true) { return write(BufferViewList(str), write_all); }
 
+    //! Most views of a BufferViewList that one writev(2) in write() takes; the iovecs live on the stack
+    static constexpr size_t WRITE_IOVECS = 64;
+
     //! Write a buffer (or list of buffers), possibly blocking until all is written
     size_t write(BufferViewList buffer, const bool write_all = true);
 
+    //! \name Batched packet I/O
+    //! For fds whose every read or write is one whole packet, such as a TUN device or a datagram socket.
+    //! The fd must be non-blocking. Where the kernel supports io_uring, each batch is one system call.
+    //!@{
+
+    static constexpr size_t PACKET_BATCH = 16;     //!< most packets read_packets() reads per call
+    static constexpr size_t MAX_PACKET = 65536;    //!< largest packet read_packets() can receive
+
+    //! Read the packets waiting on the fd (up to PACKET_BATCH), appending one string per packet
+    size_t read_packets(std::vector<std::string> &packets);
+
+    //! Read the packets waiting on the fd (up to PACKET_BATCH) straight into packets from `pool`, appending each one
+    size_t read_packets(PacketPool &pool, std::vector<PacketBuffer> &packets);
+
+    //! Write each element of `packets` as one packet; returns how many were sent (a full fd drops the rest)
+    size_t write_packets(const std::vector<BufferViewList> &packets);
+    //!@}
+
     //! Close the underlying file descriptor
     void close() { _internal_fd->close(); }
 
@@ -0,0 +1,243 @@
+#include "io_uring.hh"
+
+#include "util.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace std;
+
+bool IoUring::available() {
+    static const bool ok = [] {
+        io_uring_params params{};
+        const int fd = static_cast<int>(syscall(__NR_io_uring_setup, 2, &params));
+        if (fd < 0) {
+            return false;  // ENOSYS on old kernels, EPERM where io_uring is disabled or filtered
+        }
+        ::close(fd);
+        constexpr uint32_t required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+        return (params.features & required) == required;
+    }();
+    return ok;
+}
+
+IoUring::IoUring(const unsigned entries) : _fd(-1) {
+    io_uring_params params{};
+    _fd = SystemCall("io_uring_setup", static_cast<int>(syscall(__NR_io_uring_setup, entries, &params)));
+
+    try {
+        // with IORING_FEAT_SINGLE_MMAP the submission and completion rings share one mapping
+        _ring_size = max<size_t>(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                                 params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+        _ring_mem = ::mmap(
+            nullptr, _ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQ_RING);
+        if (_ring_mem == MAP_FAILED) {
+            _ring_mem = nullptr;
+            throw unix_error("mmap");
+        }
+        _sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void *sqes = ::mmap(nullptr, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            throw unix_error("mmap");
+        }
+        _sqes = static_cast<io_uring_sqe *>(sqes);
+    } catch (...) {
+        if (_ring_mem != nullptr) {
+            ::munmap(_ring_mem, _ring_size);
+        }
+        ::close(_fd);
+        throw;
+    }
+
+    char *const base = static_cast<char *>(_ring_mem);
+    _sq_head = reinterpret_cast<unsigned *>(base + params.sq_off.head);
+    _sq_tail = reinterpret_cast<unsigned *>(base + params.sq_off.tail);
+    _sq_mask = *reinterpret_cast<unsigned *>(base + params.sq_off.ring_mask);
+    _sq_entries = params.sq_entries;
+    _cq_head = reinterpret_cast<unsigned *>(base + params.cq_off.head);
+    _cq_tail = reinterpret_cast<unsigned *>(base + params.cq_off.tail);
+    _cq_mask = *reinterpret_cast<unsigned *>(base + params.cq_off.ring_mask);
+    _cqes = reinterpret_cast<io_uring_cqe *>(base + params.cq_off.cqes);
+
+    // SQE slot i is always submitted through array slot i
+    unsigned *const array = reinterpret_cast<unsigned *>(base + params.sq_off.array);
+    for (unsigned i = 0; i < _sq_entries; i++) {
+        array[i] = i;
+    }
+}
+
+IoUring::~IoUring() {
+    ::munmap(_sqes, _sqes_size);
+    ::munmap(_ring_mem, _ring_size);
+    ::close(_fd);
+}
+
+io_uring_sqe &IoUring::next_sqe() {
+    const unsigned tail = *_sq_tail;
+    if (tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) == _sq_entries) {
+        enter();
+        if (tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) == _sq_entries) {
+            throw runtime_error("IoUring: submission queue is full");
+        }
+    }
+
+    io_uring_sqe &sqe = _sqes[tail & _sq_mask];
+    sqe = {};
+    // the kernel only reads the queue inside io_uring_enter, so the entry can be published before it is filled in
+    __atomic_store_n(_sq_tail, tail + 1, __ATOMIC_RELEASE);
+    _pending++;
+    return sqe;
+}
+
+void IoUring::enter(const unsigned wait_nr, const int timeout_ms) {
+    unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+    __kernel_timespec ts{};
+    io_uring_getevents_arg arg{};
+    void *argp = nullptr;
+    size_t argsz = 0;
+    if (wait_nr > 0 and timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (timeout_ms % 1000) * 1000000LL;
+        arg.ts = reinterpret_cast<uint64_t>(&ts);
+        flags |= IORING_ENTER_EXT_ARG;
+        argp = &arg;
+        argsz = sizeof(arg);
+    }
+
+    const int ret = static_cast<int>(syscall(__NR_io_uring_enter, _fd, _pending, wait_nr, flags, argp, argsz));
+    _pending = *_sq_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+    SystemCall("io_uring_enter", ret, ETIME);
+}
+
+//! \param[in] buffers the buffers; they must outlive the IoUring
+bool IoUring::register_buffers(const vector<iovec> &buffers) {
+    return 0 == syscall(__NR_io_uring_register, _fd, IORING_REGISTER_BUFFERS, buffers.data(), buffers.size());
+}
+
+PacketRing::PacketRing(const size_t batch, const size_t packet_size)
+    : _ring(static_cast<unsigned>(batch)), _storage(batch * packet_size, '\0'), _buffers(batch), _fixed(false) {
+    for (size_t i = 0; i < batch; i++) {
+        _buffers[i] = {_storage.data() + i * packet_size, packet_size};
+    }
+    _fixed = _ring.register_buffers(_buffers);
+}
+
+//! \param[in] fd a non-blocking fd whose reads each return one packet
+//! \param[in] targets where each read lands
+//! \param[in] fixed whether `targets` are the registered buffers (`_buffers`)
+//! \returns each read's result, in the order of `targets`
+const vector<int> &PacketRing::_read(const int fd, const vector<iovec> &targets, const bool fixed) {
+    for (size_t i = 0; i < targets.size(); i++) {
+        io_uring_sqe &sqe = _ring.next_sqe();
+        sqe.opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe.fd = fd;
+        sqe.off = static_cast<uint64_t>(-1);  // read from the current position, as read(2) does
+        sqe.addr = reinterpret_cast<uint64_t>(targets[i].iov_base);
+        sqe.len = static_cast<uint32_t>(targets[i].iov_len);
+        sqe.buf_index = static_cast<uint16_t>(i);
+        sqe.rw_flags = RWF_NOWAIT;  // io_uring would otherwise park the read until a packet arrives, O_NONBLOCK or not
+        sqe.user_data = i;
+        sqe.flags = i + 1 < targets.size() ? IOSQE_IO_HARDLINK : 0;
+    }
+    _ring.enter(static_cast<unsigned>(targets.size()));
+
+    _results.assign(targets.size(), -ECANCELED);
+    _ring.reap([this](const io_uring_cqe &cqe) { _results.at(cqe.user_data) = cqe.res; });
+
+    for (const int result : _results) {
+        if (result < 0 and result != -EAGAIN and result != -ECANCELED) {
+            throw unix_error("read", -result);
+        }
+    }
+    return _results;
+}
+
+//! \param[in] fd a non-blocking fd whose reads each return one packet (e.g. a TUN device or a datagram socket)
+//! \param[out] packets receives the packets, in the order they were read
+size_t PacketRing::read(const int fd, vector<string> &packets) {
+    const vector<int> &results = _read(fd, _buffers, _fixed);
+
+    size_t count = 0;
+    for (size_t i = 0; i < batch(); i++) {
+        if (results[i] > 0) {
+            packets.emplace_back(static_cast<const char *>(_buffers[i].iov_base), results[i]);
+            count++;
+        }
+    }
+    return count;
+}
+
+//! \details Each read lands straight in the tailroom of a packet from `pool`, so nothing is copied or allocated
+//! once the pool has grown to the packets in flight; the slabs of reads that found nothing go back to the pool.
+//! \param[in] fd a non-blocking fd whose reads each return one packet
+//! \param[in] pool supplies the packets
+//! \param[out] packets receives the packets, in the order they were read
+size_t PacketRing::read(const int fd, PacketPool &pool, vector<PacketBuffer> &packets) {
+    _slots.clear();
+    _targets.clear();
+    for (size_t i = 0; i < batch(); i++) {
+        PacketBuffer &slot = _slots.emplace_back(pool.acquire());
+        _targets.push_back({slot.tail(), slot.tailroom()});
+    }
+    const vector<int> &results = _read(fd, _targets, false);
+
+    size_t count = 0;
+    for (size_t i = 0; i < batch(); i++) {
+        if (results[i] > 0) {
+            _slots[i].append(static_cast<size_t>(results[i]));
+            packets.push_back(move(_slots[i]));
+            count++;
+        }
+    }
+    _slots.clear();
+    return count;
+}
+
+//! \param[in] fd a non-blocking fd whose writes each send one packet
+//! \param[in] packets the packets; each is written with a single writev
+size_t PacketRing::write(const int fd, const vector<BufferViewList> &packets) {
+    size_t written = 0;
+    for (size_t first = 0; first < packets.size(); first += batch()) {
+        const size_t n = min(batch(), packets.size() - first);
+
+        // gather every packet's iovecs before queueing, so the addresses handed to the kernel stay put
+        _iovecs.clear();
+        _spans.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            const BufferViewList &packet = packets[first + i];
+            _spans[i] = {_iovecs.size(), packet.views()};
+            _iovecs.resize(_iovecs.size() + packet.views());
+            packet.as_iovecs(_iovecs.data() + _spans[i].first, _spans[i].second);
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            io_uring_sqe &sqe = _ring.next_sqe();
+            sqe.opcode = IORING_OP_WRITEV;
+            sqe.fd = fd;
+            sqe.off = static_cast<uint64_t>(-1);
+            sqe.addr = reinterpret_cast<uint64_t>(_iovecs.data() + _spans[i].first);
+            sqe.len = static_cast<uint32_t>(_spans[i].second);
+            sqe.rw_flags = RWF_NOWAIT;
+            sqe.user_data = i;
+            sqe.flags = i + 1 < n ? IOSQE_IO_HARDLINK : 0;
+        }
+        _ring.enter(static_cast<unsigned>(n));
+
+        int error = 0;
+        _ring.reap([&](const io_uring_cqe &cqe) {
+            if (cqe.res >= 0) {
+                written++;
+            } else if (cqe.res != -EAGAIN and error == 0) {
+                error = -cqe.res;
+            }
+        });
+        if (error != 0) {
+            throw unix_error("writev", error);
+        }
+    }
+    return written;
+}
@@ -0,0 +1,139 @@
+#ifndef SPONGE_LIBSPONGE_IO_URING_HH
+#define SPONGE_LIBSPONGE_IO_URING_HH
+
+#include "buffer.hh"
+#include "packet_pool.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <linux/io_uring.h>
+#include <string>
+#include <sys/uio.h>
+#include <utility>
+#include <vector>
+
+//! \brief A minimal [io_uring(7)](\ref man7::io_uring) instance, driven through the raw system calls
+
+//! Requests are queued with next_sqe(), handed to the kernel (all at once) by enter(), and their
+//! results collected with reap(). Only the features the EventLoop and PacketRing need are exposed.
+class IoUring {
+  private:
+    int _fd;  //!< the ring's file descriptor
+
+    //! \name Shared ring memory
+    //!@{
+    void *_ring_mem{nullptr};
+    size_t _ring_size{0};
+    io_uring_sqe *_sqes{nullptr};
+    size_t _sqes_size{0};
+
+    unsigned *_sq_head{nullptr};
+    unsigned *_sq_tail{nullptr};
+    unsigned _sq_mask{0};
+    unsigned _sq_entries{0};
+
+    unsigned *_cq_head{nullptr};
+    unsigned *_cq_tail{nullptr};
+    unsigned _cq_mask{0};
+    io_uring_cqe *_cqes{nullptr};
+    //!@}
+
+    unsigned _pending{0};  //!< SQEs queued since the last enter()
+
+  public:
+    //! \brief Whether this kernel can run the rings this class sets up (checked once per process)
+    //! \details Requires Linux 5.11 or later (single mmap, no dropped completions, and timed waits).
+    static bool available();
+
+    //! \param[in] entries the submission queue size (rounded up to a power of two by the kernel)
+    explicit IoUring(const unsigned entries);
+    ~IoUring();
+
+    //! \brief A zeroed submission queue entry to fill in; submits what is queued first if the queue is full
+    io_uring_sqe &next_sqe();
+
+    //! \brief Submit every queued entry and wait for at least `wait_nr` completions
+    //! \param[in] wait_nr completions to wait for (0 only submits)
+    //! \param[in] timeout_ms longest wait in milliseconds; negative waits indefinitely
+    //! \note Throws unix_error on failure, including EINTR; an expired timeout is not an error.
+    void enter(const unsigned wait_nr = 0, const int timeout_ms = -1);
+
+    //! \brief Call `f(cqe)` on each completion that has arrived, then release them to the kernel
+    //! \returns the number of completions
+    template <typename F>
+    size_t reap(F &&f) {
+        const unsigned tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+        unsigned head = *_cq_head;
+        size_t count = 0;
+        for (; head != tail; head++, count++) {
+            f(static_cast<const io_uring_cqe &>(_cqes[head & _cq_mask]));
+        }
+        __atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+    //! \brief Register buffers for IORING_OP_READ_FIXED / IORING_OP_WRITE_FIXED
+    //! \returns `false` if the kernel refused (e.g. over RLIMIT_MEMLOCK); the buffers can still be used unregistered
+    bool register_buffers(const std::vector<iovec> &buffers);
+
+    //! \name
+    //! An IoUring owns kernel memory mappings, so it cannot be copied or moved
+
+    //!@{
+    IoUring(const IoUring &other) = delete;
+    IoUring &operator=(const IoUring &other) = delete;
+    IoUring(IoUring &&other) = delete;
+    IoUring &operator=(IoUring &&other) = delete;
+    //!@}
+};
+
+//! \brief Batched packet reads and writes on a non-blocking fd, through an IoUring with registered buffers
+
+//! Each call hands the kernel one batch of requests in a single system call: read() queues up to
+//! `batch` reads into registered buffers, write() one write per packet. The requests in a batch are
+//! hard-linked, so they run in order and one failure (e.g. EAGAIN once the fd runs dry) does not
+//! cancel the rest. Every request is issued with RWF_NOWAIT, so a batch never waits for the network.
+class PacketRing {
+  private:
+    IoUring _ring;
+    std::string _storage;          //!< `batch` read buffers of `packet_size` bytes each
+    std::vector<iovec> _buffers;   //!< one iovec per read buffer
+    bool _fixed;                   //!< whether `_buffers` are registered with the kernel
+
+    //! \name write() scratch space
+    //!@{
+    std::vector<iovec> _iovecs{};                     //!< the iovecs of every packet in the batch
+    std::vector<std::pair<size_t, size_t>> _spans{};  //!< each packet's first iovec in `_iovecs`, and how many
+    //!@}
+
+    //! \name read() scratch space
+    //!@{
+    std::vector<int> _results{};         //!< each read's result
+    std::vector<PacketBuffer> _slots{};  //!< the pooled packets being read into
+    std::vector<iovec> _targets{};       //!< the tailroom of each of `_slots`
+    //!@}
+
+    //! Queue one read per target, hard-linked, and submit them; throws on any failure but running dry
+    const std::vector<int> &_read(const int fd, const std::vector<iovec> &targets, const bool fixed);
+
+  public:
+    //! \param[in] batch the most packets handled per call
+    //! \param[in] packet_size the largest packet read() can receive
+    PacketRing(const size_t batch, const size_t packet_size);
+
+    //! \brief Read the packets waiting on `fd` (up to one batch), appending one string per packet
+    //! \returns the number of packets read
+    size_t read(const int fd, std::vector<std::string> &packets);
+
+    //! \brief Read the packets waiting on `fd` (up to one batch) into packets from `pool`, appending each one
+    //! \returns the number of packets read
+    size_t read(const int fd, PacketPool &pool, std::vector<PacketBuffer> &packets);
+
+    //! \brief Write each packet as one write, all in a single submission
+    //! \returns the number of packets written; a packet the kernel could not take at once (EAGAIN) is dropped
+    size_t write(const int fd, const std::vector<BufferViewList> &packets);
+
+    size_t batch() const { return _buffers.size(); }
+};
+
+#endif  // SPONGE_LIBSPONGE_IO_URING_HH
@@ -0,0 +1,60 @@
+#include "packet_pool.hh"
+
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+//! \param[in] slab the storage, which the packet shares
+//! \param[in] headroom where in `slab` the (empty) packet starts
+PacketBuffer::PacketBuffer(BufferRef slab, const size_t headroom)
+    : _slab(move(slab)), _begin(headroom), _end(headroom) {
+    if (_begin > _slab->bytes().size()) {
+        throw out_of_range("PacketBuffer headroom is larger than its slab");
+    }
+}
+
+uint8_t *PacketBuffer::prepend(const size_t n) {
+    if (n > headroom()) {
+        throw runtime_error("PacketBuffer::prepend: " + to_string(n) + " bytes do not fit in the headroom of " +
+                            to_string(headroom()));
+    }
+    _begin -= n;
+    return data();
+}
+
+uint8_t *PacketBuffer::append(const size_t n) {
+    if (n > tailroom()) {
+        throw runtime_error("PacketBuffer::append: " + to_string(n) + " bytes do not fit in the tailroom of " +
+                            to_string(tailroom()));
+    }
+    uint8_t *const added = tail();
+    _end += n;
+    return added;
+}
+
+void PacketBuffer::append(const string_view bytes) {
+    if (not bytes.empty()) {
+        memcpy(append(bytes.size()), bytes.data(), bytes.size());
+    }
+}
+
+PacketPool::PacketPool(const size_t headroom, const size_t slab_size) : _headroom(headroom), _slab_size(slab_size) {
+    if (_headroom > _slab_size) {
+        throw out_of_range("PacketPool headroom is larger than its slabs");
+    }
+}
+
+PacketBuffer PacketPool::acquire() {
+    const size_t probes = min(_slabs.size(), MAX_PROBES);
+    for (size_t i = 0; i < probes; i++) {
+        const BufferRef &slab = _slabs[_next];
+        _next = (_next + 1) % _slabs.size();
+        if (slab->use_count() == 1) {  // only the pool's own reference is left
+            return {slab, _headroom};
+        }
+    }
+
+    _slabs.push_back(BufferRef::make(string(_slab_size, '\0')));
+    return {_slabs.back(), _headroom};
+}
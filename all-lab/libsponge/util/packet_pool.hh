@@ -0,0 +1,101 @@
+#ifndef SPONGE_LIBSPONGE_PACKET_POOL_HH
+#define SPONGE_LIBSPONGE_PACKET_POOL_HH
+
+#include "buffer.hh"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//! \brief A packet held contiguously in a slab from a PacketPool, with room on either side to grow in place
+
+//! A packet is built by reading or copying its payload into the tailroom, then writing each header into the
+//! headroom in front of it, innermost first, so encapsulation never copies the payload again. buffer() hands the
+//! packet out as a Buffer that shares the slab; the slab returns to the pool once every such Buffer is gone.
+class PacketBuffer {
+  private:
+    BufferRef _slab{};
+    size_t _begin{0};  //!< offset of the packet's first byte in the slab
+    size_t _end{0};    //!< offset one past the packet's last byte
+
+    uint8_t *_at(const size_t offset) { return reinterpret_cast<uint8_t *>(_slab->bytes().data()) + offset; }
+
+  public:
+    PacketBuffer() = default;
+
+    //! \brief An empty packet `headroom` bytes into `slab`
+    PacketBuffer(BufferRef slab, const size_t headroom);
+
+    //! \name The packet's bytes
+    //!@{
+    uint8_t *data() { return _at(_begin); }
+    size_t size() const { return _end - _begin; }
+    std::string_view str() const { return {_slab->bytes().data() + _begin, size()}; }
+    //!@}
+
+    //! \name Room around the packet
+    //!@{
+    size_t headroom() const { return _begin; }
+    size_t tailroom() const { return _slab->bytes().size() - _end; }
+
+    //! \brief First byte past the packet, where a read can land before append() claims it
+    uint8_t *tail() { return _at(_end); }
+    //!@}
+
+    //! \brief Grow the packet `n` bytes at the front (e.g. for a header); throws unless there is the headroom
+    //! \returns the new first byte, for the caller to fill
+    uint8_t *prepend(const size_t n);
+
+    //! \brief Grow the packet `n` bytes at the back; throws unless there is the tailroom
+    //! \returns the first of the new bytes, for the caller to fill (unless a read already has)
+    uint8_t *append(const size_t n);
+
+    //! \brief Copy `bytes` onto the back of the packet
+    void append(const std::string_view bytes);
+
+    //! \brief The packet as a read-only Buffer, sharing the slab (no copy)
+    Buffer buffer() const { return Buffer(_slab, _begin, size()); }
+};
+
+//! \brief A pool of fixed-size slabs for packets, each reused once nothing refers to it any more
+
+//! acquire() only allocates while the pool is growing to the number of packets in flight; after that, it
+//! hands back slabs whose last PacketBuffer and Buffer are gone. A slab is found by probing round-robin
+//! from where the previous search stopped, which finds free slabs first when packets are released
+//! roughly in the order they were acquired. Only one thread may call acquire(). Packets may be released on
+//! any thread, unless the slabs were made on a BufferStorage::ThreadConfined thread (see BufferStorage).
+class PacketPool {
+  private:
+    std::vector<BufferRef> _slabs{};
+    size_t _next{0};  //!< where the next search for a free slab starts
+    size_t _headroom;
+    size_t _slab_size;
+
+  public:
+    static constexpr size_t DEFAULT_HEADROOM = 128;    //!< room for Ethernet, IPv4 and TCP headers with options
+    static constexpr size_t DEFAULT_SLAB_SIZE = 2048;  //!< a 1500-byte MTU's packet after the default headroom
+    static constexpr size_t MAX_PROBES = 16;           //!< busy slabs acquire() skips before growing the pool
+
+    //! \param[in] headroom bytes left in front of each packet
+    //! \param[in] slab_size bytes per slab: the headroom, the largest packet, and any tailroom
+    explicit PacketPool(const size_t headroom = DEFAULT_HEADROOM, const size_t slab_size = DEFAULT_SLAB_SIZE);
+
+    //! The pool owns slabs that others may share, so it cannot be copied (a copy would never free any)
+    PacketPool(const PacketPool &other) = delete;
+    PacketPool &operator=(const PacketPool &other) = delete;
+    PacketPool(PacketPool &&other) = default;
+    PacketPool &operator=(PacketPool &&other) = default;
+    ~PacketPool() = default;
+
+    //! \brief An empty packet at the pool's headroom in a free slab
+    PacketBuffer acquire();
+
+    //! \brief Slabs the pool has made, free or not
+    size_t size() const { return _slabs.size(); }
+
+    size_t headroom() const { return _headroom; }
+    size_t slab_size() const { return _slab_size; }
+};
+
+#endif  // SPONGE_LIBSPONGE_PACKET_POOL_HH
@@ -3,8 +3,10 @@
 
 #include "buffer.hh"
 
+#include <arpa/inet.h>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <string>
 #include <utility>
 
@@ -74,6 +76,28 @@ struct NetUnparser {
 
     //! Write an 8-bit integer into the data stream in network byte order
     static void u8(std::string &s, const uint8_t val);
+
+    //! \name Writing into a caller's buffer
+    //! Each writes an integer at `out` in network byte order, with a single store, and returns the position after it.
+    //! The caller makes sure there is room.
+    //!@{
+    static uint8_t *u32(uint8_t *out, const uint32_t val) {
+        const uint32_t net = htonl(val);
+        memcpy(out, &net, sizeof(net));
+        return out + sizeof(net);
+    }
+
+    static uint8_t *u16(uint8_t *out, const uint16_t val) {
+        const uint16_t net = htons(val);
+        memcpy(out, &net, sizeof(net));
+        return out + sizeof(net);
+    }
+
+    static uint8_t *u8(uint8_t *out, const uint8_t val) {
+        *out = val;
+        return out + 1;
+    }
+    //!@}
 };
 
 #endif  // SPONGE_LIBSPONGE_PARSER_HH
@@ -0,0 +1,141 @@
+#ifndef SPONGE_LIBSPONGE_SMALL_VECTOR_HH
+#define SPONGE_LIBSPONGE_SMALL_VECTOR_HH
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+//! \brief A sequence that keeps its first `N` elements inline, and can be consumed from the front
+
+//! Appending up to `N` elements allocates nothing; past that, the elements move to a std::vector, which keeps
+//! its capacity for the rest of the SmallVector's life. pop_front() just steps over the first element (leaving
+//! a default-constructed `T` in its slot, so a Buffer lets go of its storage), and the vacated slots are
+//! reclaimed when the sequence empties or when an append would otherwise need more room. `T` must be cheap to
+//! default-construct, as every inline slot holds one.
+template <typename T, size_t N>
+class SmallVector {
+  private:
+    std::array<T, N> _inline{};
+    std::vector<T> _heap{};  //!< the slots, once there have been more than `N`; its size is `_end`
+    bool _spilled{false};    //!< whether the slots are `_heap`, rather than `_inline`
+    size_t _begin{0};        //!< the slot of the first element
+    size_t _end{0};          //!< one past the slot of the last element
+
+    T *_slots() { return _spilled ? _heap.data() : _inline.data(); }
+    const T *_slots() const { return _spilled ? _heap.data() : _inline.data(); }
+
+    //! Move the elements down to the first slot
+    void _compact() {
+        T *const slots = _slots();
+        for (size_t i = _begin; i < _end; i++) {
+            slots[i - _begin] = std::move(slots[i]);
+            slots[i] = T{};
+        }
+        _end -= _begin;
+        _begin = 0;
+        if (_spilled) {
+            _heap.resize(_end);
+        }
+    }
+
+  public:
+    SmallVector() = default;
+    SmallVector(const SmallVector &other) = default;
+    SmallVector &operator=(const SmallVector &other) = default;
+    ~SmallVector() = default;
+
+    //! \brief Take the elements of `other`, which is left empty
+    SmallVector(SmallVector &&other) noexcept
+        : _inline(std::move(other._inline))
+        , _heap(std::move(other._heap))
+        , _spilled(other._spilled)
+        , _begin(other._begin)
+        , _end(other._end) {
+        other.clear();
+    }
+
+    //! \brief Take the elements of `other`, which is left empty
+    SmallVector &operator=(SmallVector &&other) noexcept {
+        if (this != &other) {
+            _inline = std::move(other._inline);
+            _heap = std::move(other._heap);
+            _spilled = other._spilled;
+            _begin = other._begin;
+            _end = other._end;
+            other.clear();
+        }
+        return *this;
+    }
+
+    //! \name Elements
+    //!@{
+    size_t size() const { return _end - _begin; }
+    bool empty() const { return _begin == _end; }
+
+    const T *begin() const { return _slots() + _begin; }
+    const T *end() const { return _slots() + _end; }
+
+    const T &operator[](const size_t i) const { return _slots()[_begin + i]; }
+    T &operator[](const size_t i) { return _slots()[_begin + i]; }
+
+    const T &front() const { return (*this)[0]; }
+    T &front() { return (*this)[0]; }
+    const T &back() const { return (*this)[size() - 1]; }
+    T &back() { return (*this)[size() - 1]; }
+    //!@}
+
+    //! \brief Append an element
+    void push_back(T value) {
+        if (not _spilled) {
+            if (_end == N and _begin > 0) {
+                _compact();
+            }
+            if (_end < N) {
+                _inline[_end++] = std::move(value);
+                return;
+            }
+
+            // out of inline slots: move to the heap, with room to grow
+            _heap.reserve(2 * N);
+            for (size_t i = _begin; i < _end; i++) {
+                _heap.push_back(std::move(_inline[i]));
+                _inline[i] = T{};
+            }
+            _spilled = true;
+            _end -= _begin;
+            _begin = 0;
+        } else if (_begin > 0 and 2 * _begin >= _end) {
+            _compact();  // most slots are consumed; reclaim them rather than grow
+        }
+
+        _heap.push_back(std::move(value));
+        _end++;
+    }
+
+    //! \brief Remove the first element
+    void pop_front() {
+        if (empty()) {
+            throw std::out_of_range("SmallVector::pop_front on an empty sequence");
+        }
+        _slots()[_begin++] = T{};
+        if (_begin == _end) {
+            if (_spilled) {
+                _heap.clear();
+            }
+            _begin = _end = 0;
+        }
+    }
+
+    //! \brief Remove every element (keeping the heap's capacity, if it has any)
+    void clear() {
+        for (size_t i = 0; i < N; i++) {
+            _inline[i] = T{};
+        }
+        _heap.clear();
+        _begin = _end = 0;
+    }
+};
+
+#endif  // SPONGE_LIBSPONGE_SMALL_VECTOR_HH
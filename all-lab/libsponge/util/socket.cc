@@ -2,9 +2,11 @@
 
 #include "util.hh"
 
+#include <array>
 #include <cstddef>
 #include <stdexcept>
 #include <unistd.h>
+#include <vector>
 
 using namespace std;
 
@@ -116,13 +118,24 @@ void sendmsg_helper(const int fd_num,
                     const sockaddr *destination_address,
                     const socklen_t destination_address_len,
                     const BufferViewList &payload) {
-    auto iovecs = payload.as_iovecs();
+    // a datagram must go in one sendmsg(), so a list too long for the stack array spills to the heap
+    array<iovec, 16> stack_iovecs;
+    vector<iovec> heap_iovecs;
+    iovec *iovecs = stack_iovecs.data();
+    size_t count = 0;
+    if (payload.views() <= stack_iovecs.size()) {
+        count = payload.as_iovecs(stack_iovecs.data(), stack_iovecs.size());
+    } else {
+        heap_iovecs = payload.as_iovecs();
+        iovecs = heap_iovecs.data();
+        count = heap_iovecs.size();
+    }
 
     msghdr message{};
     message.msg_name = const_cast<sockaddr *>(destination_address);
     message.msg_namelen = destination_address_len;
-    message.msg_iov = iovecs.data();
-    message.msg_iovlen = iovecs.size();
+    message.msg_iov = iovecs;
+    message.msg_iovlen = count;
 
     const ssize_t bytes_sent = SystemCall("sendmsg", ::sendmsg(fd_num, &message, 0));
 
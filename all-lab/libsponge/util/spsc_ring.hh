@@ -0,0 +1,86 @@
+#ifndef SPONGE_LIBSPONGE_SPSC_RING_HH
+#define SPONGE_LIBSPONGE_SPSC_RING_HH
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+//! \brief A bounded, lock-free queue between exactly one producer thread and one consumer thread
+
+//! The producer alone advances `_tail` and the consumer alone advances `_head`. Each publishes its
+//! index with a release store that the other side reads with an acquire load, so the contents of a
+//! slot are visible before the index that covers it. Each side also keeps a cached copy of the other's
+//! index, and only reloads it when the cached copy says the ring is full (or empty), so in the common
+//! case push() and pop() touch no cache line the other thread writes. The two indices are kept on
+//! separate cache lines for the same reason.
+template <typename T>
+class SPSCRing {
+  private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::vector<std::optional<T>> _slots;
+    size_t _mask;  //!< `_slots.size() - 1`; the size is a power of two, so indices wrap with a mask
+
+    //! \name Consumer side
+    //!@{
+    alignas(CACHE_LINE) std::atomic<size_t> _head{0};  //!< index of the next slot to pop
+    size_t _tail_cache{0};                             //!< the consumer's last look at `_tail`
+    //!@}
+
+    //! \name Producer side
+    //!@{
+    alignas(CACHE_LINE) std::atomic<size_t> _tail{0};  //!< index of the next slot to push into
+    size_t _head_cache{0};                             //!< the producer's last look at `_head`
+    //!@}
+
+    //! The smallest power of two that is at least `n` (and at least 2)
+    static size_t _round_up(const size_t n) {
+        size_t size = 2;
+        while (size < n) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+  public:
+    //! \param[in] capacity the fewest items the ring can hold (rounded up to a power of two)
+    explicit SPSCRing(const size_t capacity) : _slots(_round_up(capacity)), _mask(_slots.size() - 1) {}
+
+    //! \brief (producer) Append `item`, unless the ring is full
+    //! \returns `false` if the ring was full, in which case `item` is left as it was
+    bool push(T &&item) {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head_cache == _slots.size()) {
+            _head_cache = _head.load(std::memory_order_acquire);
+            if (tail - _head_cache == _slots.size()) {
+                return false;
+            }
+        }
+        _slots[tail & _mask].emplace(std::move(item));
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    //! \brief (consumer) Remove the oldest item, if there is one
+    std::optional<T> pop() {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail_cache) {
+            _tail_cache = _tail.load(std::memory_order_acquire);
+            if (head == _tail_cache) {
+                return std::nullopt;
+            }
+        }
+        std::optional<T> &slot = _slots[head & _mask];
+        std::optional<T> item = std::move(slot);
+        slot.reset();
+        _head.store(head + 1, std::memory_order_release);
+        return item;
+    }
+
+    //! The most items the ring can hold
+    size_t capacity() const { return _slots.size(); }
+};
+
+#endif  // SPONGE_LIBSPONGE_SPSC_RING_HH
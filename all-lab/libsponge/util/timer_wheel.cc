@@ -0,0 +1,116 @@
+#include "timer_wheel.hh"
+
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+TimerWheel::SlotT &TimerWheel::_slot_for(const uint64_t deadline) {
+    const uint64_t delta = deadline > _now ? deadline - _now : 0;
+    size_t level = 0;
+    while (level + 1 < LEVELS && delta >= (uint64_t{1} << (SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    return _wheels[level][(deadline >> (SLOT_BITS * level)) & (SLOTS - 1)];
+}
+
+void TimerWheel::_place(SlotT &from, const SlotT::iterator it) {
+    SlotT &to = _slot_for(it->deadline);
+    to.splice(to.end(), from, it);
+    _locations.at(it->id).slot = &to;  // list iterators stay valid across a splice
+}
+
+size_t TimerWheel::_fire(SlotT &slot) {
+    // callbacks may cancel timers in this slot or schedule new ones into it; ids only grow, so the
+    // timers that were here when firing began are exactly those at the front with older ids
+    const TimerId first_new = _next_id;
+    size_t fired = 0;
+    while (not slot.empty() and slot.front().id < first_new) {
+        const Timer timer = move(slot.front());
+        slot.pop_front();
+        _locations.erase(timer.id);
+        timer.callback();
+        fired++;
+    }
+    return fired;
+}
+
+//! \param[in] deadline_ms the time (in ms, on the same clock as advance()) at which to fire
+//! \param[in] callback is called from advance() once the deadline has passed
+//! \returns a handle for cancel()
+TimerWheel::TimerId TimerWheel::schedule(const uint64_t deadline_ms, const CallbackT &callback) {
+    const TimerId id = _next_id++;
+    SlotT &slot = deadline_ms <= _now ? _due : _slot_for(deadline_ms);
+    slot.push_back({id, deadline_ms, callback});
+    _locations.emplace(id, Location{&slot, prev(slot.end())});
+    return id;
+}
+
+bool TimerWheel::cancel(const TimerId id) {
+    const auto loc = _locations.find(id);
+    if (loc == _locations.end()) {
+        return false;
+    }
+    loc->second.slot->erase(loc->second.it);
+    _locations.erase(loc);
+    return true;
+}
+
+//! \param[in] now_ms the current time; a value at or before now() only fires timers that were already due
+size_t TimerWheel::advance(const uint64_t now_ms) {
+    size_t fired = _fire(_due);
+
+    while (_now < now_ms) {
+        if (empty()) {
+            _now = now_ms;
+            break;
+        }
+        _now++;
+
+        // 高层先下沉：当前时刻恰好是某层槽的起点时，把该槽内的定时器重新分配到更低的层
+        for (size_t level = LEVELS - 1; level > 0; level--) {
+            const size_t shift = SLOT_BITS * level;
+            if ((_now & ((uint64_t{1} << shift) - 1)) != 0) {
+                continue;
+            }
+            SlotT cascading{};
+            cascading.splice(cascading.end(), _wheels[level][(_now >> shift) & (SLOTS - 1)]);
+            while (not cascading.empty()) {
+                _place(cascading, cascading.begin());
+            }
+        }
+
+        fired += _fire(_wheels[0][_now & (SLOTS - 1)]);
+    }
+
+    return fired;
+}
+
+//! \details Looks at the first non-empty slot of each level, so the cost is bounded by LEVELS * SLOTS
+//! empty-slot checks regardless of how many timers are pending.
+optional<uint64_t> TimerWheel::next_deadline() const {
+    if (empty()) {
+        return {};
+    }
+
+    optional<uint64_t> earliest{};
+    const auto consider = [&earliest](const SlotT &slot) {
+        for (const auto &timer : slot) {
+            earliest = min(earliest.value_or(timer.deadline), timer.deadline);
+        }
+    };
+
+    consider(_due);
+    for (size_t level = 0; level < LEVELS; level++) {
+        const size_t shift = SLOT_BITS * level;
+        const uint64_t current = _now >> shift;
+        for (size_t i = 1; i <= SLOTS; i++) {
+            const SlotT &slot = _wheels[level][(current + i) & (SLOTS - 1)];
+            if (not slot.empty()) {
+                consider(slot);
+                break;
+            }
+        }
+    }
+    return earliest;
+}
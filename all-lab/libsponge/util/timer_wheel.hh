@@ -0,0 +1,90 @@
+#ifndef SPONGE_LIBSPONGE_TIMER_WHEEL_HH
+#define SPONGE_LIBSPONGE_TIMER_WHEEL_HH
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <optional>
+#include <unordered_map>
+
+//! \brief A hierarchical timer wheel with millisecond resolution
+
+//! Timers are kept in LEVELS wheels of SLOTS slots each. Level 0 has one slot per
+//! millisecond; each slot of level `k` covers SLOTS^k milliseconds. A timer goes into the
+//! lowest level whose span reaches its deadline, and is moved ("cascaded") one level down
+//! each time the wheel below wraps around to it. Scheduling and canceling are O(1); advancing
+//! does O(1) work per elapsed millisecond plus the timers that fire or cascade.
+//!
+//! Time is an absolute millisecond count (e.g. timestamp_ms()) chosen by the caller; the wheel
+//! only moves forward when advance() is called.
+class TimerWheel {
+  public:
+    using TimerId = uint64_t;                     //!< Handle returned by schedule(), for cancel()
+    using CallbackT = std::function<void(void)>;  //!< Called when a timer expires
+
+  private:
+    static constexpr size_t SLOT_BITS = 6;
+    static constexpr size_t SLOTS = size_t{1} << SLOT_BITS;
+    static constexpr size_t LEVELS = 4;  //!< spans 2^24 ms (~4.6 hours); later deadlines cascade more than once
+
+    struct Timer {
+        TimerId id;
+        uint64_t deadline;
+        CallbackT callback;
+    };
+
+    using SlotT = std::list<Timer>;
+
+    //! Where a pending timer lives, so cancel() can unlink it without searching
+    struct Location {
+        SlotT *slot;
+        SlotT::iterator it;
+    };
+
+    std::array<std::array<SlotT, SLOTS>, LEVELS> _wheels{};
+    SlotT _due{};  //!< timers scheduled at or before the current time; they fire on the next advance()
+    std::unordered_map<TimerId, Location> _locations{};
+
+    uint64_t _now;          //!< the time (in ms) the wheel has advanced to
+    TimerId _next_id{1};
+
+    //! The slot that should hold a timer expiring at `deadline`
+    SlotT &_slot_for(const uint64_t deadline);
+
+    //! Move a timer into the slot for its deadline
+    void _place(SlotT &from, const SlotT::iterator it);
+
+    //! Take the timers out of `slot` and run their callbacks; returns how many fired
+    size_t _fire(SlotT &slot);
+
+  public:
+    //! \param[in] now_ms the current time, in milliseconds
+    explicit TimerWheel(const uint64_t now_ms = 0) : _now(now_ms) {}
+
+    //! \brief Call `callback` once the wheel has advanced to `deadline_ms`
+    //! \details A deadline that has already passed fires on the next call to advance().
+    TimerId schedule(const uint64_t deadline_ms, const CallbackT &callback);
+
+    //! \brief Remove a pending timer
+    //! \returns `false` if the timer has already fired or been canceled
+    bool cancel(const TimerId id);
+
+    //! \brief Move the wheel forward to `now_ms`, running the callbacks of every timer that expires
+    //! \details Callbacks may schedule or cancel timers. Timers are fired in deadline order.
+    //! \returns the number of timers that fired
+    size_t advance(const uint64_t now_ms);
+
+    //! \brief The earliest pending deadline, if any timer is pending
+    std::optional<uint64_t> next_deadline() const;
+
+    //! \name Accessors
+    //!@{
+    uint64_t now() const { return _now; }
+    size_t size() const { return _locations.size(); }
+    bool empty() const { return _locations.empty(); }
+    //!@}
+};
+
+#endif  // SPONGE_LIBSPONGE_TIMER_WHEEL_HH
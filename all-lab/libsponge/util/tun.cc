@@ -7,6 +7,7 @@
 #include <linux/if.h>
 #include <linux/if_tun.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 
 static constexpr const char *CLONEDEV = "/dev/net/tun";
 
@@ -33,4 +34,17 @@ TunTapFD::TunTapFD(const string &devname, const bool is_tun)
     tun_req.ifr_name[IFNAMSIZ - 1] = '\0';
 
     SystemCall("ioctl", ioctl(fd_num(), TUNSETIFF, static_cast<void *>(&tun_req)));
+    _devname = static_cast<const char *>(tun_req.ifr_name);
+}
+
+//! \details The MTU is read with SIOCGIFMTU, which needs a socket rather than the TUN/TAP descriptor itself.
+size_t TunTapFD::mtu() const {
+    const FileDescriptor sock{SystemCall("socket", socket(AF_INET, SOCK_DGRAM, 0))};
+    struct ifreq mtu_req {};
+
+    strncpy(static_cast<char *>(mtu_req.ifr_name), _devname.data(), IFNAMSIZ - 1);
+    mtu_req.ifr_name[IFNAMSIZ - 1] = '\0';
+
+    SystemCall("ioctl", ioctl(sock.fd_num(), SIOCGIFMTU, static_cast<void *>(&mtu_req)));
+    return static_cast<size_t>(mtu_req.ifr_mtu);
 }
@@ -55,12 +55,27 @@ uint64_t timestamp_ms();
 class InternetChecksum {
   private:
     uint32_t _sum;
-    bool _parity{};
+    bool _parity{};  //!< has an odd number of bytes been added, so the next byte is the low half of a word?
 
   public:
     InternetChecksum(const uint32_t initial_sum = 0);
+
+    //! \brief Add `data` to the sum, continuing from where the last add() left off (even mid-word)
+    //! \details Sums eight bytes at a time, or 16 or 32 with SSE2 or AVX2 where the CPU has them.
     void add(std::string_view data);
+
     uint16_t value() const;
+
+    //! \brief Update a checksum for a change to one 16-bit word of the data it covers, without the rest of the data
+    //! \details Uses RFC 1624 eqn. 3, `HC' = ~(~HC + ~m + m')`, which (unlike the
+    //! RFC 1141 method) never produces a negative zero.
+    //! \param[in] checksum the checksum before the change
+    //! \param[in] old_word the word before the change, in host byte order (e.g. `ttl << 8 | proto`)
+    //! \param[in] new_word the word after the change
+    static uint16_t update(const uint16_t checksum, const uint16_t old_word, const uint16_t new_word);
+
+    //! \brief update() for a 32-bit field (e.g. an address), as its two 16-bit words
+    static uint16_t update32(const uint16_t checksum, const uint32_t old_value, const uint32_t new_value);
 };
 
 //! Hexdump the contents of a packet (or any other sequence of bytes)
@@ -0,0 +1,22 @@
+#include "alloc_counter.hh"
+
+#include <cstdlib>
+#include <new>
+
+size_t allocations = 0;
+size_t frees = 0;
+
+void *operator new(size_t size) {
+    allocations++;
+    if (void *ptr = malloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    frees += ptr != nullptr;
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept { operator delete(ptr); }
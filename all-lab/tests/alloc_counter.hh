@@ -0,0 +1,15 @@
+#ifndef SPONGE_TESTS_ALLOC_COUNTER_HH
+#define SPONGE_TESTS_ALLOC_COUNTER_HH
+
+#include <cstddef>
+
+//! \name Allocation counting
+//! A test linked with the alloc_counter library gets its replacements of the global operator new/delete, so
+//! every allocation in the process is counted, and the test can count what a piece of code allocates (or
+//! frees) by reading a counter before and after it.
+//!@{
+extern size_t allocations;  //!< calls to operator new
+extern size_t frees;        //!< calls to operator delete with a non-null pointer
+//!@}
+
+#endif  // SPONGE_TESTS_ALLOC_COUNTER_HH
@@ -0,0 +1,125 @@
+#include "alloc_counter.hh"
+#include "buffer.hh"
+#include "small_vector.hh"
+#include "socket.hh"
+#include "test_err_if.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // a SmallVector used as a queue behaves as a std::deque does, inline or spilled, however it is consumed
+        {
+            SmallVector<size_t, 4> small;
+            deque<size_t> reference;
+            size_t next = 0;
+            for (size_t i = 0; i < 100000; i++) {
+                const size_t bound = i < 50000 ? 6 : 100;  // hover around the inline size, then grow well past it
+                if (reference.size() < bound and (reference.empty() or rd() % 2 == 0)) {
+                    small.push_back(next);
+                    reference.push_back(next++);
+                } else {
+                    small.pop_front();
+                    reference.pop_front();
+                }
+                test_err_if(small.size() != reference.size(), "size differs from a deque's");
+                test_err_if(not small.empty() and (small.front() != reference.front() or
+                                                   small.back() != reference.back()),
+                            "front or back differs from a deque's");
+            }
+            test_err_if(not equal(small.begin(), small.end(), reference.begin(), reference.end()),
+                        "elements differ from a deque's");
+
+            SmallVector<size_t, 4> moved = move(small);
+            test_err_if(not small.empty() or moved.size() != reference.size(), "a move did not take everything");
+            small.push_back(7);
+            test_err_if(small.size() != 1 or small.front() != 7, "a moved-from SmallVector is not usable");
+        }
+
+        // sizes are kept up to date through appends and removals, and match the bytes
+        {
+            BufferList list;
+            string whole;
+            for (size_t i = 0; i < 200; i++) {
+                if (whole.empty() or rd() % 3 != 0) {
+                    const string piece(rd() % 50, static_cast<char>('a' + i % 26));
+                    list.append(BufferList(string(piece)));
+                    whole += piece;
+                } else {
+                    const size_t n = rd() % (whole.size() + 1);
+                    list.remove_prefix(n);
+                    whole.erase(0, n);
+                }
+                test_err_if(list.size() != whole.size() or list.concatenate() != whole,
+                            "a BufferList's size or contents went wrong");
+
+                BufferViewList views{list};
+                const size_t n = rd() % (whole.size() + 1);
+                views.remove_prefix(n);
+                test_err_if(views.size() != whole.size() - n, "a BufferViewList's size went wrong");
+            }
+        }
+
+        // as_iovecs() fills a caller's array, and leaves out what does not fit
+        {
+            BufferViewList views{"header"};
+            views.append("");
+            views.append("payload");
+            views.append("trailer");
+            array<iovec, 2> iovecs{};
+            test_err_if(views.views() != 3 or views.as_iovecs(iovecs.data(), iovecs.size()) != 2,
+                        "as_iovecs() did not stop at the end of the array");
+            test_err_if(string_view(static_cast<const char *>(iovecs[1].iov_base), iovecs[1].iov_len) != "payload",
+                        "as_iovecs() wrote the wrong views");
+        }
+
+        // a packet's worth of buffers and views, and sending it, cost no allocations
+        {
+            const Buffer header{string(40, 'h')};
+            const Buffer payload{string(1460, 'p')};
+            UDPSocket a, b;
+            a.bind(Address("127.0.0.1", 0));
+            b.bind(Address("127.0.0.1", 0));
+            a.connect(b.local_address());
+            const Address destination = b.local_address();
+
+            const size_t before = allocations;
+            BufferList packet{header};
+            packet.append(payload);
+            BufferViewList views{packet};
+            a.send(views);
+            a.sendto(destination, views);
+            a.write(views);
+            const size_t made = allocations - before;
+            test_err_if(made != 0, "building and sending a packet allocated " + to_string(made) + " time(s)");
+            test_err_if(packet.size() != 1500 or views.size() != 1500, "a packet has the wrong size");
+
+            // and so does a batch of them, once the fd has written one batch and kept its scratch space
+            const vector<BufferViewList> batch(FileDescriptor::PACKET_BATCH, views);
+            a.write_packets(batch);
+            const size_t before_batch = allocations;
+            a.write_packets(batch);
+            const size_t made_batch = allocations - before_batch;
+            test_err_if(made_batch != 0, "writing a batch of packets allocated " + to_string(made_batch) + " time(s)");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+#include "alloc_counter.hh"
+#include "buffer.hh"
+#include "test_err_if.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+int main() {
+    try {
+        // storage counts atomically unless made while its thread is confined, however deeply
+        {
+            test_err_if(not BufferRef::make("a").get()->atomic(), "storage on an unconfined thread is not atomic");
+            {
+                const BufferStorage::ThreadConfined outer;
+                {
+                    const BufferStorage::ThreadConfined inner;
+                    test_err_if(BufferRef::make("b")->atomic(), "storage on a confined thread is atomic");
+                }
+                test_err_if(BufferRef::make("c")->atomic(), "the inner ThreadConfined ended the outer one");
+
+                bool other_atomic = false;
+                thread([&other_atomic] { other_atomic = BufferRef::make("d")->atomic(); }).join();
+                test_err_if(not other_atomic, "confining one thread confined another");
+            }
+            test_err_if(not BufferRef::make("e")->atomic(), "storage is not atomic once the confinement ends");
+        }
+
+        // copies of a Buffer share one storage, which goes with the last of them, atomic or not
+        for (const bool confine : {false, true}) {
+            optional<BufferStorage::ThreadConfined> confined;
+            if (confine) {
+                confined.emplace();
+            }
+
+            Buffer buffer{string(100, 'x')};
+            {
+                const vector<Buffer> copies(10, buffer);
+                Buffer tail = buffer;
+                tail.remove_prefix(90);
+                test_err_if(tail.str() != string(10, 'x'), "remove_prefix() on a copy is wrong");
+                test_err_if(buffer.size() != 100, "remove_prefix() on a copy changed the original");
+            }
+
+            // (each test_err_if() message is a string of its own, so count before checking)
+            Buffer view = buffer;
+            const size_t before = frees;
+            buffer = Buffer{};
+            const size_t freed_early = frees - before;
+            view.remove_prefix(view.size());
+            const size_t freed = frees - before;
+            test_err_if(freed_early != 0, "the storage was freed while a Buffer still had it");
+            test_err_if(freed != 2, "the storage (and its string) was not freed with the last Buffer");
+        }
+
+        // an atomic count stays right through references taken and dropped on many threads at once
+        {
+            const BufferRef ref = BufferRef::make(string(100, 'y'));
+            vector<thread> threads;
+            for (size_t t = 0; t < 4; t++) {
+                threads.emplace_back([&ref] {
+                    for (size_t i = 0; i < 200000; i++) {
+                        BufferRef copy = ref;
+                        copy.reset();
+                    }
+                });
+            }
+            for (auto &t : threads) {
+                t.join();
+            }
+            test_err_if(ref->use_count() != 1, "racing references left a count of " + to_string(ref->use_count()));
+            test_err_if(static_cast<bool>(BufferRef{}), "an empty BufferRef is not empty");
+        }
+
+        // confined storage may move to another thread between uses, e.g. at a thread's start and join
+        {
+            Buffer buffer;
+            {
+                const BufferStorage::ThreadConfined confined;
+                buffer = Buffer{string(100, 'z')};
+            }
+            Buffer returned;
+            thread([&] {
+                Buffer copy = buffer;
+                returned = copy;
+            }).join();
+            test_err_if(returned.str() != string(100, 'z'), "confined storage changed on another thread");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
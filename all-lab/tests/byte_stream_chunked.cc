@@ -0,0 +1,179 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static constexpr auto CHUNKED = ByteStream::Storage::Chunked;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            ByteStreamTestHarness test{"chunked write-pop-write", 8, CHUNKED};
+
+            test.execute(Write{"abcdef"}.with_bytes_written(6));
+            test.execute(Pop{4});
+            test.execute(Write{"ghijkl"}.with_bytes_written(6));
+
+            test.execute(BufferSize{8});
+            test.execute(RemainingCapacity{0});
+            test.execute(Peek{"efghijkl"});
+            test.execute(PeekViews{"efghijkl"});
+            test.execute(PeekBuffers{"efghijkl"}.with_buffers(2));
+
+            // a partial read across the two chunks takes the rest of one and a slice of the next
+            test.execute(PeekBuffers{"efg"}.with_buffers(2));
+            test.execute(ReadBuffers{"efg"}.with_buffers(2));
+            test.execute(BufferSize{5});
+            test.execute(BytesRead{7});
+            test.execute(PeekBuffers{"hijkl"}.with_buffers(1));
+
+            // and one within a chunk leaves the rest of it behind
+            test.execute(ReadBuffer{"hi"});
+            test.execute(Peek{"jkl"});
+            test.execute(PeekViews{"jkl"});
+            test.execute(Write{"mnopqrstu"}.with_bytes_written(5));
+            test.execute(PeekBuffers{"jklmnopq"}.with_buffers(2));
+            test.execute(BytesWritten{17});
+            test.execute(BytesRead{9});
+        }
+
+        {
+            ByteStreamTestHarness test{"chunked buffers", 12, CHUNKED};
+
+            test.execute(WriteBuffer{"hello"}.with_bytes_written(5));
+            test.execute(WriteBuffer{"world"}.as_owned_string().with_bytes_written(5));
+            test.execute(WriteBuffer{"!!!"}.with_bytes_written(2));  // only the first two fit
+            test.execute(WriteBuffer{"?"}.as_owned_string().with_bytes_written(0));
+
+            test.execute(BufferSize{12});
+            test.execute(RemainingCapacity{0});
+            test.execute(PeekBuffers{"helloworld!!"}.with_buffers(3));
+            test.execute(PeekViews{"helloworld!!"});
+
+            test.execute(ReadBuffers{"hellowo"}.with_buffers(2));
+            test.execute(PeekBuffers{"rld!!"}.with_buffers(2));
+            test.execute(ReadBuffer{"rl"});
+            test.execute(ReadBuffer{"d!!"});  // across two chunks: a copy
+            test.execute(BufferEmpty{true});
+            test.execute(ReadBuffers{""}.with_buffers(0));
+
+            // nothing of the part of "!!!" that did not fit is left behind to be read
+            test.execute(WriteBuffer{"abc"}.with_bytes_written(3));
+            test.execute(PeekBuffers{"abc"}.with_buffers(1));
+            test.execute(Pop{3});
+
+            test.execute(EndInput{});
+            test.execute(WriteBuffer{"late"}.with_bytes_written(0));
+            test.execute(Eof{true});
+            test.execute(BytesWritten{15});
+            test.execute(BytesRead{15});
+        }
+
+        {
+            ByteStreamTestHarness test{"ring buffers", 8};
+
+            test.execute(WriteBuffer{"abcdef"}.with_bytes_written(6));
+            test.execute(Pop{4});
+            test.execute(WriteBuffer{"ghijkl"}.as_owned_string().with_bytes_written(6));
+            test.execute(PeekBuffers{"efghijkl"}.with_buffers(1));  // the ring copies into one Buffer
+            test.execute(ReadBuffers{"efghi"}.with_buffers(1));
+            test.execute(ReadBuffer{"jkl"});
+            test.execute(BufferEmpty{true});
+        }
+
+        {
+            ByteStreamTestHarness test{"chunked zero-capacity", 0, CHUNKED};
+
+            test.execute(Write{"abc"}.with_bytes_written(0));
+            test.execute(WriteBuffer{"abc"}.with_bytes_written(0));
+            test.execute(RemainingCapacity{0});
+            test.execute(PeekBuffers{""}.with_buffers(0));
+            test.execute(Pop{1});
+            test.execute(BytesRead{0});
+        }
+
+        // random writes (of each kind) and reads (of each kind) see the bytes in order, through many chunks
+        {
+            const size_t CAPACITY = 150;  // small enough that writes are often cut short
+            ByteStreamTestHarness test{"chunked many writes and reads", CAPACITY, CHUNKED};
+
+            string unread;
+            size_t written = 0;
+            size_t read = 0;
+            for (size_t i = 0; i < 2000; ++i) {
+                string d(rd() % 100, 0);
+                generate(d.begin(), d.end(), [&] { return 'a' + (rd() % 26); });
+                const size_t accepted = min(d.size(), CAPACITY - unread.size());
+                switch (rd() % 3) {
+                    case 0:
+                        test.execute(Write{d}.with_bytes_written(accepted));
+                        break;
+                    case 1:
+                        test.execute(WriteBuffer{d}.with_bytes_written(accepted));
+                        break;
+                    default:
+                        test.execute(WriteBuffer{d}.as_owned_string().with_bytes_written(accepted));
+                }
+                unread += d.substr(0, accepted);
+                written += accepted;
+
+                const string expected = unread.substr(0, rd() % (unread.size() + 1));
+                test.execute(PeekBuffers{expected});
+                switch (rd() % 3) {
+                    case 0:
+                        test.execute(ReadBuffers{expected});
+                        break;
+                    case 1:
+                        test.execute(ReadBuffer{expected});
+                        break;
+                    default:
+                        test.execute(Peek{expected});
+                        test.execute(Pop{expected.size()});
+                }
+                unread.erase(0, expected.size());
+                read += expected.size();
+
+                test.execute(BufferSize{unread.size()});
+                test.execute(BytesWritten{written});
+                test.execute(BytesRead{read});
+                test.execute(PeekViews{unread});
+            }
+        }
+
+        // what is written as a Buffer comes back out as slices of the same storage, not copies
+        {
+            ByteStream stream{100, CHUNKED};
+            const Buffer written{string(50, 'x')};
+            stream.write(written);
+            stream.write(Buffer{string(50, 'y')});
+            const auto in_written = [&written](const Buffer &buffer) {
+                return buffer.str().data() >= written.str().data() and
+                       buffer.str().data() + buffer.size() <= written.str().data() + written.size();
+            };
+
+            if (not in_written(stream.peek_output_buffers(10).buffers().front())) {
+                throw runtime_error("peek_output_buffers() copied a chunk");
+            }
+            if (not in_written(stream.read_buffer(20))) {
+                throw runtime_error("read_buffer() copied a slice of one chunk");
+            }
+            if (not in_written(stream.read_buffers(60).buffers().front())) {
+                throw runtime_error("read_buffers() copied a chunk");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -45,11 +45,14 @@ void ByteStreamAction::execute(ByteStream &) const {}
 
 ByteStreamAction::~ByteStreamAction() {}
 
-ByteStreamTestHarness::ByteStreamTestHarness(const std::string &test_name, const size_t capacity)
-    : _test_name(test_name), _byte_stream(capacity) {
+ByteStreamTestHarness::ByteStreamTestHarness(const std::string &test_name,
+                                             const size_t capacity,
+                                             const ByteStream::Storage storage)
+    : _test_name(test_name), _byte_stream(capacity, storage) {
     std::ostringstream ss;
     ss << "Initialized with ("
-       << "capacity=" << capacity << ")";
+       << "capacity=" << capacity << ", storage=" << (storage == ByteStream::Storage::Ring ? "ring" : "chunked")
+       << ")";
     _steps_executed.emplace_back(ss.str());
 }
 
@@ -97,6 +100,26 @@ void Write::execute(ByteStream &bs) const {
     }
 }
 
+// WriteBuffer
+WriteBuffer::WriteBuffer(const std::string &data) : _data(data) {}
+WriteBuffer &WriteBuffer::as_owned_string() {
+    _owned = true;
+    return *this;
+}
+WriteBuffer &WriteBuffer::with_bytes_written(const size_t bytes_written) {
+    _bytes_written = bytes_written;
+    return *this;
+}
+std::string WriteBuffer::description() const {
+    return "write \"" + _data + "\" to the stream as " + (_owned ? "an owned string" : "a Buffer");
+}
+void WriteBuffer::execute(ByteStream &bs) const {
+    auto bytes_written = _owned ? bs.write(std::string(_data)) : bs.write(Buffer(std::string(_data)));
+    if (_bytes_written and bytes_written != _bytes_written.value()) {
+        throw ByteStreamExpectationViolation::property("bytes_written", _bytes_written.value(), bytes_written);
+    }
+}
+
 // Pop
 Pop::Pop(const size_t len) : _len(len) {}
 std::string Pop::description() const { return "pop " + to_string(_len); }
@@ -182,3 +205,68 @@ void Peek::execute(ByteStream &bs) const {
                                              output + "\"");
     }
 }
+
+// PeekViews
+PeekViews::PeekViews(const std::string &output) : _output(output) {}
+std::string PeekViews::description() const { return "\"" + _output + "\" viewed at the front of the stream"; }
+void PeekViews::execute(ByteStream &bs) const {
+    std::string output;
+    for (const auto &iov : bs.peek_output_views(_output.size()).as_iovecs()) {
+        output.append(static_cast<const char *>(iov.iov_base), iov.iov_len);
+    }
+    if (output != _output) {
+        throw ByteStreamExpectationViolation("Expected \"" + _output +
+                                             "\" viewed at the front of the stream, but found \"" + output + "\"");
+    }
+}
+
+// PeekBuffers
+PeekBuffers::PeekBuffers(const std::string &output) : _output(output) {}
+PeekBuffers &PeekBuffers::with_buffers(const size_t buffers) {
+    _buffers = buffers;
+    return *this;
+}
+std::string PeekBuffers::description() const {
+    return "\"" + _output + "\" as Buffers at the front of the stream";
+}
+void PeekBuffers::execute(ByteStream &bs) const {
+    const BufferList buffers = bs.peek_output_buffers(_output.size());
+    const std::string output = buffers.concatenate();
+    if (output != _output) {
+        throw ByteStreamExpectationViolation("Expected \"" + _output +
+                                             "\" as Buffers at the front of the stream, but found \"" + output + "\"");
+    }
+    if (_buffers and buffers.buffers().size() != _buffers.value()) {
+        throw ByteStreamExpectationViolation::property("peeked buffers", _buffers.value(), buffers.buffers().size());
+    }
+}
+
+// ReadBuffers
+ReadBuffers::ReadBuffers(const std::string &output) : _output(output) {}
+ReadBuffers &ReadBuffers::with_buffers(const size_t buffers) {
+    _buffers = buffers;
+    return *this;
+}
+std::string ReadBuffers::description() const { return "read_buffers " + to_string(_output.size()); }
+void ReadBuffers::execute(ByteStream &bs) const {
+    const BufferList buffers = bs.read_buffers(_output.size());
+    const std::string output = buffers.concatenate();
+    if (output != _output) {
+        throw ByteStreamExpectationViolation("Expected to read \"" + _output + "\" as Buffers, but read \"" + output +
+                                             "\"");
+    }
+    if (_buffers and buffers.buffers().size() != _buffers.value()) {
+        throw ByteStreamExpectationViolation::property("read buffers", _buffers.value(), buffers.buffers().size());
+    }
+}
+
+// ReadBuffer
+ReadBuffer::ReadBuffer(const std::string &output) : _output(output) {}
+std::string ReadBuffer::description() const { return "read_buffer " + to_string(_output.size()); }
+void ReadBuffer::execute(ByteStream &bs) const {
+    const std::string output{bs.read_buffer(_output.size()).str()};
+    if (output != _output) {
+        throw ByteStreamExpectationViolation("Expected to read \"" + _output + "\" as one Buffer, but read \"" +
+                                             output + "\"");
+    }
+}
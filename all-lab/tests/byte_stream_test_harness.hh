@@ -56,6 +56,18 @@ struct Write : public ByteStreamAction {
     void execute(ByteStream &) const override;
 };
 
+struct WriteBuffer : public ByteStreamAction {
+    std::string _data;
+    bool _owned{false};
+    std::optional<size_t> _bytes_written{};
+
+    WriteBuffer(const std::string &data);
+    WriteBuffer &as_owned_string();
+    WriteBuffer &with_bytes_written(const size_t bytes_written);
+    std::string description() const override;
+    void execute(ByteStream &) const override;
+};
+
 struct Pop : public ByteStreamAction {
     size_t _len;
 
@@ -128,13 +140,51 @@ struct Peek : public ByteStreamExpectation {
     void execute(ByteStream &) const override;
 };
 
+struct PeekViews : public ByteStreamExpectation {
+    std::string _output;
+
+    PeekViews(const std::string &output);
+    std::string description() const override;
+    void execute(ByteStream &) const override;
+};
+
+struct PeekBuffers : public ByteStreamExpectation {
+    std::string _output;
+    std::optional<size_t> _buffers{};
+
+    PeekBuffers(const std::string &output);
+    PeekBuffers &with_buffers(const size_t buffers);
+    std::string description() const override;
+    void execute(ByteStream &) const override;
+};
+
+struct ReadBuffers : public ByteStreamAction {
+    std::string _output;
+    std::optional<size_t> _buffers{};
+
+    ReadBuffers(const std::string &output);
+    ReadBuffers &with_buffers(const size_t buffers);
+    std::string description() const override;
+    void execute(ByteStream &) const override;
+};
+
+struct ReadBuffer : public ByteStreamAction {
+    std::string _output;
+
+    ReadBuffer(const std::string &output);
+    std::string description() const override;
+    void execute(ByteStream &) const override;
+};
+
 class ByteStreamTestHarness {
     std::string _test_name;
     ByteStream _byte_stream;
     std::vector<std::string> _steps_executed{};
 
   public:
-    ByteStreamTestHarness(const std::string &test_name, const size_t capacity);
+    ByteStreamTestHarness(const std::string &test_name,
+                          const size_t capacity,
+                          const ByteStream::Storage storage = ByteStream::Storage::Ring);
 
     void execute(const ByteStreamTestStep &step);
 };
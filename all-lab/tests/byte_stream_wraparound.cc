@@ -0,0 +1,75 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main() {
+    try {
+        {
+            ByteStreamTestHarness test{"write-pop-write-wrap", 8};
+
+            test.execute(Write{"abcdef"}.with_bytes_written(6));
+            test.execute(Pop{4});
+            test.execute(Write{"ghijkl"}.with_bytes_written(6));
+
+            test.execute(BufferSize{8});
+            test.execute(RemainingCapacity{0});
+            test.execute(Peek{"efghijkl"});
+            test.execute(PeekViews{"efghijkl"});
+            test.execute(PeekViews{"efg"});
+
+            test.execute(Pop{5});
+
+            test.execute(BufferSize{3});
+            test.execute(BytesRead{9});
+            test.execute(Peek{"jkl"});
+            test.execute(PeekViews{"jkl"});
+        }
+
+        {
+            ByteStreamTestHarness test{"repeated-wrap", 5};
+
+            for (size_t i = 0; i < 10; i++) {
+                test.execute(Write{"xyz"}.with_bytes_written(3));
+                test.execute(Write{"12"}.with_bytes_written(2));
+                test.execute(Write{"!"}.with_bytes_written(0));
+                test.execute(PeekViews{"xyz12"});
+                test.execute(Pop{3});
+                test.execute(Peek{"12"});
+                test.execute(Pop{2});
+                test.execute(BufferEmpty{true});
+                test.execute(BytesWritten{5 * (i + 1)});
+                test.execute(BytesRead{5 * (i + 1)});
+            }
+
+            test.execute(Write{"abcd"}.with_bytes_written(4));
+            test.execute(Pop{3});
+            test.execute(Write{"efgh"}.with_bytes_written(4));
+            test.execute(Peek{"defgh"});
+            test.execute(PeekViews{"defgh"});
+
+            test.execute(EndInput{});
+            test.execute(Pop{5});
+            test.execute(Eof{true});
+            test.execute(PeekViews{""});
+        }
+
+        {
+            ByteStreamTestHarness test{"zero-capacity", 0};
+
+            test.execute(Write{"abc"}.with_bytes_written(0));
+            test.execute(RemainingCapacity{0});
+            test.execute(PeekViews{""});
+            test.execute(Pop{1});
+            test.execute(BytesRead{0});
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,161 @@
+#include "eventloop.hh"
+#include "file_descriptor.hh"
+#include "test_err_if.hh"
+#include "util.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <utility>
+
+using namespace std;
+using Backend = EventLoop::Backend;
+using Result = EventLoop::Result;
+
+static pair<FileDescriptor, FileDescriptor> socket_pair() {
+    int fds[2];
+    SystemCall("socketpair", ::socketpair(AF_UNIX, SOCK_STREAM, 0, static_cast<int *>(fds)));
+    return {FileDescriptor(fds[0]), FileDescriptor(fds[1])};
+}
+
+static string name(const Backend backend) {
+    switch (backend) {
+        case Backend::Poll:
+            return "poll";
+        case Backend::Epoll:
+            return "epoll";
+        case Backend::EpollEdge:
+            return "epoll (edge-triggered)";
+        case Backend::IoUring:
+            return "io_uring";
+    }
+    return "?";
+}
+
+static void check_backend(const Backend backend) {
+    const string prefix = name(backend) + ": ";
+
+    // interest gates delivery, and the rule is canceled at EOF
+    {
+        EventLoop loop{backend};
+        auto ab = socket_pair();
+        FileDescriptor &a = ab.first, &b = ab.second;
+        bool interested = false, canceled = false;
+        string received;
+        loop.add_rule(
+            b, Direction::In, [&] { received += b.read(); }, [&] { return interested; }, [&] { canceled = true; });
+
+        // an idle rule on a second socket keeps the loop from exiting
+        auto cd = socket_pair();
+        FileDescriptor &d = cd.second;
+        loop.add_rule(d, Direction::In, [&] { d.read(); });
+
+        a.write("hello");
+        test_err_if(loop.wait_next_event(10) != Result::Timeout, prefix + "an uninterested rule was triggered");
+        test_err_if(not received.empty(), prefix + "an uninterested rule's callback ran");
+
+        interested = true;
+        test_err_if(loop.wait_next_event(1000) != Result::Success, prefix + "a readable fd was not reported");
+        test_err_if(received != "hello", prefix + "wrong data: " + received);
+
+        a.close();
+        test_err_if(loop.wait_next_event(1000) != Result::Success, prefix + "a hangup was not reported");
+        test_err_if(not b.eof(), prefix + "EOF was not read");
+        loop.wait_next_event(0);
+        test_err_if(not canceled, prefix + "the rule was not canceled at EOF");
+
+        // with the rule gone, its fd is no longer reported
+        test_err_if(loop.wait_next_event(10) != Result::Timeout, prefix + "a canceled rule was polled");
+    }
+
+    // one fd, one rule per direction
+    {
+        EventLoop loop{backend};
+        auto ab = socket_pair();
+        FileDescriptor &a = ab.first, &b = ab.second;
+        bool written = false;
+        string received;
+        loop.add_rule(b, Direction::In, [&] { received += b.read(); });
+        loop.add_rule(
+            b,
+            Direction::Out,
+            [&] {
+                b.write("pong");
+                written = true;
+            },
+            [&] { return not written; });
+        a.write("ping");
+        for (size_t i = 0; i < 5 and (not written or received.empty()); i++) {
+            loop.wait_next_event(1000);
+        }
+        test_err_if(received != "ping", prefix + "the In rule sharing an fd was not triggered");
+        test_err_if(not written, prefix + "the Out rule sharing an fd was not triggered");
+        test_err_if(a.read() != "pong", prefix + "the write did not arrive");
+    }
+
+    // the loop sleeps exactly until a timer is due
+    {
+        EventLoop loop{backend};
+        auto ab = socket_pair();
+        FileDescriptor &b = ab.second;
+        loop.add_rule(b, Direction::In, [&] { b.read(); });
+        bool fired = false;
+        const uint64_t start = timestamp_ms();
+        loop.timers().schedule(start + 20, [&] { fired = true; });
+        test_err_if(loop.wait_next_event(-1) != Result::Timeout, prefix + "the wait did not end at the timer");
+        test_err_if(not fired, prefix + "the timer did not fire");
+        test_err_if(timestamp_ms() - start < 20, prefix + "the wait ended before the timer was due");
+    }
+
+    if (backend != Backend::Epoll and backend != Backend::EpollEdge) {
+        return;
+    }
+
+    {
+        EventLoop loop{backend};
+        auto ab = socket_pair();
+        FileDescriptor &b = ab.second;
+        loop.add_rule(b, Direction::In, [&] { b.read(); });
+        bool threw = false;
+        try {
+            loop.add_rule(b, Direction::In, [&] { b.read(); });
+        } catch (const runtime_error &) {
+            threw = true;
+        }
+        test_err_if(not threw, prefix + "a second rule for the same fd and direction was accepted");
+    }
+
+    // a callback that leaves data behind is only called again on the next edge
+    if (backend == Backend::EpollEdge) {
+        EventLoop loop{backend};
+        auto ab = socket_pair();
+        FileDescriptor &a = ab.first, &b = ab.second;
+        size_t calls = 0;
+        loop.add_rule(b, Direction::In, [&] {
+            b.read(1);
+            calls++;
+        });
+        a.write("abc");
+        loop.wait_next_event(1000);
+        test_err_if(loop.wait_next_event(10) != Result::Timeout, prefix + "unread data was reported twice");
+        a.write("d");
+        test_err_if(loop.wait_next_event(1000) != Result::Success, prefix + "new data was not reported");
+        test_err_if(calls != 2, prefix + "wrong number of callbacks");
+    }
+}
+
+int main() {
+    try {
+        for (const auto backend : {Backend::Poll, Backend::Epoll, Backend::EpollEdge, Backend::IoUring}) {
+            check_backend(EventLoop{backend}.backend());
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
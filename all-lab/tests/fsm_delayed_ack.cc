@@ -0,0 +1,86 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using State = TCPTestHarness::State;
+
+static constexpr uint16_t DELAY = 40;
+
+//! the peer sends `size` bytes starting at `seqno`
+static void send_payload(TCPTestHarness &test, const WrappingInt32 seqno, const WrappingInt32 ackno, const size_t size) {
+    test.execute(SendSegment{}
+                     .with_ack(true)
+                     .with_ackno(ackno)
+                     .with_seqno(seqno)
+                     .with_payload_size(size)
+                     .with_data(string(size, 'x'))
+                     .with_win(1000));
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        TCPConfig cfg{};
+        cfg.delayed_ack = DELAY;
+
+        const WrappingInt32 tx_isn(rd());
+        const WrappingInt32 rx_isn(rd());
+        TCPTestHarness test = TCPTestHarness::in_established(cfg, tx_isn, rx_isn);
+        const WrappingInt32 base = rx_isn + 1;
+
+        // every second in-order segment is acknowledged at once
+        send_payload(test, base, tx_isn + 1, 100);
+        test.execute(ExpectNoSegment{}, "the first in-order segment was acknowledged immediately");
+        send_payload(test, base + 100, tx_isn + 1, 100);
+        test.execute(ExpectOneSegment{}.with_ack(true).with_ackno(base + 200).with_payload_size(0),
+                     "the second in-order segment was not acknowledged");
+
+        // a lone segment waits for the timer
+        send_payload(test, base + 200, tx_isn + 1, 100);
+        test.execute(Tick(DELAY - 1));
+        test.execute(ExpectNoSegment{}, "the ACK was sent before the delayed ACK timer expired");
+        test.execute(Tick(1));
+        test.execute(ExpectOneSegment{}.with_ack(true).with_ackno(base + 300).with_payload_size(0),
+                     "the delayed ACK timer did not send an ACK");
+        test.execute(Tick(10 * DELAY));
+        test.execute(ExpectNoSegment{}, "the delayed ACK was sent twice");
+
+        // out-of-order data, and the segment that fills the hole, are acknowledged at once
+        send_payload(test, base + 400, tx_isn + 1, 100);
+        test.execute(ExpectOneSegment{}.with_ack(true).with_ackno(base + 300),
+                     "out-of-order data was not acknowledged immediately");
+        send_payload(test, base + 300, tx_isn + 1, 100);
+        test.execute(ExpectOneSegment{}.with_ack(true).with_ackno(base + 500),
+                     "the segment filling a hole was not acknowledged immediately");
+
+        // outgoing data carries the pending ACK
+        send_payload(test, base + 500, tx_isn + 1, 100);
+        test.execute(Write{"hello"});
+        test.execute(ExpectOneSegment{}.with_ack(true).with_ackno(base + 600).with_data("hello"),
+                     "outgoing data did not carry the pending ACK");
+        test.execute(Tick(DELAY));
+        test.execute(ExpectNoSegment{}, "a piggybacked ACK was sent again by the timer");
+
+        // FIN is never delayed
+        send_payload(test, base + 600, tx_isn + 6, 100);
+        test.send_fin(base + 700, tx_isn + 6);
+        test.execute(ExpectOneSegment{}.with_ack(true).with_ackno(base + 701),
+                     "FIN was not acknowledged immediately");
+        test.execute(ExpectState{State::CLOSE_WAIT});
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,96 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "test_err_if.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+using State = TCPTestHarness::State;
+
+static constexpr uint16_t OUR_MSS = 800;
+
+//! listen, accept `syn`, and check that the SYN/ACK offers OUR_MSS
+static WrappingInt32 accept(TCPTestHarness &test, const WrappingInt32 seq_base, const SendSegment &syn) {
+    test.execute(Listen{});
+    test.execute(syn);
+    TCPSegment syn_ack = test.expect_seg(ExpectOneSegment{}.with_syn(true).with_ack(true).with_ackno(seq_base + 1),
+                                         "no SYN/ACK");
+    test_err_if(syn_ack.header().mss != optional<uint16_t>{OUR_MSS}, "SYN/ACK did not offer the configured MSS");
+    return syn_ack.header().seqno;
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        TCPConfig cfg{};
+        cfg.mss = OUR_MSS;
+
+        // test 1: the peer's smaller MSS limits our segments
+        {
+            TCPTestHarness test_1(cfg);
+            const WrappingInt32 seq_base(rd());
+            const WrappingInt32 ack_base = accept(
+                test_1, seq_base, SendSegment{}.with_syn(true).with_seqno(seq_base).with_win(8000).with_mss(600));
+            test_1.send_ack(seq_base + 1, ack_base + 1, 8000);
+            test_1.execute(ExpectState{State::ESTABLISHED});
+
+            test_1.execute(Write{string(1500, 'x')});
+            test_1.execute(ExpectSegment{}.with_seqno(ack_base + 1).with_payload_size(600));
+            test_1.execute(ExpectSegment{}.with_seqno(ack_base + 601).with_payload_size(600));
+            test_1.execute(ExpectSegment{}.with_seqno(ack_base + 1201).with_payload_size(300));
+            test_1.execute(ExpectNoSegment{});
+        }
+
+        // test 2: without an MSS option from the peer, the configured MSS is used
+        {
+            TCPTestHarness test_2(cfg);
+            const WrappingInt32 seq_base(rd());
+            const WrappingInt32 ack_base =
+                accept(test_2, seq_base, SendSegment{}.with_syn(true).with_seqno(seq_base).with_win(8000));
+            test_2.send_ack(seq_base + 1, ack_base + 1, 8000);
+
+            test_2.execute(Write{string(1500, 'x')});
+            test_2.execute(ExpectSegment{}.with_payload_size(OUR_MSS));
+            test_2.execute(ExpectSegment{}.with_payload_size(1500 - OUR_MSS));
+            test_2.execute(ExpectNoSegment{});
+        }
+
+        // test 3: the timestamps option comes out of the payload
+        {
+            TCPConfig ts_cfg = cfg;
+            ts_cfg.timestamps = true;
+            TCPTestHarness test_3(ts_cfg);
+            const WrappingInt32 seq_base(rd());
+            const WrappingInt32 ack_base = accept(
+                test_3,
+                seq_base,
+                SendSegment{}.with_syn(true).with_seqno(seq_base).with_win(8000).with_mss(1460).with_timestamps(1, 0));
+            test_3.execute(SendSegment{}
+                               .with_ack(true)
+                               .with_seqno(seq_base + 1)
+                               .with_ackno(ack_base + 1)
+                               .with_win(8000)
+                               .with_timestamps(2, 0));
+
+            test_3.execute(Write{string(1000, 'x')});
+            test_3.execute(ExpectSegment{}.with_payload_size(OUR_MSS - TCPHeader::TIMESTAMPS_LENGTH));
+            test_3.execute(ExpectSegment{}.with_payload_size(1000 - OUR_MSS + TCPHeader::TIMESTAMPS_LENGTH));
+            test_3.execute(ExpectNoSegment{});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -27,8 +27,10 @@ int main() {
         auto rd = get_random_generator();
 
         // buffer a bunch of bytes, make sure we can empty and re-fill before calling close()
-        for (unsigned rep_no = 0; rep_no < NREPS; ++rep_no) {
-            StreamReassembler buf{MAX_SEG_LEN * NSEGS};
+        // (alternating between the two reassembler engines)
+        for (unsigned rep_no = 0; rep_no < 2 * NREPS; ++rep_no) {
+            const auto engine = rep_no % 2 ? StreamReassembler::Engine::Map : StreamReassembler::Engine::Ring;
+            StreamReassembler buf{MAX_SEG_LEN * NSEGS, engine};
 
             vector<tuple<size_t, size_t>> seq_size;
             size_t offset = 0;
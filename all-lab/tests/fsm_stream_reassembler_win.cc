@@ -26,9 +26,10 @@ int main() {
     try {
         auto rd = get_random_generator();
 
-        // overlapping segments
-        for (unsigned rep_no = 0; rep_no < NREPS; ++rep_no) {
-            StreamReassembler buf{NSEGS * MAX_SEG_LEN};
+        // overlapping segments (alternating between the two reassembler engines)
+        for (unsigned rep_no = 0; rep_no < 2 * NREPS; ++rep_no) {
+            const auto engine = rep_no % 2 ? StreamReassembler::Engine::Map : StreamReassembler::Engine::Ring;
+            StreamReassembler buf{NSEGS * MAX_SEG_LEN, engine};
 
             vector<tuple<size_t, size_t>> seq_size;
             size_t offset = 0;
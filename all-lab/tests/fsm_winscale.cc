@@ -0,0 +1,121 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "test_err_if.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+using State = TCPTestHarness::State;
+
+static constexpr size_t CAPACITY = 1 << 20;
+static constexpr uint8_t CAPACITY_SHIFT = 5;  // 1 MiB >> 5 is the first shift that fits in 16 bits
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        TCPConfig cfg{};
+        cfg.recv_capacity = CAPACITY;
+        cfg.send_capacity = CAPACITY;
+        cfg.window_scaling = true;
+        cfg.timestamps = true;
+
+        // test 1: both sides offer RFC 7323 options, so windows beyond 64 KiB are usable
+        {
+            TCPTestHarness test_1(cfg);
+            const WrappingInt32 seq_base(rd());
+
+            test_1.execute(Listen{});
+            test_1.execute(
+                SendSegment{}.with_syn(true).with_seqno(seq_base).with_win(0xffff).with_window_scale(7).with_timestamps(
+                    1000, 0));
+
+            // the window in a SYN is never scaled
+            TCPSegment syn_ack = test_1.expect_seg(
+                ExpectOneSegment{}.with_syn(true).with_ack(true).with_ackno(seq_base + 1).with_win(0xffff),
+                "test 1 failed: no SYN/ACK");
+            test_err_if(syn_ack.header().window_scale != optional<uint8_t>{CAPACITY_SHIFT},
+                        "test 1 failed: SYN/ACK did not carry the expected window scale");
+            test_err_if(!syn_ack.header().has_timestamps || syn_ack.header().tsecr != 1000,
+                        "test 1 failed: SYN/ACK did not echo the peer's timestamp");
+            const WrappingInt32 ack_base = syn_ack.header().seqno;
+
+            // a window of 1000 << 7 = 128000 bytes
+            test_1.execute(SendSegment{}
+                               .with_ack(true)
+                               .with_seqno(seq_base + 1)
+                               .with_ackno(ack_base + 1)
+                               .with_win(1000)
+                               .with_timestamps(1010, syn_ack.header().tsval));
+            test_1.execute(ExpectState{State::ESTABLISHED});
+
+            test_1.execute(Write{string(70000, 'x')}.with_bytes_written(70000));
+            test_1.execute(Tick(1));
+            test_1.execute(ExpectBytesInFlight{70000});
+
+            TCPSegment data = test_1.expect_seg(
+                ExpectSegment{}.with_ack(true).with_seqno(ack_base + 1).with_win(CAPACITY >> CAPACITY_SHIFT),
+                "test 1 failed: data segment carries the wrong window");
+            test_err_if(data.header().window_scale.has_value(), "test 1 failed: window scale sent outside a SYN");
+            test_err_if(!data.header().has_timestamps || data.header().tsecr != 1010,
+                        "test 1 failed: data segment did not echo the latest timestamp");
+        }
+
+        // test 2: the peer offers neither option, so neither is used
+        {
+            TCPTestHarness test_2(cfg);
+            const WrappingInt32 seq_base(rd());
+
+            test_2.execute(Listen{});
+            test_2.send_syn(seq_base);
+            TCPSegment syn_ack = test_2.expect_seg(
+                ExpectOneSegment{}.with_syn(true).with_ack(true).with_ackno(seq_base + 1).with_win(0xffff),
+                "test 2 failed: no SYN/ACK");
+            test_err_if(syn_ack.header().window_scale.has_value() || syn_ack.header().has_timestamps,
+                        "test 2 failed: SYN/ACK carried options the peer did not offer");
+
+            test_2.send_ack(seq_base + 1, syn_ack.header().seqno + 1, 1000);
+            test_2.execute(ExpectState{State::ESTABLISHED});
+            test_2.execute(Write{string(70000, 'x')}.with_bytes_written(70000));
+            test_2.execute(Tick(1));
+            test_2.execute(ExpectBytesInFlight{1000});
+            test_2.execute(ExpectSegment{}.with_ack(true).with_win(0xffff).with_payload_size(1000));
+        }
+
+        // test 3: active open offers both options and drops them when the SYN/ACK does not agree
+        {
+            TCPTestHarness test_3(cfg);
+
+            test_3.execute(Connect{});
+            test_3.execute(Tick(1));
+            TCPSegment syn = test_3.expect_seg(ExpectOneSegment{}.with_syn(true).with_ack(false),
+                                               "test 3 failed: no SYN");
+            test_err_if(syn.header().window_scale != optional<uint8_t>{CAPACITY_SHIFT},
+                        "test 3 failed: SYN did not offer window scaling");
+            test_err_if(!syn.header().has_timestamps || syn.header().tsecr != 0,
+                        "test 3 failed: SYN did not offer timestamps");
+
+            const WrappingInt32 isn(rd());
+            test_3.send_syn(isn, syn.header().seqno + 1);
+            test_3.execute(ExpectState{State::ESTABLISHED});
+            TCPSegment ack =
+                test_3.expect_seg(ExpectOneSegment{}.with_ack(true).with_ackno(isn + 1).with_win(0xffff),
+                                  "test 3 failed: no ACK of the SYN/ACK");
+            test_err_if(ack.header().has_timestamps, "test 3 failed: timestamps used without agreement");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
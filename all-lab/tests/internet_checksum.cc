@@ -0,0 +1,117 @@
+#include "ipv4_datagram.hh"
+#include "test_err_if.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+//! The checksum one byte at a time, as RFC 1071 defines it
+static uint16_t reference_checksum(const uint32_t initial_sum, const string_view data) {
+    uint64_t sum = initial_sum;
+    for (size_t i = 0; i < data.size(); i++) {
+        const uint64_t byte = uint8_t(data[i]);
+        sum += i % 2 == 0 ? byte << 8 : byte;
+    }
+    while (sum > 0xffff) {
+        sum = (sum >> 16) + (sum & 0xffff);
+    }
+    return static_cast<uint16_t>(~sum);
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        uniform_int_distribution<int> byte{0, 255};
+
+        // any data, in any number of pieces of any length, at any alignment, gives the byte-at-a-time result
+        for (size_t n = 0; n < 2000; n++) {
+            const size_t len = uniform_int_distribution<size_t>{0, n < 1000 ? 100u : 70000u}(rd);
+            const size_t offset = uniform_int_distribution<size_t>{0, 31}(rd);
+            string storage(offset + len, '\0');
+            for (auto &c : storage) {
+                c = static_cast<char>(byte(rd));
+            }
+            const string_view data{storage.data() + offset, len};
+            const uint32_t initial = n % 3 == 0 ? 0 : uniform_int_distribution<uint32_t>{}(rd);
+
+            InternetChecksum check{initial};
+            for (size_t done = 0; done < len;) {
+                const size_t piece = min(len - done, uniform_int_distribution<size_t>{0, len / 3 + 1}(rd));
+                check.add(data.substr(done, piece));
+                done += piece;
+            }
+            test_err_if(check.value() != reference_checksum(initial, data),
+                        "checksum of " + to_string(len) + " bytes at offset " + to_string(offset) + " is wrong");
+        }
+
+        // lots of 0xff, where a sum that overflows or folds wrong would show
+        {
+            const string ones(1 << 20, '\xff');
+            InternetChecksum check{0xffffffff};
+            check.add(ones);
+            check.add(ones.substr(1));
+            test_err_if(check.value() != reference_checksum(0xffffffff, ones + ones.substr(1)), "all-ones is wrong");
+        }
+
+        // an incremental update matches recomputing, for 16- and 32-bit fields
+        for (size_t n = 0; n < 10000; n++) {
+            string data(20, '\0');
+            for (auto &c : data) {
+                c = static_cast<char>(byte(rd));
+            }
+            const uint16_t before = reference_checksum(0, data);
+
+            const size_t at = 2 * uniform_int_distribution<size_t>{0, 8}(rd);
+            const auto word_at = [&data](const size_t i) {
+                return static_cast<uint16_t>(uint8_t(data[i]) << 8 | uint8_t(data[i + 1]));
+            };
+            const uint32_t old_value = uint32_t{word_at(at)} << 16 | word_at(at + 2);
+            const uint32_t new_value = n % 2 == 0 ? (old_value & 0xffff) | uint32_t(byte(rd)) << 24
+                                                  : uniform_int_distribution<uint32_t>{}(rd);
+            for (size_t i = 0; i < 4; i++) {
+                data[at + i] = static_cast<char>(new_value >> (24 - 8 * i));
+            }
+            const uint16_t after = reference_checksum(0, data);
+
+            const uint16_t updated = InternetChecksum::update32(before, old_value, new_value);
+            test_err_if(updated != after,
+                        "update32 gave " + to_string(updated) + ", recomputing gave " + to_string(after));
+            test_err_if(InternetChecksum::update(InternetChecksum::update(before, old_value >> 16, new_value >> 16),
+                                                 old_value & 0xffff,
+                                                 new_value & 0xffff) != after,
+                        "two update()s differ from recomputing");
+        }
+
+        // a forwarded datagram goes out with its TTL decremented and a checksum that needed no recomputing
+        for (size_t n = 0; n < 1000; n++) {
+            IPv4Datagram original;
+            original.header().ttl = uniform_int_distribution<uint8_t>{2, 255}(rd);
+            original.header().id = uniform_int_distribution<uint16_t>{}(rd);
+            original.header().src = uniform_int_distribution<uint32_t>{}(rd);
+            original.header().dst = uniform_int_distribution<uint32_t>{}(rd);
+            original.payload() = string(n % 50, 'x');
+            original.header().len = IPv4Header::LENGTH + original.payload().size();
+
+            IPv4Datagram forwarded;
+            test_err_if(forwarded.parse(original.serialize().concatenate()) != ParseResult::NoError,
+                        "a datagram did not parse");
+            forwarded.decrement_ttl();
+            const string bytes = forwarded.serialize().concatenate();
+            test_err_if(reference_checksum(0, string_view(bytes).substr(0, IPv4Header::LENGTH)) != 0,
+                        "a forwarded datagram's checksum is wrong");
+            test_err_if(uint8_t(bytes[8]) != original.header().ttl - 1, "the TTL was not decremented");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,64 @@
+#include "buffer.hh"
+#include "file_descriptor.hh"
+#include "io_uring.hh"
+#include "socket.hh"
+#include "test_err_if.hh"
+#include "util.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int main() {
+    try {
+        cerr << "io_uring is " << (IoUring::available() ? "" : "not ") << "available\n";
+
+        // a pair of connected UDP sockets on the loopback interface
+        UDPSocket a, b;
+        a.bind(Address("127.0.0.1", 0));
+        b.bind(Address("127.0.0.1", 0));
+        a.connect(b.local_address());
+        b.connect(a.local_address());
+        a.set_blocking(false);
+        b.set_blocking(false);
+
+        vector<string> packets;
+        test_err_if(b.read_packets(packets) != 0 or not packets.empty(), "packets were read from an empty fd");
+
+        // a batch of packets, some of them gathered from several pieces, arrives whole and in order
+        const size_t n = 2 * FileDescriptor::PACKET_BATCH + 3;
+        vector<string> sent;
+        vector<BufferViewList> out;
+        for (size_t i = 0; i < n; i++) {
+            sent.push_back("packet " + to_string(i) + string(i * 37, 'x'));
+        }
+        for (const auto &packet : sent) {
+            BufferViewList pieces{string_view(packet).substr(0, 3)};
+            pieces.append(string_view(packet).substr(3));
+            out.push_back(pieces);
+        }
+        test_err_if(a.write_packets(out) != n, "not every packet was written");
+
+        for (size_t reads = 0; packets.size() < n and reads < 10; reads++) {
+            const size_t count = b.read_packets(packets);
+            test_err_if(count > FileDescriptor::PACKET_BATCH, "read_packets() read more than one batch");
+        }
+        test_err_if(packets != sent, "the packets read differ from the packets written");
+        test_err_if(b.read_packets(packets) != 0, "a packet was read twice");
+
+        // the largest packet fits
+        const string big(FileDescriptor::MAX_PACKET / 2, 'y');
+        test_err_if(a.write_packets({BufferViewList{big}}) != 1, "a large packet was not written");
+        packets.clear();
+        test_err_if(b.read_packets(packets) != 1 or packets.front() != big, "a large packet was not read back");
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
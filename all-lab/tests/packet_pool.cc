@@ -0,0 +1,175 @@
+#include "alloc_counter.hh"
+#include "arp_message.hh"
+#include "ethernet_frame.hh"
+#include "four_tuple.hh"
+#include "network_interface.hh"
+#include "packet_pool.hh"
+#include "socket.hh"
+#include "tcp_over_ip.hh"
+#include "tcp_segment.hh"
+#include "test_err_if.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+static bool throws(const function<void()> &f) {
+    try {
+        f();
+    } catch (const runtime_error &) {
+        return true;
+    }
+    return false;
+}
+
+int main() {
+    try {
+        // headers prepend into the headroom and data appends into the tailroom, up to the slab's edges
+        {
+            PacketPool pool{16, 64};
+            PacketBuffer packet = pool.acquire();
+            test_err_if(packet.size() != 0 or packet.headroom() != 16 or packet.tailroom() != 48,
+                        "a new packet is not empty at the pool's headroom");
+            packet.append("payload");
+            packet.prepend(4)[0] = 'h';
+            test_err_if(packet.str().substr(0, 1) != "h" or packet.str().substr(4) != "payload",
+                        "prepend() and append() put the bytes in the wrong places");
+            test_err_if(packet.buffer().str() != packet.str(), "buffer() differs from the packet");
+            test_err_if(not throws([&] { packet.prepend(13); }), "prepend() overran the headroom");
+            test_err_if(not throws([&] { packet.append(42); }), "append() overran the tailroom");
+            test_err_if(packet.size() != 11, "a refused prepend() or append() changed the packet");
+        }
+
+        // a slab is reused only once every packet and Buffer made from it is gone, whichever thread drops it
+        {
+            PacketPool pool;
+            Buffer kept;
+            {
+                PacketBuffer packet = pool.acquire();
+                packet.append("kept");
+                kept = packet.buffer();
+            }
+            PacketBuffer other = pool.acquire();
+            test_err_if(pool.size() != 2, "a slab still in use was handed out again");
+            other.append("overwrite");
+            test_err_if(kept.str() != "kept", "a Buffer's bytes changed under it");
+
+            string seen;
+            thread([&seen, moved = move(kept)] { seen = moved.copy(); }).join();  // the last Buffer dies there
+            test_err_if(seen != "kept", "a Buffer changed on its way to another thread");
+            other = PacketBuffer{};
+            for (size_t i = 0; i < 10; i++) {
+                pool.acquire();
+            }
+            test_err_if(pool.size() != 2, "free slabs were not reused; the pool grew to " + to_string(pool.size()));
+        }
+
+        const Address local{"10.0.0.1", 4321};
+        const Address remote{"10.0.0.2", 80};
+        const FourTuple tuple = FourTuple::from_addresses(local, remote);
+        TCPSegment seg;
+        seg.header().ack = true;
+        seg.header().has_timestamps = true;
+        seg.header().doff = (TCPHeader::LENGTH + seg.header().options_length()) / 4;
+        seg.payload() = string(1460, 'x');
+
+        // the datagram built in place is the one wrap_tcp_in_ip() builds, and then the frame send_datagram() does
+        PacketPool pool;
+        const EthernetAddress local_eth{1, 2, 3, 4, 5, 6};
+        const EthernetAddress remote_eth{7, 8, 9, 10, 11, 12};
+        NetworkInterface interface{local_eth, local};
+        {
+            PacketBuffer packet = TCPOverIPv4Adapter::wrap_tcp_in_ip(seg, tuple, pool);
+            test_err_if(packet.str() != TCPOverIPv4Adapter::wrap_tcp_in_ip(seg, tuple).serialize().concatenate(),
+                        "the datagram built in place differs from wrap_tcp_in_ip()");
+
+            // the next hop is unknown: the datagram waits for ARP, and the caller has nothing to send
+            test_err_if(interface.send_datagram(packet, remote), "a frame was made for an unresolved next hop");
+            test_err_if(interface.frames_out().size() != 1 or
+                            interface.frames_out().front().header().type != EthernetHeader::TYPE_ARP,
+                        "an unresolved next hop did not send one ARP request");
+            interface.frames_out().pop();
+
+            ARPMessage reply;
+            reply.opcode = ARPMessage::OPCODE_REPLY;
+            reply.sender_ethernet_address = remote_eth;
+            reply.sender_ip_address = remote.ipv4_numeric();
+            reply.target_ethernet_address = local_eth;
+            reply.target_ip_address = local.ipv4_numeric();
+            EthernetFrame reply_frame;
+            reply_frame.header() = {local_eth, remote_eth, EthernetHeader::TYPE_ARP};
+            reply_frame.payload() = reply.serialize();
+            interface.recv_frame(reply_frame);
+            test_err_if(interface.frames_out().size() != 1, "the waiting datagram was not sent once ARP resolved");
+            const string queued = interface.frames_out().front().serialize().concatenate();
+            interface.frames_out().pop();
+
+            // the next hop is known: the Ethernet header goes in front of the datagram, in place
+            PacketBuffer frame = TCPOverIPv4Adapter::wrap_tcp_in_ip(seg, tuple, pool);
+            test_err_if(not interface.send_datagram(frame, remote), "no frame was made for a resolved next hop");
+            test_err_if(frame.str() != queued, "the frame built in place differs from the one send_datagram() queued");
+            test_err_if(not interface.frames_out().empty(), "a frame built in place was queued as well");
+        }
+
+        // once the pool has grown, building and dropping frames allocates nothing
+        {
+            for (size_t i = 0; i < 100; i++) {
+                PacketBuffer frame = TCPOverIPv4Adapter::wrap_tcp_in_ip(seg, tuple, pool);
+                interface.send_datagram(frame, remote);
+            }
+            const size_t slabs = pool.size();
+            const size_t before = allocations;
+            for (size_t i = 0; i < 10000; i++) {
+                PacketBuffer frame = TCPOverIPv4Adapter::wrap_tcp_in_ip(seg, tuple, pool);
+                interface.send_datagram(frame, remote);
+            }
+            const size_t made = allocations - before;
+            test_err_if(made != 0, "10000 frames allocated " + to_string(made) + " time(s)");
+            test_err_if(pool.size() != slabs, "the pool grew from " + to_string(slabs) + " to " +
+                                                  to_string(pool.size()) + " slabs in the steady state");
+        }
+
+        // packets read from an fd land in pooled packets, and (once warm) cost no allocations either
+        {
+            UDPSocket a, b;
+            a.bind(Address("127.0.0.1", 0));
+            b.bind(Address("127.0.0.1", 0));
+            a.connect(b.local_address());
+            b.set_blocking(false);
+
+            PacketPool read_pool;
+            vector<PacketBuffer> packets;
+            packets.reserve(FileDescriptor::PACKET_BATCH);
+            for (size_t round = 0; round < 100; round++) {
+                for (size_t i = 0; i < 3; i++) {
+                    a.write("packet " + to_string(round) + "." + to_string(i));
+                }
+                packets.clear();
+                const size_t before = allocations;
+                const size_t count = b.read_packets(read_pool, packets);
+                const size_t made = allocations - before;
+                test_err_if(round >= 10 and made != 0, "reading packets allocated " + to_string(made) + " time(s)");
+                test_err_if(count != 3 or packets.size() != 3, "read " + to_string(count) + " packets, not 3");
+                for (size_t i = 0; i < 3; i++) {
+                    test_err_if(packets[i].str() != "packet " + to_string(round) + "." + to_string(i),
+                                "a packet was read wrong");
+                    test_err_if(packets[i].headroom() != PacketPool::DEFAULT_HEADROOM,
+                                "a packet was not read in after the headroom");
+                }
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
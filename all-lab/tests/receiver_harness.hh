@@ -13,6 +13,8 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 struct ReceiverTestStep {
     virtual std::string to_string() const { return "ReceiverTestStep"; }
@@ -167,6 +169,39 @@ struct ExpectBytes : public ReceiverExpectation {
     }
 };
 
+struct ExpectSackBlocks : public ReceiverExpectation {
+    std::vector<std::pair<uint32_t, uint32_t>> _blocks;
+
+    ExpectSackBlocks(std::vector<std::pair<uint32_t, uint32_t>> blocks) : _blocks(std::move(blocks)) {}
+    std::string description() const {
+        std::ostringstream ss;
+        ss << "SACK blocks";
+        for (const auto &[left, right] : _blocks) {
+            ss << " [" << left << ", " << right << ")";
+        }
+        if (_blocks.empty()) {
+            ss << " (none)";
+        }
+        return ss.str();
+    }
+
+    void execute(TCPReceiver &receiver) const {
+        std::vector<std::pair<uint32_t, uint32_t>> actual;
+        for (const auto &[left, right] : receiver.sack_blocks(TCPHeader::MAX_SACK_BLOCKS)) {
+            actual.emplace_back(left.raw_value(), right.raw_value());
+        }
+        if (actual != _blocks) {
+            std::ostringstream ss;
+            ss << "The TCPReceiver reported SACK blocks";
+            for (const auto &[left, right] : actual) {
+                ss << " [" << left << ", " << right << ")";
+            }
+            ss << ", but expected " << description();
+            throw ReceiverExpectationViolation(ss.str());
+        }
+    }
+};
+
 struct ReceiverAction : public ReceiverTestStep {
     std::string to_string() const { return "Action:      " + description(); }
     virtual std::string description() const { return "description missing"; }
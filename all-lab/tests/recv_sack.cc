@@ -0,0 +1,60 @@
+#include "receiver_harness.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // out-of-order data is reported, most recent block first
+        {
+            uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{4000};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectSackBlocks{{}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 11).with_data("abcd"));
+            test.execute(ExpectSackBlocks{{{isn + 11, isn + 15}}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 21).with_data("ef"));
+            test.execute(ExpectSackBlocks{{{isn + 21, isn + 23}, {isn + 11, isn + 15}}});
+            // adjacent data merges into one block, which is now the most recent
+            test.execute(SegmentArrives{}.with_seqno(isn + 15).with_data("wxyz"));
+            test.execute(ExpectSackBlocks{{{isn + 11, isn + 19}, {isn + 21, isn + 23}}});
+            test.execute(ExpectUnassembledBytes{10});
+            // filling the first hole assembles the first block
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("0123456789"));
+            test.execute(ExpectAckno{WrappingInt32{isn + 19}});
+            test.execute(ExpectSackBlocks{{{isn + 21, isn + 23}}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 19).with_data("gh"));
+            test.execute(ExpectAckno{WrappingInt32{isn + 23}});
+            test.execute(ExpectSackBlocks{{}});
+        }
+
+        // no more than MAX_SACK_BLOCKS are reported
+        {
+            uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{4000};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            for (uint32_t i = 1; i <= 5; i++) {
+                test.execute(SegmentArrives{}.with_seqno(isn + 1 + 10 * i).with_data("abc"));
+            }
+            test.execute(ExpectSackBlocks{
+                {{isn + 51, isn + 54}, {isn + 11, isn + 14}, {isn + 21, isn + 24}, {isn + 31, isn + 34}}});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
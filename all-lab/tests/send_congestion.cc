@@ -0,0 +1,113 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        const size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+        const size_t IW = 10 * MSS;
+
+        for (const auto algorithm : {TCPConfig::CongestionControl::Reno, TCPConfig::CongestionControl::Cubic}) {
+            const string name = algorithm == TCPConfig::CongestionControl::Reno ? "Reno" : "CUBIC";
+
+            {
+                TCPConfig cfg;
+                WrappingInt32 isn(rd());
+                cfg.fixed_isn = isn;
+                cfg.congestion_control = algorithm;
+
+                TCPSenderTestHarness test{name + ": initial window limits the first flight", cfg};
+                test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+                test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+                test.execute(ExpectCongestionWindow{IW});
+                test.execute(WriteBytes{string(3 * IW, 'x')});
+                for (size_t i = 0; i < IW / MSS; i++) {
+                    test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + uint32_t(i * MSS)));
+                }
+                test.execute(ExpectNoSegment{});
+                test.execute(ExpectBytesInFlight{IW});
+            }
+
+            {
+                TCPConfig cfg;
+                WrappingInt32 isn(rd());
+                cfg.fixed_isn = isn;
+                cfg.congestion_control = algorithm;
+
+                TCPSenderTestHarness test{name + ": slow start grows by at most two segments per ACK", cfg};
+                test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+                test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+                test.execute(WriteBytes{string(3 * IW, 'x')});
+                for (size_t i = 0; i < IW / MSS; i++) {
+                    test.execute(ExpectSegment{}.with_payload_size(MSS));
+                }
+                // one segment acknowledged: the window slides by one and grows by one
+                test.execute(AckReceived{WrappingInt32{isn + 1 + uint32_t(MSS)}}.with_win(60000));
+                test.execute(ExpectCongestionWindow{IW + MSS});
+                test.execute(ExpectSegment{}.with_payload_size(MSS));
+                test.execute(ExpectSegment{}.with_payload_size(MSS));
+                test.execute(ExpectNoSegment{});
+                // four segments acknowledged at once: growth is capped at two
+                test.execute(AckReceived{WrappingInt32{isn + 1 + uint32_t(5 * MSS)}}.with_win(60000));
+                test.execute(ExpectCongestionWindow{IW + 3 * MSS});
+                test.execute(ExpectBytesInFlight{IW + 3 * MSS});
+            }
+
+            {
+                TCPConfig cfg;
+                WrappingInt32 isn(rd());
+                cfg.fixed_isn = isn;
+                cfg.congestion_control = algorithm;
+
+                TCPSenderTestHarness test{name + ": timeout collapses the window to one segment", cfg};
+                test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+                test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+                test.execute(WriteBytes{string(3 * IW, 'x')});
+                for (size_t i = 0; i < IW / MSS; i++) {
+                    test.execute(ExpectSegment{}.with_payload_size(MSS));
+                }
+                test.execute(Tick{cfg.rt_timeout});
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1));
+                test.execute(ExpectNoSegment{});
+                test.execute(ExpectCongestionWindow{MSS});
+                // everything acknowledged: only one (slow start grown) window may follow
+                test.execute(AckReceived{WrappingInt32{isn + 1 + uint32_t(IW)}}.with_win(60000));
+                test.execute(ExpectCongestionWindow{3 * MSS});
+                for (size_t i = 0; i < 3; i++) {
+                    test.execute(ExpectSegment{}.with_payload_size(MSS));
+                }
+                test.execute(ExpectNoSegment{});
+            }
+
+            {
+                TCPConfig cfg;
+                WrappingInt32 isn(rd());
+                cfg.fixed_isn = isn;
+                cfg.congestion_control = algorithm;
+
+                TCPSenderTestHarness test{name + ": receiver window still applies", cfg};
+                test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+                test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1500));
+                test.execute(WriteBytes{string(3 * IW, 'x')});
+                test.execute(ExpectSegment{}.with_payload_size(MSS));
+                test.execute(ExpectSegment{}.with_payload_size(500));
+                test.execute(ExpectNoSegment{});
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,143 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+static constexpr uint16_t WIN = 60000;
+
+//! connect, then fill the 10-segment initial window
+static void send_initial_window(TCPSenderTestHarness &test, const WrappingInt32 isn) {
+    test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+    test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+    test.execute(WriteBytes{string(30 * MSS, 'x')});
+    for (size_t i = 0; i < 10; i++) {
+        test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + uint32_t(i * MSS)));
+    }
+    test.execute(ExpectNoSegment{});
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+            TCPSenderTestHarness test{"NewReno: third duplicate ACK triggers fast retransmit", cfg};
+            send_initial_window(test, isn);
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+            // ssthresh = flight / 2, inflated by the three segments that left the network
+            test.execute(ExpectCongestionWindow{5 * MSS + 3 * MSS});
+
+            // each further duplicate inflates cwnd by one segment
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + uint32_t(10 * MSS)));
+            test.execute(ExpectNoSegment{});
+
+            // a partial ACK resends the next hole at once and stays in recovery
+            test.execute(AckReceived{WrappingInt32{isn + 1 + uint32_t(5 * MSS)}}.with_win(WIN));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + uint32_t(5 * MSS)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + uint32_t(11 * MSS)));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectCongestionWindow{7 * MSS});
+
+            // the full ACK ends recovery without allowing a burst
+            test.execute(AckReceived{WrappingInt32{isn + 1 + uint32_t(12 * MSS)}}.with_win(WIN));
+            test.execute(ExpectCongestionWindow{2 * MSS});
+            test.execute(ExpectSegment{}.with_payload_size(MSS));
+            test.execute(ExpectSegment{}.with_payload_size(MSS));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = TCPConfig::CongestionControl::Reno;
+
+            TCPSenderTestHarness test{"Reno: a partial ACK ends recovery", cfg};
+            send_initial_window(test, isn);
+            for (size_t i = 0; i < TCPConfig::DUP_ACK_THRESHOLD; i++) {
+                test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            }
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1 + uint32_t(5 * MSS)}}.with_win(WIN));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectCongestionWindow{5 * MSS});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = TCPConfig::CongestionControl::Cubic;
+
+            TCPSenderTestHarness test{"CUBIC: fast retransmit reduces by beta", cfg};
+            send_initial_window(test, isn);
+            for (size_t i = 0; i < TCPConfig::DUP_ACK_THRESHOLD; i++) {
+                test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            }
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectCongestionWindow{7 * MSS + 3 * MSS});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+            TCPSenderTestHarness test{"Window updates are not duplicate ACKs", cfg};
+            send_initial_window(test, isn);
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN - 1));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN - 2));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN - 3));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"No fast retransmit without congestion control", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(4 * MSS));
+            test.execute(WriteBytes{string(4 * MSS, 'x')});
+            for (size_t i = 0; i < 4; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS));
+            }
+            for (size_t i = 0; i < 2 * TCPConfig::DUP_ACK_THRESHOLD; i++) {
+                test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(4 * MSS));
+            }
+            test.execute(ExpectNoSegment{});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static constexpr uint32_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+static constexpr uint16_t WIN = 60000;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.nagle = true;
+
+            TCPSenderTestHarness test{"Nagle: small writes wait for the outstanding data to be acknowledged", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(WriteBytes{"a"});
+            test.execute(ExpectSegment{}.with_data("a").with_seqno(isn + 1));
+            test.execute(WriteBytes{"b"});
+            test.execute(WriteBytes{"c"});
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 2}}.with_win(WIN));
+            test.execute(ExpectSegment{}.with_data("bc").with_seqno(isn + 2));
+            test.execute(ExpectNoSegment{});
+
+            // full segments are never held back, only the partial one behind them
+            test.execute(WriteBytes{string(MSS + 10, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 4));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 4 + MSS}}.with_win(WIN));
+            test.execute(ExpectSegment{}.with_payload_size(10).with_seqno(isn + 4 + MSS));
+            test.execute(ExpectNoSegment{});
+
+            // the timer sends held data anyway
+            test.execute(WriteBytes{"z"});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{cfg.cork_timeout - 1u});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("z").with_seqno(isn + 14 + MSS));
+
+            // the end of the stream is not held back
+            test.execute(WriteBytes{"end"}.with_end_input(true));
+            test.execute(ExpectSegment{}.with_data("end").with_fin(true));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"Cork: partial segments wait for uncork", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(Cork{});
+            test.execute(WriteBytes{"ab"});
+            test.execute(WriteBytes{"cd"});
+            test.execute(ExpectNoSegment{});
+            test.execute(Cork{false});
+            test.execute(ExpectSegment{}.with_data("abcd").with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+
+            test.execute(Cork{});
+            test.execute(WriteBytes{string(2 * MSS + 5, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 5));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 5 + MSS));
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{cfg.cork_timeout});
+            test.execute(ExpectSegment{}.with_payload_size(5).with_seqno(isn + 5 + 2 * MSS));
+
+            test.execute(WriteBytes{"fin"});
+            test.execute(ExpectNoSegment{});
+            test.execute(Close{});
+            test.execute(ExpectSegment{}.with_data("fin").with_fin(true));
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
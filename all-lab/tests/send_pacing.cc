@@ -0,0 +1,75 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static constexpr uint32_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+static constexpr uint16_t WIN = 60000;
+static constexpr size_t RTT = 100;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+            cfg.pacing = true;
+
+            TCPSenderTestHarness test{"Pacing spreads the initial window across the RTT", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{RTT});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+
+            // slow start paces at 2 * cwnd / SRTT = 2 * 10 MSS / 100 ms, i.e. one segment every 5 ms,
+            // after a first burst of two segments
+            test.execute(WriteBytes{string(10 * MSS, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + MSS));
+            test.execute(ExpectNoSegment{});
+            for (uint32_t i = 2; i < 10; i++) {
+                test.execute(Tick{4});
+                test.execute(ExpectNoSegment{});
+                test.execute(Tick{1});
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + i * MSS));
+                test.execute(ExpectNoSegment{});
+            }
+            test.execute(ExpectBytesInFlight{10 * MSS});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.pacing = true;
+
+            // without congestion control the timeout leaves the window alone, so only pacing could hold data back
+            TCPSenderTestHarness test{"Pacing waits for an RTT sample", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(WriteBytes{string(10 * MSS, 'x')});
+            test.execute(Tick{2 * TCPConfig::TIMEOUT_DFLT});
+            test.execute(ExpectSegment{}.with_syn(true).with_payload_size(0).with_seqno(isn));
+            // Karn's algorithm discards the sample of the retransmitted SYN, so the window goes out at once
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            for (uint32_t i = 0; i < 10; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + i * MSS));
+            }
+            test.execute(ExpectNoSegment{});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static constexpr uint32_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+static constexpr uint16_t WIN = 60000;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+            TCPSenderTestHarness test{"Fast retransmit merges small segments", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(WriteBytes{"abc"});
+            test.execute(ExpectSegment{}.with_data("abc").with_seqno(isn + 1));
+            test.execute(WriteBytes{"def"});
+            test.execute(ExpectSegment{}.with_data("def").with_seqno(isn + 4));
+            test.execute(WriteBytes{"ghi"});
+            test.execute(ExpectSegment{}.with_data("ghi").with_seqno(isn + 7));
+            test.execute(WriteBytes{"jkl"});
+            test.execute(ExpectSegment{}.with_data("jkl").with_seqno(isn + 10));
+            for (size_t i = 0; i < TCPConfig::DUP_ACK_THRESHOLD; i++) {
+                test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            }
+            test.execute(ExpectSegment{}.with_data("abcdefghijkl").with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+            TCPSenderTestHarness test{"A partial ACK inside a segment resends only what is missing", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(WriteBytes{string(30 * MSS, 'x')});
+            for (uint32_t i = 0; i < 10; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + i * MSS));
+            }
+            const WrappingInt32 base = isn + 1;
+            for (size_t i = 0; i < TCPConfig::DUP_ACK_THRESHOLD; i++) {
+                test.execute(AckReceived{base}.with_win(WIN));
+            }
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(base));
+            test.execute(ExpectNoSegment{});
+
+            // the retransmission starts at the ackno and runs into the next segment
+            test.execute(AckReceived{base + MSS / 2}.with_win(WIN));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(base + MSS / 2));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{10 * MSS - MSS / 2});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+            TCPSenderTestHarness test{"A retransmission stops where the SACKed data begins", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(WriteBytes{string(30 * MSS, 'x')});
+            for (uint32_t i = 0; i < 10; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + i * MSS));
+            }
+            const WrappingInt32 base = isn + 1;
+            for (size_t i = 0; i < TCPConfig::DUP_ACK_THRESHOLD; i++) {
+                test.execute(AckReceived{base}.with_win(WIN).with_sack(base + 100, base + 3 * MSS));
+            }
+            test.execute(ExpectSegment{}.with_payload_size(100).with_seqno(base));
+            test.execute(ExpectNoSegment{});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
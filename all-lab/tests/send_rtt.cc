@@ -0,0 +1,102 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = 1000;
+            cfg.adaptive_rto = true;
+            cfg.rto_min = 10;
+
+            TCPSenderTestHarness test{"RTO follows the measured RTT", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(ExpectRTT{0, 0, 1000});
+            test.execute(Tick{50});
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            // first sample: SRTT = R, RTTVAR = R/2, RTO = SRTT + 4 * RTTVAR
+            test.execute(ExpectRTT{50, 25, 150});
+            test.execute(WriteBytes{"abcd"});
+            test.execute(ExpectSegment{}.with_data("abcd"));
+            test.execute(Tick{30});
+            test.execute(AckReceived{WrappingInt32{isn + 5}});
+            // RTTVAR = 3/4 * 25 + 1/4 * |50 - 30|, SRTT = 7/8 * 50 + 1/8 * 30
+            test.execute(ExpectRTT{48, 24, 143});
+            test.execute(WriteBytes{"efgh"});
+            test.execute(ExpectSegment{}.with_data("efgh"));
+            test.execute(Tick{142});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("efgh"));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+            cfg.rto_min = 10;
+
+            TCPSenderTestHarness test{"Retransmitted segments are not sampled (Karn)", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{20});
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(ExpectRTT{20, 10, 60});
+            test.execute(WriteBytes{"abcd"});
+            test.execute(ExpectSegment{}.with_data("abcd"));
+            test.execute(Tick{60});
+            test.execute(ExpectSegment{}.with_data("abcd"));
+            test.execute(ExpectRTT{20, 10, 120});
+            test.execute(Tick{5});
+            test.execute(AckReceived{WrappingInt32{isn + 5}});
+            // no new sample, and the backoff is dropped once new data is acknowledged
+            test.execute(ExpectRTT{20, 10, 60});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+            cfg.rto_min = 100;
+            cfg.rto_max = 300;
+
+            TCPSenderTestHarness test{"RTO is clamped to [rto_min, rto_max]", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(ExpectRTT{0, 0, 300});
+            test.execute(Tick{2});
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(ExpectRTT{2, 1, 100});
+            test.execute(WriteBytes{"abcd"});
+            test.execute(ExpectSegment{}.with_data("abcd"));
+            test.execute(Tick{100});
+            test.execute(ExpectSegment{}.with_data("abcd"));
+            test.execute(ExpectRTT{2, 1, 200});
+            test.execute(Tick{200});
+            test.execute(ExpectSegment{}.with_data("abcd"));
+            test.execute(ExpectRTT{2, 1, 300});
+            test.execute(Tick{300});
+            test.execute(ExpectSegment{}.with_data("abcd"));
+            test.execute(ExpectRTT{2, 1, 300});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
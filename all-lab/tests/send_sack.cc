@@ -0,0 +1,66 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static constexpr uint32_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+static constexpr uint16_t WIN = 60000;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+            TCPSenderTestHarness test{"SACK: only the holes are retransmitted", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(WriteBytes{string(30 * MSS, 'x')});
+            for (uint32_t i = 0; i < 10; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + i * MSS));
+            }
+            test.execute(ExpectNoSegment{});
+
+            // segments 0 and 2 are lost; the peer reports what it holds beyond them
+            const WrappingInt32 base = isn + 1;
+            test.execute(AckReceived{base}.with_win(WIN).with_sack(base + MSS, base + 2 * MSS));
+            test.execute(AckReceived{base}.with_win(WIN).with_sack(base + 3 * MSS, base + 4 * MSS));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{base}.with_win(WIN).with_sack(base + 3 * MSS, base + 5 * MSS));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(base));
+            test.execute(ExpectNoSegment{});
+
+            // the next duplicate retransmits the second hole, skipping the SACKed segment 1
+            test.execute(AckReceived{base}.with_win(WIN).with_sack(base + 3 * MSS, base + 6 * MSS));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(base + 2 * MSS));
+            test.execute(ExpectNoSegment{});
+
+            // no holes below the highest SACKed byte remain
+            test.execute(AckReceived{base}.with_win(WIN).with_sack(base + 3 * MSS, base + 7 * MSS));
+            test.execute(ExpectNoSegment{});
+
+            // a partial ACK up to the second hole does not resend it again, and new data may go out
+            test.execute(AckReceived{base + 2 * MSS}.with_win(WIN).with_sack(base + 3 * MSS, base + 7 * MSS));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(base + 10 * MSS));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{9 * MSS});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -15,6 +15,7 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <vector>
 
 const unsigned int DEFAULT_TEST_WINDOW = 137;
 
@@ -99,6 +100,43 @@ struct ExpectBytesInFlight : public SenderExpectation {
     }
 };
 
+struct ExpectCongestionWindow : public SenderExpectation {
+    size_t _cwnd;
+
+    ExpectCongestionWindow(size_t cwnd) : _cwnd(cwnd) {}
+    std::string description() const { return "congestion window of " + std::to_string(_cwnd) + " bytes"; }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        if (sender.congestion_window() != _cwnd) {
+            std::ostringstream ss;
+            ss << "The TCPSender reported a congestion window of " << sender.congestion_window()
+               << " bytes, but it was expected to be " << _cwnd << " bytes";
+            throw SenderExpectationViolation(ss.str());
+        }
+    }
+};
+
+struct ExpectRTT : public SenderExpectation {
+    uint64_t _srtt;
+    uint64_t _rttvar;
+    unsigned int _rto;
+
+    ExpectRTT(uint64_t srtt, uint64_t rttvar, unsigned int rto) : _srtt(srtt), _rttvar(rttvar), _rto(rto) {}
+    std::string description() const {
+        return "srtt " + std::to_string(_srtt) + " ms, rttvar " + std::to_string(_rttvar) + " ms, rto " +
+               std::to_string(_rto) + " ms";
+    }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        if (sender.srtt() != _srtt or sender.rttvar() != _rttvar or sender.retransmission_timeout() != _rto) {
+            std::ostringstream ss;
+            ss << "The TCPSender reported srtt " << sender.srtt() << " ms, rttvar " << sender.rttvar() << " ms, rto "
+               << sender.retransmission_timeout() << " ms, but expected " << description();
+            throw SenderExpectationViolation(ss.str());
+        }
+    }
+};
+
 struct ExpectNoSegment : public SenderExpectation {
     ExpectNoSegment() {}
     std::string description() const { return "no (more) segments"; }
@@ -191,20 +229,32 @@ struct Tick : public SenderAction {
 struct AckReceived : public SenderAction {
     WrappingInt32 _ackno;
     std::optional<uint16_t> _window_advertisement{};
+    std::vector<TCPHeader::SACKBlock> _sack_blocks{};
 
     AckReceived(WrappingInt32 ackno) : _ackno(ackno) {}
     std::string description() const {
         std::ostringstream ss;
         ss << "ack " << _ackno.raw_value() << " winsize " << _window_advertisement.value_or(DEFAULT_TEST_WINDOW);
+        for (const auto &[left, right] : _sack_blocks) {
+            ss << " sack " << left << "-" << right;
+        }
         return ss.str();
     }
 
+    AckReceived &with_sack(WrappingInt32 left, WrappingInt32 right) {
+        _sack_blocks.emplace_back(left, right);
+        return *this;
+    }
+
     AckReceived &with_win(uint16_t win) {
         _window_advertisement.emplace(win);
         return *this;
     }
 
     void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        if (not _sack_blocks.empty()) {
+            sender.sack_received(_sack_blocks.data(), _sack_blocks.size());
+        }
         sender.ack_received(_ackno, _window_advertisement.value_or(DEFAULT_TEST_WINDOW));
         sender.fill_window();
     }
@@ -220,6 +270,21 @@ struct Close : public SenderAction {
     }
 };
 
+struct Cork : public SenderAction {
+    bool _corked;
+
+    Cork(const bool corked = true) : _corked(corked) {}
+    std::string description() const { return _corked ? "cork" : "uncork"; }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        if (_corked) {
+            sender.cork();
+        } else {
+            sender.uncork();
+        }
+    }
+};
+
 struct ExpectSegment : public SenderExpectation {
     std::optional<bool> ack{};
     std::optional<bool> rst{};
@@ -394,7 +459,7 @@ class TCPSenderTestHarness {
   public:
     TCPSenderTestHarness(const std::string &name_, TCPConfig config)
         : outbound_segments()
-        , sender(config.send_capacity, config.rt_timeout, config.fixed_isn)
+        , sender(config)
         , steps_executed()
         , name(name_) {
         sender.fill_window();
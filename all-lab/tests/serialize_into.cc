@@ -0,0 +1,175 @@
+#include "alloc_counter.hh"
+#include "arp_message.hh"
+#include "ethernet_header.hh"
+#include "four_tuple.hh"
+#include "ipv4_datagram.hh"
+#include "parser.hh"
+#include "tcp_over_ip.hh"
+#include "tcp_segment.hh"
+#include "test_err_if.hh"
+#include "util.hh"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+static string_view view(const uint8_t *data, const size_t len) { return {reinterpret_cast<const char *>(data), len}; }
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        const Address local{"10.0.0.1", 4321};
+        const Address remote{"10.0.0.2", 80};
+        const FourTuple tuple = FourTuple::from_addresses(local, remote);
+
+        // serialize_into() writes what serialize() returns, and only that; serialize() copes with the same sizes
+        for (size_t n = 0; n < 1000; n++) {
+            TCPSegment seg;
+            TCPHeader &h = seg.header();
+            h.seqno = WrappingInt32(rd());
+            h.ackno = WrappingInt32(rd());
+            h.ack = n % 2 == 0;
+            h.syn = n % 5 == 0;
+            h.win = static_cast<uint16_t>(rd());
+            if (n % 3 == 0) {
+                h.mss = static_cast<uint16_t>(rd());
+                h.window_scale = static_cast<uint8_t>(rd() % 15);
+                h.sack_permitted = true;
+            }
+            h.has_timestamps = n % 4 != 0;
+            h.tsval = rd();
+            h.tsecr = rd();
+            for (size_t i = 0; i < n % 5; i++) {
+                const WrappingInt32 left(rd());
+                h.sack_blocks[h.n_sack_blocks++] = {left, left + 1000};
+            }
+            h.doff = (TCPHeader::LENGTH + h.options_length()) / 4;
+            seg.payload() = string(rd() % 1500, static_cast<char>(rd()));
+
+            array<uint8_t, 128> out;
+            out.fill(0xaa);
+            const size_t len = h.serialize_into(out.data(), out.size());
+            test_err_if(len != 4 * size_t{h.doff}, "TCPHeader::serialize_into() returned the wrong length");
+            test_err_if(view(out.data(), len) != h.serialize(), "TCPHeader::serialize_into() differs from serialize()");
+            test_err_if(out[len] != 0xaa, "TCPHeader::serialize_into() wrote past the header");
+
+            // header then payload is the whole segment, with a checksum that verifies on parse
+            IPv4Header ip_header;
+            ip_header.src = tuple.local_ip;
+            ip_header.dst = tuple.remote_ip;
+            ip_header.len = IPv4Header::LENGTH + len + seg.payload().size();
+            const size_t seg_len = seg.serialize_header_into(out.data(), out.size(), ip_header.pseudo_cksum());
+            const string whole = string(view(out.data(), seg_len)) + seg.payload().copy();
+            test_err_if(whole != seg.serialize(ip_header.pseudo_cksum()).concatenate(),
+                        "TCPSegment::serialize_header_into() differs from serialize()");
+            TCPSegment parsed;
+            test_err_if(parsed.parse(Buffer(string(whole)), ip_header.pseudo_cksum()) != ParseResult::NoError,
+                        "a segment serialized in place does not parse");
+            TCPHeader reparsed = parsed.header();
+            reparsed.cksum = 0;
+            test_err_if(reparsed.serialize() != h.serialize(), "a segment serialized in place parses differently");
+
+            // the IPv4 and TCP headers together make the datagram that wrap_tcp_in_ip() does
+            array<uint8_t, TCPOverIPv4Adapter::MAX_HEADERS_LENGTH> headers;
+            const size_t headers_len =
+                TCPOverIPv4Adapter::serialize_headers_into(seg, tuple, headers.data(), headers.size());
+            const string datagram = string(view(headers.data(), headers_len)) + seg.payload().copy();
+            test_err_if(datagram != TCPOverIPv4Adapter::wrap_tcp_in_ip(seg, tuple).serialize().concatenate(),
+                        "serialize_headers_into() differs from wrap_tcp_in_ip()");
+            InternetDatagram parsed_datagram;
+            test_err_if(parsed_datagram.parse(Buffer(string(datagram))) != ParseResult::NoError,
+                        "a datagram serialized in place does not parse");
+        }
+
+        // Ethernet headers and ARP messages
+        {
+            EthernetHeader eth;
+            eth.dst = {1, 2, 3, 4, 5, 6};
+            eth.src = {7, 8, 9, 10, 11, 12};
+            eth.type = EthernetHeader::TYPE_IPv4;
+            array<uint8_t, EthernetHeader::LENGTH> out{};
+            test_err_if(eth.serialize_into(out.data(), out.size()) != EthernetHeader::LENGTH,
+                        "EthernetHeader::serialize_into() returned the wrong length");
+            test_err_if(view(out.data(), out.size()) != eth.serialize(),
+                        "EthernetHeader::serialize_into() differs from serialize()");
+            EthernetHeader parsed;
+            NetParser p{Buffer(eth.serialize())};
+            test_err_if(parsed.parse(p) != ParseResult::NoError or parsed.dst != eth.dst or parsed.src != eth.src or
+                            parsed.type != eth.type,
+                        "an Ethernet header does not survive a round trip");
+
+            ARPMessage arp;
+            arp.opcode = ARPMessage::OPCODE_REPLY;
+            arp.sender_ethernet_address = eth.src;
+            arp.sender_ip_address = rd();
+            arp.target_ethernet_address = eth.dst;
+            arp.target_ip_address = rd();
+            array<uint8_t, ARPMessage::LENGTH> arp_out{};
+            test_err_if(arp.serialize_into(arp_out.data(), arp_out.size()) != ARPMessage::LENGTH,
+                        "ARPMessage::serialize_into() returned the wrong length");
+            ARPMessage parsed_arp;
+            const Buffer arp_bytes{string(view(arp_out.data(), arp_out.size()))};
+            test_err_if(parsed_arp.parse(arp_bytes) != ParseResult::NoError or
+                            parsed_arp.sender_ip_address != arp.sender_ip_address or
+                            parsed_arp.target_ip_address != arp.target_ip_address or
+                            parsed_arp.target_ethernet_address != arp.target_ethernet_address,
+                        "an ARP message does not survive a round trip");
+
+            bool threw = false;
+            try {
+                eth.serialize_into(out.data(), out.size() - 1);
+            } catch (const runtime_error &) {
+                threw = true;
+            }
+            test_err_if(not threw, "serialize_into() wrote a header into too little room");
+        }
+
+        // a whole Ethernet/IPv4/TCP frame's headers cost no allocations
+        {
+            TCPSegment seg;
+            seg.header().ack = true;
+            seg.header().has_timestamps = true;
+            seg.header().sack_blocks[seg.header().n_sack_blocks++] = {WrappingInt32(1000), WrappingInt32(2000)};
+            seg.header().doff = (TCPHeader::LENGTH + seg.header().options_length()) / 4;
+            seg.payload() = string(1460, 'x');
+            EthernetHeader eth{{1, 2, 3, 4, 5, 6}, {7, 8, 9, 10, 11, 12}, EthernetHeader::TYPE_IPv4};
+
+            array<uint8_t, EthernetHeader::LENGTH + TCPOverIPv4Adapter::MAX_HEADERS_LENGTH> frame;
+            const size_t before = allocations;
+            const size_t eth_len = eth.serialize_into(frame.data(), frame.size());
+            const size_t len = eth_len + TCPOverIPv4Adapter::serialize_headers_into(
+                                             seg, tuple, frame.data() + eth_len, frame.size() - eth_len);
+            const size_t made = allocations - before;
+            test_err_if(made != 0, "building a frame's headers allocated " + to_string(made) + " time(s)");
+            test_err_if(len != EthernetHeader::LENGTH + IPv4Header::LENGTH + 4 * size_t{seg.header().doff},
+                        "a frame's headers have the wrong length");
+        }
+
+        // nor does copying a header with its SACK blocks
+        {
+            TCPHeader h;
+            h.ack = true;
+            for (uint32_t i = 0; i < TCPHeader::MAX_SACK_BLOCKS; i++) {
+                h.sack_blocks[h.n_sack_blocks++] = {WrappingInt32(1000 * i), WrappingInt32(1000 * i + 500)};
+            }
+            const size_t before = allocations;
+            const TCPHeader copy = h;
+            const size_t made = allocations - before;
+            test_err_if(made != 0, "copying a header allocated " + to_string(made) + " time(s)");
+            test_err_if(not(copy == h), "a copied header differs from the original");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
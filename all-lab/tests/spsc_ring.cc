@@ -0,0 +1,71 @@
+#include "spsc_ring.hh"
+#include "test_err_if.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+int main() {
+    try {
+        // one thread at a time: capacity, FIFO order, and a full ring leaving the item with the caller
+        {
+            SPSCRing<unique_ptr<uint64_t>> ring{5};
+            test_err_if(ring.capacity() != 8, "capacity 5 rounds up to " + to_string(ring.capacity()));
+            test_err_if(ring.pop().has_value(), "a new ring is not empty");
+
+            for (uint64_t round = 0; round < 3; round++) {  // wraps around the slots
+                for (uint64_t i = 0; i < 8; i++) {
+                    test_err_if(not ring.push(make_unique<uint64_t>(i)), "push " + to_string(i) + " failed");
+                }
+                auto extra = make_unique<uint64_t>(8);
+                test_err_if(ring.push(move(extra)), "pushed into a full ring");
+                test_err_if(not extra or *extra != 8, "a refused push took the item");
+
+                for (uint64_t i = 0; i < 8; i++) {
+                    auto item = ring.pop();
+                    test_err_if(not item.has_value() or **item != i, "pop " + to_string(i) + " out of order");
+                }
+                test_err_if(ring.pop().has_value(), "ring not empty after popping everything");
+            }
+        }
+
+        // a producer and a consumer thread: every item arrives exactly once, in order
+        {
+            constexpr uint64_t N = 1000000;
+            SPSCRing<uint64_t> ring{64};
+            thread producer([&ring] {
+                for (uint64_t i = 0; i < N;) {
+                    uint64_t item = i;
+                    if (ring.push(move(item))) {
+                        i++;
+                    } else {
+                        this_thread::yield();
+                    }
+                }
+            });
+
+            uint64_t expected = 0;
+            while (expected < N) {
+                if (const auto item = ring.pop(); item.has_value()) {
+                    test_err_if(*item != expected, "got " + to_string(*item) + ", expected " + to_string(expected));
+                    expected++;
+                } else {
+                    this_thread::yield();
+                }
+            }
+            producer.join();
+            test_err_if(ring.pop().has_value(), "ring not empty after the producer finished");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
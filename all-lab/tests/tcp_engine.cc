@@ -0,0 +1,126 @@
+#include "eventloop.hh"
+#include "socket.hh"
+#include "tcp_config.hh"
+#include "tcp_engine.hh"
+#include "tcp_sponge_socket.hh"
+#include "test_err_if.hh"
+#include "util.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+static constexpr size_t N_CLIENTS = 16;
+
+//! Everything `sock` sends before EOF
+static string read_all(FileDescriptor &sock) {
+    string received;
+    while (not sock.eof()) {
+        received += sock.read();
+    }
+    return received;
+}
+
+static string message(const size_t i) { return "client " + to_string(i) + ": " + string(i * 6151, 'a' + i % 26); }
+
+//! Echo N_CLIENTS + 1 connections through a server engine with `workers` workers
+static void echo_test(const size_t workers) {
+    TCPConfig c_tcp;
+    c_tcp.rt_timeout = 100;  // keeps each client's TIME_WAIT short
+
+    // the server: one engine, one UDP socket
+    UDPSocket server_sock;
+    server_sock.bind(Address("127.0.0.1", 0));
+    FdAdapterConfig c_server;
+    c_server.source = server_sock.local_address();
+    TCPOverUDPEngine server(TCPOverUDPSocketAdapter(move(server_sock)), c_tcp, c_server, workers);
+    server.listen(c_server.source, N_CLIENTS + 1);
+
+    // clients on threads of their own, each a TCPSpongeSocket with its own UDP socket
+    mutex errors_mutex;
+    vector<string> errors;
+    vector<thread> clients;
+    for (size_t i = 0; i < N_CLIENTS; i++) {
+        clients.emplace_back([&, i] {
+            try {
+                FdAdapterConfig c_client;
+                c_client.destination = c_server.source;
+                TCPOverUDPSpongeSocket sock(TCPOverUDPSocketAdapter(UDPSocket{}));
+                sock.connect(c_tcp, c_client);
+                sock.write(message(i));
+                sock.shutdown(SHUT_WR);
+                if (read_all(sock) != message(i)) {
+                    throw runtime_error("client " + to_string(i) + " got back the wrong bytes");
+                }
+                sock.wait_until_closed();
+            } catch (const exception &e) {
+                lock_guard<mutex> lock(errors_mutex);
+                errors.push_back(e.what());
+            }
+        });
+    }
+
+    // and one more client that is itself an engine, to exercise connect()
+    UDPSocket client_sock;
+    client_sock.bind(Address("127.0.0.1", 0));
+    FdAdapterConfig c_client;
+    c_client.source = client_sock.local_address();
+    c_client.destination = c_server.source;
+    TCPOverUDPEngine client(TCPOverUDPSocketAdapter(move(client_sock)), c_tcp, c_client, workers);
+    LocalStreamSocket client_data = client.connect(c_client);
+    client_data.write(message(N_CLIENTS));
+    client_data.shutdown(SHUT_WR);
+
+    // the server echoes every connection from a single thread
+    EventLoop loop;
+    size_t finished = 0;
+    loop.add_rule(server.accept_fd(), Direction::In, [&] {
+        auto data = make_shared<LocalStreamSocket>(server.accept().first);
+        loop.add_rule(*data, Direction::In, [&, data] {
+            data->write(data->read());
+            if (data->eof()) {
+                data->shutdown(SHUT_WR);
+                finished++;
+            }
+        });
+    });
+    const uint64_t deadline = timestamp_ms() + 20000;
+    while (finished < N_CLIENTS + 1) {
+        test_err_if(timestamp_ms() > deadline,
+                    to_string(workers) + " worker(s): only " + to_string(finished) + " connections finished");
+        loop.wait_next_event(100);
+    }
+
+    test_err_if(read_all(client_data) != message(N_CLIENTS), "the engine client got back the wrong bytes");
+    for (auto &t : clients) {
+        t.join();
+    }
+    for (const auto &e : errors) {
+        cerr << e << "\n";
+    }
+    test_err_if(not errors.empty(), to_string(workers) + " worker(s): a client failed");
+
+    // the engine client closed first, so it lingers in TIME_WAIT; let that run out before it is destroyed
+    this_thread::sleep_for(chrono::milliseconds(10 * c_tcp.rt_timeout + 100));
+}
+
+int main() {
+    try {
+        echo_test(1);
+        echo_test(4);  // sharded: connections spread over workers, with an I/O thread in front of them
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
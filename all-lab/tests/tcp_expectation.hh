@@ -11,6 +11,7 @@
 #include <exception>
 #include <optional>
 #include <sstream>
+#include <utility>
 
 struct TCPExpectation : public TCPTestStep {
     virtual ~TCPExpectation() {}
@@ -392,6 +393,9 @@ struct SendSegment : public TCPAction {
     uint16_t win{0};
     size_t payload_size{0};
     std::string data{};
+    std::optional<uint16_t> mss{};
+    std::optional<uint8_t> window_scale{};
+    std::optional<std::pair<uint32_t, uint32_t>> timestamps{};
 
     SendSegment() {}
 
@@ -455,6 +459,21 @@ struct SendSegment : public TCPAction {
         return *this;
     }
 
+    SendSegment &with_mss(uint16_t mss_) {
+        mss = mss_;
+        return *this;
+    }
+
+    SendSegment &with_window_scale(uint8_t window_scale_) {
+        window_scale = window_scale_;
+        return *this;
+    }
+
+    SendSegment &with_timestamps(uint32_t tsval_, uint32_t tsecr_) {
+        timestamps = {tsval_, tsecr_};
+        return *this;
+    }
+
     TCPSegment get_segment() const {
         TCPSegment data_seg;
         data_seg.payload() = std::string(data);
@@ -466,6 +485,13 @@ struct SendSegment : public TCPAction {
         data_hdr.ackno = ackno;
         data_hdr.seqno = seqno;
         data_hdr.win = win;
+        data_hdr.mss = mss;
+        data_hdr.window_scale = window_scale;
+        if (timestamps.has_value()) {
+            data_hdr.has_timestamps = true;
+            data_hdr.tsval = timestamps->first;
+            data_hdr.tsecr = timestamps->second;
+        }
         return data_seg;
     }
 
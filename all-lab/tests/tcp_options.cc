@@ -0,0 +1,148 @@
+#include "parser.hh"
+#include "tcp_header.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+//! serialize with room for all the options, then parse the result
+static TCPHeader roundtrip(TCPHeader header) {
+    header.doff = (TCPHeader::LENGTH + header.options_length()) / 4;
+    TCPHeader ret;
+    NetParser p{header.serialize()};
+    if (const auto res = ret.parse(p); res != ParseResult::NoError) {
+        throw runtime_error("parse failed: " + as_string(res));
+    }
+    return ret;
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // SACK-permitted takes one (padded) word
+        {
+            TCPHeader h;
+            h.syn = true;
+            h.seqno = WrappingInt32(rd());
+            h.sack_permitted = true;
+            const TCPHeader parsed = roundtrip(h);
+            if (parsed.doff != 6 || !parsed.sack_permitted || parsed.n_sack_blocks != 0) {
+                throw runtime_error("SACK-permitted did not survive a round trip");
+            }
+        }
+
+        // as many SACK blocks as fit round-trip
+        {
+            TCPHeader h;
+            h.ack = true;
+            for (uint32_t i = 0; i < TCPHeader::MAX_SACK_BLOCKS; i++) {
+                const WrappingInt32 left(rd());
+                h.sack_blocks[h.n_sack_blocks++] = {left, left + 100 + i};
+            }
+            const TCPHeader parsed = roundtrip(h);
+            if (parsed.doff != 5 + 9 || parsed.n_sack_blocks != TCPHeader::MAX_SACK_BLOCKS) {
+                throw runtime_error("wrong number of SACK blocks after a round trip");
+            }
+            for (size_t i = 0; i < TCPHeader::MAX_SACK_BLOCKS; i++) {
+                if (parsed.sack_blocks[i] != h.sack_blocks[i]) {
+                    throw runtime_error("SACK block changed in a round trip");
+                }
+            }
+        }
+
+        // MSS and RFC 7323 options round-trip
+        {
+            TCPHeader h;
+            h.syn = true;
+            h.mss = 1460;
+            h.window_scale = 7;
+            h.has_timestamps = true;
+            h.tsval = rd();
+            h.tsecr = rd();
+            h.sack_permitted = true;
+            h.doff = 5 + 6;
+            const TCPHeader parsed = roundtrip(h);
+            if (!(parsed == h)) {
+                throw runtime_error("MSS, window scale and timestamps did not survive a round trip");
+            }
+        }
+
+        // with timestamps, only three SACK blocks fit
+        {
+            TCPHeader h;
+            h.ack = true;
+            h.has_timestamps = true;
+            for (uint32_t i = 0; i < TCPHeader::MAX_SACK_BLOCKS; i++) {
+                const WrappingInt32 left(rd());
+                h.sack_blocks[h.n_sack_blocks++] = {left, left + 100};
+            }
+            const TCPHeader parsed = roundtrip(h);
+            if (parsed.doff != 5 + 10 || !parsed.has_timestamps || parsed.n_sack_blocks != 3) {
+                throw runtime_error("timestamps did not leave room for exactly three SACK blocks");
+            }
+        }
+
+        // options that do not fit in doff are left out
+        {
+            TCPHeader h;
+            h.sack_permitted = true;
+            h.sack_blocks[h.n_sack_blocks++] = {WrappingInt32{1}, WrappingInt32{2}};
+            TCPHeader parsed;
+            NetParser p{h.serialize()};
+            if (const auto res = parsed.parse(p); res != ParseResult::NoError) {
+                throw runtime_error("parse failed: " + as_string(res));
+            }
+            if (parsed.doff != 5 || parsed.sack_permitted || parsed.n_sack_blocks != 0) {
+                throw runtime_error("options were written past doff");
+            }
+        }
+
+        // unknown options are skipped, and a malformed option ends the list
+        {
+            TCPHeader h;
+            h.doff = 8;
+            string raw = h.serialize();
+            const string options{"\x63\x04\xaa\xbb"  // unknown kind 99, length 4
+                                 "\x01"              // NOP
+                                 "\x04\x02"          // SACK-permitted
+                                 "\x05\x00"          // SACK with a bad length
+                                 "\x04\x02\x00",     // not reached
+                                 12};
+            raw.replace(TCPHeader::LENGTH, options.size(), options);
+            TCPHeader parsed;
+            NetParser p{move(raw)};
+            if (const auto res = parsed.parse(p); res != ParseResult::NoError) {
+                throw runtime_error("parse failed: " + as_string(res));
+            }
+            if (!parsed.sack_permitted || parsed.n_sack_blocks != 0 || p.buffer().size() != 0) {
+                throw runtime_error("options were not skipped correctly");
+            }
+        }
+
+        // options that run past the end of the segment are a short packet
+        {
+            TCPHeader h;
+            h.doff = 7;
+            string raw = h.serialize();
+            raw.resize(TCPHeader::LENGTH + 2);
+            TCPHeader parsed;
+            NetParser p{move(raw)};
+            if (const auto res = parsed.parse(p); res != ParseResult::PacketTooShort) {
+                throw runtime_error("truncated options gave " + as_string(res));
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
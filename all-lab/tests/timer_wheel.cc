@@ -0,0 +1,114 @@
+#include "test_err_if.hh"
+#include "timer_wheel.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // every timer fires at exactly its deadline, in order, across all levels of the wheel
+        {
+            const uint64_t start = uniform_int_distribution<uint64_t>{0, uint64_t{1} << 40}(rd);
+            TimerWheel wheel{start};
+            multimap<uint64_t, TimerWheel::TimerId> pending;
+            vector<uint64_t> fired_at;
+
+            uniform_int_distribution<uint64_t> delay{1, 1 << 20};
+            for (size_t i = 0; i < 2000; i++) {
+                const uint64_t deadline = start + (i % 4 == 0 ? delay(rd) % 100 + 1 : delay(rd));
+                const auto id = wheel.schedule(deadline, [&wheel, &fired_at, deadline] {
+                    test_err_if(wheel.now() != deadline,
+                                "timer for " + to_string(deadline) + " fired at " + to_string(wheel.now()));
+                    fired_at.push_back(deadline);
+                });
+                pending.emplace(deadline, id);
+            }
+
+            // cancel a few, so the rest must fire around the holes they leave
+            for (size_t i = 0; i < 100; i++) {
+                auto it = pending.begin();
+                advance(it, uniform_int_distribution<size_t>{0, pending.size() - 1}(rd));
+                test_err_if(not wheel.cancel(it->second), "a pending timer could not be canceled");
+                test_err_if(wheel.cancel(it->second), "a timer was canceled twice");
+                pending.erase(it);
+            }
+            test_err_if(wheel.size() != pending.size(), "wrong number of pending timers");
+
+            uint64_t now = start;
+            while (not pending.empty()) {
+                const auto next = wheel.next_deadline();
+                test_err_if(not next.has_value() or next.value() != pending.begin()->first,
+                            "next_deadline() is not the earliest pending deadline");
+                now += uniform_int_distribution<uint64_t>{1, 3000}(rd);
+                const size_t fired = wheel.advance(now);
+                size_t expected = 0;
+                while (not pending.empty() and pending.begin()->first <= now) {
+                    pending.erase(pending.begin());
+                    expected++;
+                }
+                test_err_if(fired != expected, "advance() fired the wrong number of timers");
+            }
+            test_err_if(not is_sorted(fired_at.begin(), fired_at.end()), "timers fired out of order");
+            test_err_if(fired_at.size() != 1900, "not every timer fired");
+            test_err_if(not wheel.empty() or wheel.next_deadline().has_value(), "the wheel is not empty");
+        }
+
+        // deadlines beyond the top level, in the past, and scheduled from a callback
+        {
+            TimerWheel wheel{1000};
+            size_t fired = 0;
+            const uint64_t far = 1000 + (uint64_t{1} << 26) + 12345;
+            wheel.schedule(far, [&] { fired++; });
+            wheel.advance(far - 1);
+            test_err_if(fired != 0, "a far timer fired early");
+            test_err_if(wheel.next_deadline() != optional<uint64_t>{far}, "a far timer's deadline was lost");
+            wheel.advance(far);
+            test_err_if(fired != 1, "a far timer did not fire on time");
+
+            wheel.schedule(far - 10, [&] { fired++; });
+            test_err_if(wheel.next_deadline() != optional<uint64_t>{far - 10}, "an overdue timer is not next");
+            test_err_if(wheel.advance(far) != 1 or fired != 2, "an overdue timer did not fire on the next advance()");
+
+            // a callback that re-arms itself runs once per advance()
+            function<void()> rearm = [&] {
+                fired++;
+                wheel.schedule(wheel.now(), rearm);
+            };
+            wheel.schedule(far + 5, rearm);
+            wheel.advance(far + 5);
+            test_err_if(fired != 3, "a re-armed timer fired more than once per advance()");
+            wheel.advance(far + 5);
+            test_err_if(fired != 4, "a re-armed timer did not fire on the next advance()");
+        }
+
+        // a callback may cancel a timer due at the same moment
+        {
+            TimerWheel wheel{0};
+            bool second_fired = false;
+            TimerWheel::TimerId second = 0;
+            wheel.schedule(70, [&] { wheel.cancel(second); });
+            second = wheel.schedule(70, [&] { second_fired = true; });
+            wheel.advance(100);
+            test_err_if(second_fired, "a canceled timer fired");
+            test_err_if(not wheel.empty(), "the wheel is not empty");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
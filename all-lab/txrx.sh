@@ -2,7 +2,7 @@
 
 show_usage() {
     echo "Usage: $0 <-i|-u> <-c|-s> <-R|-S|-D> [-n|-o]"
-    echo "       [-t <rtto>] [-d <size>] [-w <size>] [-l <rate>] [-L <rate>]"
+    echo "       [-t <rtto>] [-d <size>] [-w <size>] [-l <rate>] [-L <rate>] [-C <alg>]"
     echo
     echo "  Option                                                      Default"
     echo "  --                                                          --"
@@ -16,6 +16,7 @@ show_usage() {
     echo
     echo "  -l <rate>   Set downlink loss to <rate> (float in 0..1)     0"
     echo "  -L <rate>   Set uplink loss to <rate> (float in 0..1)       0"
+    echo "  -C <alg>    Congestion control (none, reno, newreno, cubic) none"
     echo
     echo "  -n          In IP mode, use tcp_native rather tcp_ipv4_ref  False"
     echo "  -o          In IP mode, use socat rather than tcp_ipv4_ref  False"
@@ -26,8 +27,8 @@ show_usage() {
 get_cmdline_options () {
     # prepare to use getopts
     local OPT= OPTIND=1 OPTARG=
-    CSMODE= RSDMODE= DATASIZE=32 WINSIZE= IUMODE= USE_IPV4= RTTO="-t 12" LOSS_UP= LOSS_DN=
-    while getopts "t:oniucsRSDd:w:p:l:L:" OPT; do
+    CSMODE= RSDMODE= DATASIZE=32 WINSIZE= IUMODE= USE_IPV4= RTTO="-t 12" LOSS_UP= LOSS_DN= CCALG=
+    while getopts "t:oniucsRSDd:w:p:l:L:C:" OPT; do
         case "$OPT" in
             i|u)
                 [ ! -z "$IUMODE" ] && show_usage "Only one of -i and -u is allowed."
@@ -54,6 +55,9 @@ get_cmdline_options () {
             L)
                 LOSS_UP="$OPTARG"
                 ;;
+            C)
+                CCALG="-C $OPTARG"
+                ;;
             n|o)
                 [ ! -z "$USE_IPV4" ] && show_usage "Only one of -n and -o is allowed."
                 USE_IPV4=$OPT
@@ -177,16 +181,16 @@ if [ "$IUMODE" = "i" ]; then
     TEST_HOST=${TUN_IP_PREFIX}.144.9
     if [ -z "$USE_IPV4" ]; then
         REF_HOST=${TUN_IP_PREFIX}.145.9
-        REF_PROG="./apps/tcp_ipv4 ${RTTO} ${WINSIZE} ${LOSS_UP} ${LOSS_DN} -d tun145 -a ${REF_HOST}"
-        TEST_PROG="./apps/tcp_ipv4 ${RTTO} ${WINSIZE} -d tun144 -a ${TEST_HOST}"
+        REF_PROG="./apps/tcp_ipv4 ${RTTO} ${WINSIZE} ${CCALG} ${LOSS_UP} ${LOSS_DN} -d tun145 -a ${REF_HOST}"
+        TEST_PROG="./apps/tcp_ipv4 ${RTTO} ${WINSIZE} ${CCALG} -d tun144 -a ${TEST_HOST}"
     else
         REF_PROG="./apps/tcp_native"
-        TEST_PROG="./apps/tcp_ipv4 ${RTTO} ${WINSIZE} ${LOSS_UP} ${LOSS_DN} -d tun144 -a ${TEST_HOST}"
+        TEST_PROG="./apps/tcp_ipv4 ${RTTO} ${WINSIZE} ${CCALG} ${LOSS_UP} ${LOSS_DN} -d tun144 -a ${TEST_HOST}"
     fi
 else
     # UDP mode
-    REF_PROG="./apps/tcp_udp ${RTTO} ${WINSIZE} ${LOSS_UP} ${LOSS_DN}"
-    TEST_PROG="./apps/tcp_udp ${RTTO} ${WINSIZE}"
+    REF_PROG="./apps/tcp_udp ${RTTO} ${WINSIZE} ${CCALG} ${LOSS_UP} ${LOSS_DN}"
+    TEST_PROG="./apps/tcp_udp ${RTTO} ${WINSIZE} ${CCALG}"
 fi
 
 TEST_OUT_FILE=$(mktemp)